@@ -0,0 +1,89 @@
+/* Measures the cost of calling a tarot function from C, looking it up by
+ * name on every call and through a handle that was looked up once.
+ * Build from the root directory with:
+ *     gcc -std=c90 -Isrc -DTAROT_BITS= -DTAROT_BACKEND=1 -O3 -fhosted \
+ *         -fno-builtin -DNDEBUG $(find src -name "*.c" ! -path src/main.c) \
+ *         data/examples/call_benchmark.c -o call_benchmark
+ *     ./call_benchmark data/examples/call_benchmark.rot
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tarot.h"
+
+#define NUM_CALLS 1000000L
+
+static double seconds_since(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char *name, double seconds, double sum) {
+	printf(
+		"%-8s %6.0f ns per call (sum %.0f)\n",
+		name,
+		seconds * 1e9 / NUM_CALLS,
+		sum
+	);
+}
+
+static void run_benchmark(
+	struct tarot_bytecode *bytecode,
+	struct tarot_virtual_machine *vm
+) {
+	struct tarot_function *scale = tarot_lookup_function(bytecode, "scale");
+	union tarot_value arguments[2];
+	union tarot_value result;
+	double sum = 0.0;
+	clock_t start;
+	long i;
+
+	start = clock();
+	for (i = 0; i < NUM_CALLS; i++) {
+		arguments[0].Float = (double)i;
+		arguments[1].Float = 2.0;
+		sum += tarot_call_function(vm, "scale", arguments[0], arguments[1]).Float;
+	}
+	report("by name", seconds_since(start), sum);
+
+	sum = 0.0;
+	start = clock();
+	for (i = 0; i < NUM_CALLS; i++) {
+		arguments[0].Float = (double)i;
+		arguments[1].Float = 2.0;
+		if (tarot_invoke_function(vm, scale, arguments, &result)) {
+			sum += result.Float;
+		}
+	}
+	report("handle", seconds_since(start), sum);
+}
+
+int main(int argc, char *argv[]) {
+	int exit_code = EXIT_FAILURE;
+	const struct tarot_platform_config config = {
+		(tarot_abort_function)   abort,
+		(tarot_malloc_function)  malloc,
+		(tarot_realloc_function) realloc,
+		(tarot_free_function)    free,
+		(tarot_fopen_function)   fopen,
+		(tarot_fclose_function)  fclose,
+		(tarot_fgetc_function)   fgetc,
+		(tarot_fputc_function)   fputc,
+		stdin, stdout, stderr
+	};
+	tarot_initialize(&config);
+	if (tarot_is_initialized() && argc > 1) {
+		struct tarot_node *ast = tarot_import(argv[1], TAROT_SCAN_FAST);
+		struct tarot_bytecode *bytecode = tarot_create_bytecode(ast);
+		if (bytecode != NULL) {
+			struct tarot_virtual_machine *vm = tarot_create_virtual_machine(bytecode);
+			tarot_attach_executor(vm); /* runs main */
+			run_benchmark(bytecode, vm);
+			tarot_free_virtual_machine(vm);
+			tarot_free_bytecode(bytecode);
+		}
+		tarot_free_node(ast);
+		tarot_free_interned_strings();
+		exit_code = tarot_exit();
+	}
+	return exit_code;
+}
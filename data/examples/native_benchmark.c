@@ -0,0 +1,72 @@
+/* Measures the cost of calling a C function from tarot, once bound as a
+ * tarot_foreign_function that reads its arguments from the thread and once
+ * as a tarot_native_function that takes them as an array.
+ * Build from the root directory with:
+ *     gcc -std=c90 -Isrc -DTAROT_BITS= -DTAROT_BACKEND=1 -O3 -fhosted \
+ *         -fno-builtin -DNDEBUG $(find src -name "*.c" ! -path src/main.c) \
+ *         data/examples/native_benchmark.c -o native_benchmark
+ *     ./native_benchmark data/examples/native_benchmark.rot
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tarot.h"
+
+static void mix(struct tarot_thread *thread) {
+	union tarot_value result;
+	result.Float = tarot_argument(thread, 0).Float * tarot_argument(thread, 1).Float;
+	tarot_push(thread, result);
+}
+
+static void native_mix(
+	const union tarot_value *arguments,
+	size_t num_arguments,
+	union tarot_value *result
+) {
+	(void)num_arguments;
+	result->Float = arguments[0].Float * arguments[1].Float;
+}
+
+static void run_benchmark(
+	const char *name,
+	struct tarot_bytecode *bytecode,
+	const struct tarot_foreign_binding *binding
+) {
+	struct tarot_virtual_machine *vm = tarot_create_virtual_machine(bytecode);
+	clock_t start = clock();
+	tarot_register_foreign_functions(vm, binding, 1);
+	tarot_attach_executor(vm);
+	printf("%-8s %.3f s\n", name, (double)(clock() - start) / CLOCKS_PER_SEC);
+	tarot_free_virtual_machine(vm);
+}
+
+int main(int argc, char *argv[]) {
+	int exit_code = EXIT_FAILURE;
+	const struct tarot_platform_config config = {
+		(tarot_abort_function)   abort,
+		(tarot_malloc_function)  malloc,
+		(tarot_realloc_function) realloc,
+		(tarot_free_function)    free,
+		(tarot_fopen_function)   fopen,
+		(tarot_fclose_function)  fclose,
+		(tarot_fgetc_function)   fgetc,
+		(tarot_fputc_function)   fputc,
+		stdin, stdout, stderr
+	};
+	struct tarot_foreign_binding thread_binding = {"mix", mix, NULL};
+	struct tarot_foreign_binding native_binding = {"mix", NULL, native_mix};
+	tarot_initialize(&config);
+	if (tarot_is_initialized() && argc > 1) {
+		struct tarot_node *ast = tarot_import(argv[1], TAROT_SCAN_FAST);
+		struct tarot_bytecode *bytecode = tarot_create_bytecode(ast);
+		if (bytecode != NULL) {
+			run_benchmark("thread", bytecode, &thread_binding);
+			run_benchmark("native", bytecode, &native_binding);
+			tarot_free_bytecode(bytecode);
+		}
+		tarot_free_node(ast);
+		tarot_free_interned_strings();
+		exit_code = tarot_exit();
+	}
+	return exit_code;
+}
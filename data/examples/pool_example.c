@@ -0,0 +1,57 @@
+/* Runs a program once on a virtual machine of its own and then several
+ * times on a pooled machine, which is reset between the runs.
+ * Build from the root directory with:
+ *     gcc -std=c90 -Isrc -DTAROT_BITS= -DTAROT_BACKEND=1 -O3 -fhosted \
+ *         -fno-builtin -DNDEBUG $(find src -name "*.c" ! -path src/main.c) \
+ *         data/examples/pool_example.c -o pool_example
+ *     ./pool_example data/examples/exceptions.rot
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "tarot.h"
+
+#define NUM_RUNS 3
+
+static void run_pooled(struct tarot_bytecode *bytecode) {
+	struct tarot_virtual_machine_pool *pool = tarot_create_virtual_machine_pool(bytecode);
+	int i;
+	for (i = 0; i < NUM_RUNS; i++) {
+		struct tarot_virtual_machine *vm = tarot_acquire_virtual_machine(pool);
+		if (vm != NULL) {
+			printf("pooled run %d:\n", i + 1);
+			tarot_attach_executor(vm);
+			tarot_release_virtual_machine(vm);
+		}
+	}
+	tarot_free_virtual_machine_pool(pool);
+}
+
+int main(int argc, char *argv[]) {
+	int exit_code = EXIT_FAILURE;
+	const struct tarot_platform_config config = {
+		(tarot_abort_function)   abort,
+		(tarot_malloc_function)  malloc,
+		(tarot_realloc_function) realloc,
+		(tarot_free_function)    free,
+		(tarot_fopen_function)   fopen,
+		(tarot_fclose_function)  fclose,
+		(tarot_fgetc_function)   fgetc,
+		(tarot_fputc_function)   fputc,
+		stdin, stdout, stderr
+	};
+	tarot_initialize(&config);
+	if (tarot_is_initialized() && argc > 1) {
+		struct tarot_node *ast = tarot_import(argv[1], TAROT_SCAN_FAST);
+		struct tarot_bytecode *bytecode = tarot_create_bytecode(ast);
+		if (bytecode != NULL) {
+			printf("single run:\n");
+			tarot_execute_bytecode(bytecode);
+			run_pooled(bytecode);
+			tarot_free_bytecode(bytecode);
+		}
+		tarot_free_node(ast);
+		tarot_free_interned_strings();
+		exit_code = tarot_exit();
+	}
+	return exit_code;
+}
@@ -2,6 +2,9 @@
 #include "tarot.h"
 #include "bytecode/opcodes.h"
 
+static void index_foreign_functions(struct tarot_bytecode *bytecode);
+static void free_constants(struct tarot_bytecode *bytecode);
+
 static struct tarot_bytecode* construct_bytecode_interface(struct tarot_bytecode_header *header) {
 	struct tarot_bytecode *bytecode = tarot_malloc(sizeof(*bytecode));
 	bytecode->header = header;
@@ -11,6 +14,7 @@ static struct tarot_bytecode* construct_bytecode_interface(struct tarot_bytecode
 	bytecode->foreign_functions = tarot_bytecode_foreign_functions(header);
 	bytecode->num_functions = header->size.functions / sizeof(*bytecode->functions);
 	bytecode->num_foreign_functions = header->size.foreign_functions / sizeof(*bytecode->foreign_functions);
+	index_foreign_functions(bytecode);
 	return bytecode;
 }
 
@@ -45,17 +49,10 @@ uint8_t* tarot_bytecode_data(struct tarot_bytecode_header *bytecode) {
 	return tarot_bytecode_foreign_functions(bytecode) + tarot_align(bytecode->size.foreign_functions);
 }
 
-const char* read_string(struct tarot_bytecode *bytecode, uint16_t offset) {
+const char* read_string(struct tarot_bytecode *bytecode, tarot_address offset) {
 	return (const char*)&bytecode->data[offset];
 }
 
-static struct tarot_function* function_index(
-	struct tarot_bytecode_header *bytecode,
-	size_t index
-) {
-	return (struct tarot_function*)&tarot_bytecode_functions(bytecode)[index * sizeof(struct tarot_function)];
-}
-
 static struct tarot_function* foreign_function_index(
 	struct tarot_bytecode_header *bytecode,
 	size_t index
@@ -63,8 +60,8 @@ static struct tarot_function* foreign_function_index(
 	return (struct tarot_function*)&tarot_bytecode_foreign_functions(bytecode)[index * sizeof(struct tarot_function)];
 }
 
-static uint16_t read_argument(uint8_t **ip) {
-	return tarot_read16bit(*ip, ip);
+static tarot_address read_argument(uint8_t **ip) {
+	return tarot_read_argument(*ip, ip);
 }
 
 static bool invalid_bytecode(struct tarot_bytecode_header *bytecode) {
@@ -77,6 +74,10 @@ static bool invalid_bytecode(struct tarot_bytecode_header *bytecode) {
 	return true;
 }
 
+static bool foreign_format(struct tarot_bytecode_header *bytecode) {
+	return (bytecode->flags & TAROT_BYTECODE_WIDE) != TAROT_BYTECODE_FORMAT;
+}
+
 struct tarot_bytecode* tarot_import_bytecode(const char *path) {
 	struct tarot_bytecode *bytecode = NULL;
 	size_t size;
@@ -84,12 +85,41 @@ struct tarot_bytecode* tarot_import_bytecode(const char *path) {
 	if (invalid_bytecode(header)) {
 		tarot_error("Invalid Bytecode!");
 		tarot_free(header);
+	} else if (foreign_format(header)) {
+		tarot_error(
+			"Bytecode uses the %s format, this build only runs the %s format!",
+			header->flags & TAROT_BYTECODE_WIDE ? "wide" : "compact",
+			TAROT_BYTECODE_FORMAT ? "wide" : "compact"
+		);
+		tarot_free(header);
 	} else {
 		bytecode = construct_bytecode_interface(header);
 	}
 	return bytecode;
 }
 
+struct tarot_bytecode* tarot_load_bytecode(const void *image, size_t size) {
+	struct tarot_bytecode_header *header;
+	if (size < sizeof(*header)) {
+		return NULL;
+	}
+	header = tarot_malloc(size);
+	memcpy(header, image, size);
+	if (
+		invalid_bytecode(header) or
+		foreign_format(header) or
+		sizeof_bytecode(header) > size
+	) {
+		tarot_free(header);
+		return NULL;
+	}
+	return construct_bytecode_interface(header);
+}
+
+size_t tarot_sizeof_bytecode(struct tarot_bytecode *bytecode) {
+	return sizeof_bytecode(bytecode->header);
+}
+
 int tarot_export_bytecode(const char *path, struct tarot_bytecode *bytecode) {
 	return tarot_write_to_file(path, bytecode->header, sizeof_bytecode(bytecode->header));
 }
@@ -98,41 +128,48 @@ int tarot_export_bytecode(const char *path, struct tarot_bytecode *bytecode) {
  * MARK: Functions
  *****************************************************************************/
 
+/* Bit positions of the fields packed into tarot_function.info,
+ * starting at the most significant bit */
+#define INFO_BITS (sizeof(tarot_function_info) * 8)
+#define PARAMETERS_SHIFT (INFO_BITS - TAROT_PARAMETER_BITS)
+#define VARIABLES_SHIFT (PARAMETERS_SHIFT - TAROT_VARIABLE_BITS)
+#define RETURNS_SHIFT (VARIABLES_SHIFT - 1)
+#define METHOD_SHIFT (RETURNS_SHIFT - 1)
+
 void tarot_setup_function(
 	struct tarot_function *function,
-	uint16_t address,
-	uint16_t finally,
-	uint8_t num_parameters,
-	uint8_t num_variables,
+	tarot_address address,
+	tarot_address finally,
+	size_t num_parameters,
+	size_t num_variables,
 	bool returns_value,
 	bool is_method
 ) {
+	assert(num_parameters <= TAROT_MAX_PARAMETERS);
+	assert(num_variables <= TAROT_MAX_VARIABLES);
 	function->address = address;
 	function->finally = finally;
-	function->info |= num_parameters << (16-4);
-	function->info |= num_variables << (16-4-7);
-	function->info |= returns_value << (16-4-7-1);
-	function->info |= is_method << (16-4-7-1-1);
+	function->info = 0;
+	function->info |= (tarot_function_info)num_parameters << PARAMETERS_SHIFT;
+	function->info |= (tarot_function_info)num_variables << VARIABLES_SHIFT;
+	function->info |= (tarot_function_info)returns_value << RETURNS_SHIFT;
+	function->info |= (tarot_function_info)is_method << METHOD_SHIFT;
 }
 
 size_t tarot_num_parameters(struct tarot_function *function) {
-	static const int mask = 0xF000; /* 0b1111000000000000 */
-	return (function->info & mask) >> (16-4);
+	return (function->info >> PARAMETERS_SHIFT) & TAROT_MAX_PARAMETERS;
 }
 
 size_t tarot_num_variables(struct tarot_function *function) {
-	static const int mask = 0xFE0; /* 0b0000111111100000 */
-	return (function->info & mask) >> (16-4-7);
+	return (function->info >> VARIABLES_SHIFT) & TAROT_MAX_VARIABLES;
 }
 
 bool tarot_returns(struct tarot_function *function) {
-	static const int mask = 0x10; /* 0b0000000000010000 */
-	return (function->info & mask) >> (16-4-7-1);
+	return (function->info >> RETURNS_SHIFT) & 1;
 }
 
 bool tarot_is_method(struct tarot_function *function) {
-	static const int mask = 0x8; /* 0b0000000000001000 */
-	return (function->info & mask) >> (16-4-7-1-1);
+	return (function->info >> METHOD_SHIFT) & 1;
 }
 
 const char* tarot_get_function_name(
@@ -160,15 +197,88 @@ struct tarot_function* tarot_lookup_function(
 	return NULL;
 }
 
+/* Hashes the name of a foreign function (FNV-1a) */
+static size_t hash_name(const char *name) {
+	size_t hash = 2166136261U;
+	while (*name != '\0') {
+		hash = (hash ^ (unsigned char)*name++) * 16777619U;
+	}
+	return hash;
+}
+
+/* Indexes the foreign functions by name in an open addressing hash table
+ * with at least twice as many slots. A slot holds the index of a function
+ * plus one, or zero if it is empty. */
+static void index_foreign_functions(struct tarot_bytecode *bytecode) {
+	size_t i, mask;
+	if (bytecode->num_foreign_functions == 0) {
+		return;
+	}
+	bytecode->foreign_capacity = 4;
+	while (bytecode->foreign_capacity < 2u * bytecode->num_foreign_functions) {
+		bytecode->foreign_capacity *= 2;
+	}
+	bytecode->foreign_index = tarot_malloc(sizeof(*bytecode->foreign_index) * bytecode->foreign_capacity);
+	mask = bytecode->foreign_capacity - 1;
+	for (i = 0; i < bytecode->num_foreign_functions; i++) {
+		struct tarot_function *function = &bytecode->foreign_functions[i];
+		size_t slot = hash_name(read_string(bytecode, function->address)) & mask;
+		while (bytecode->foreign_index[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		bytecode->foreign_index[slot] = i + 1;
+	}
+}
+
+struct tarot_function* tarot_lookup_foreign_function(
+	struct tarot_bytecode *bytecode,
+	const char *function_name
+) {
+	size_t mask = bytecode->foreign_capacity - 1;
+	size_t slot;
+	if (bytecode->foreign_index == NULL) {
+		return NULL;
+	}
+	slot = hash_name(function_name) & mask;
+	while (bytecode->foreign_index[slot] != 0) {
+		struct tarot_function *function = &bytecode->foreign_functions[bytecode->foreign_index[slot] - 1];
+		if (!strcmp(function_name, read_string(bytecode, function->address))) {
+			return function;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return NULL;
+}
+
+void tarot_bind_foreign_functions(
+	struct tarot_bytecode *bytecode,
+	const struct tarot_foreign_binding *bindings,
+	size_t num_bindings
+) {
+	size_t i;
+	if (bytecode->bindings == NULL) {
+		bytecode->bindings = tarot_malloc(sizeof(*bytecode->bindings) * bytecode->num_foreign_functions);
+	}
+	for (i = 0; i < num_bindings; i++) {
+		struct tarot_function *function = tarot_lookup_foreign_function(bytecode, bindings[i].name);
+		assert(bindings[i].function != NULL or bindings[i].native != NULL);
+		if (function != NULL) {
+			struct tarot_foreign_call *call = &bytecode->bindings[function - bytecode->foreign_functions];
+			call->function = bindings[i].function;
+			call->native = bindings[i].native;
+		}
+	}
+}
+
 /******************************************************************************
  * MARK: Disassembler
  *****************************************************************************/
 
 static void print_offset(
 	struct tarot_iostream *stream,
-	uint16_t offset
+	size_t offset
 ) {
-	tarot_fprintf(stream, "[%*u] ", 5u, offset);
+	tarot_fprintf(stream, "[%*zu] ", 5u, offset);
 }
 
 static void print_opcode(
@@ -182,9 +292,9 @@ static void print_opcode(
 
 static void print_argument(
 	struct tarot_iostream *stream,
-	uint16_t argument
+	tarot_address argument
 ) {
-	tarot_fprintf(stream, "%d ", argument);
+	tarot_fprintf(stream, "%zu ", (size_t)argument);
 }
 
 static void print_name(
@@ -200,7 +310,7 @@ static void print_name(
 static void print_float(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode,
-	uint16_t index
+	tarot_address index
 ) {
 	double value = tarot_read_float(&bytecode->data[index]);
 	tarot_fprintf(stream, "%f", value);
@@ -209,7 +319,7 @@ static void print_float(
 static void print_integer(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode,
-	uint16_t index
+	tarot_address index
 ) {
 	tarot_integer *value = tarot_import_integer(&bytecode->data[index], NULL);
 	tarot_print_integer(stream, value);
@@ -219,7 +329,7 @@ static void print_integer(
 static void print_rational(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode,
-	uint16_t index
+	tarot_address index
 ) {
 	tarot_rational *value = tarot_import_rational(&bytecode->data[index]);
 	tarot_print_rational(stream, value);
@@ -229,7 +339,7 @@ static void print_rational(
 static void print_string(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode,
-	uint16_t index
+	tarot_address index
 ) {
 	tarot_format(stream, TAROT_COLOR_BLUE);
 	tarot_fprintf(stream, "\"%s\"", read_string(bytecode, index));
@@ -239,7 +349,7 @@ static void print_string(
 static void print_function(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode,
-	uint16_t index
+	tarot_address index
 ) {
 	struct tarot_function *function = &bytecode->functions[index];
 	uint8_t *ip = &bytecode->instructions[function->address];
@@ -253,7 +363,7 @@ static void print_function(
 static void print_foreign_function(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode,
-	uint16_t index
+	tarot_address index
 ) {
 	struct tarot_function *function = &bytecode->foreign_functions[index];
 	print_name(stream, read_string(bytecode, function->address));
@@ -268,6 +378,52 @@ static void print_type(
 	tarot_format(stream, TAROT_COLOR_RESET);
 }
 
+static void print_launch(
+	struct tarot_iostream *stream,
+	struct tarot_bytecode *bytecode,
+	uint8_t **ipptr
+) {
+	tarot_address index = read_argument(ipptr);
+	size_t i, num_arguments = tarot_num_parameters(&bytecode->functions[index]);
+	print_function(stream, bytecode, index);
+	for (i = 0; i < num_arguments; i++) {
+		print_argument(stream, tarot_read8bit(*ipptr, ipptr));
+	}
+}
+
+static void print_parts(
+	struct tarot_iostream *stream,
+	struct tarot_bytecode *bytecode,
+	uint8_t **ipptr
+) {
+	tarot_address i, num_parts = read_argument(ipptr);
+	enum tarot_datatype type;
+	print_argument(stream, num_parts);
+	for (i = 0; i < num_parts; i++) {
+		type = tarot_read8bit(*ipptr, ipptr);
+		if (type == TYPE_VOID) {
+			print_string(stream, bytecode, read_argument(ipptr));
+		} else {
+			print_type(stream, type);
+		}
+		tarot_fputs(stream, " ");
+	}
+}
+
+static void print_parallel_for(
+	struct tarot_iostream *stream,
+	uint8_t **ipptr
+) {
+	enum tarot_datatype type;
+	print_argument(stream, tarot_read_slot(*ipptr, ipptr));
+	print_argument(stream, tarot_read_slot(*ipptr, ipptr));
+	type = tarot_read8bit(*ipptr, ipptr);
+	print_argument(stream, tarot_read8bit(*ipptr, ipptr));
+	print_argument(stream, tarot_read8bit(*ipptr, ipptr));
+	print_argument(stream, read_argument(ipptr));
+	print_type(stream, type);
+}
+
 static void disassemble(
 	struct tarot_iostream *stream,
 	struct tarot_bytecode *bytecode
@@ -286,10 +442,13 @@ static void disassemble(
 			print_name(stream, read_string(bytecode, read_argument(&ip)));
 			break;
 		case OP_LoadVariablePointer:
+			print_argument(stream, tarot_read_slot(ip, &ip));
+			break;
 		case OP_LoadAttribute:
 			print_argument(stream, tarot_read8bit(ip, &ip));
 			break;
 		case OP_LoadValue:
+		case OP_MoveValue:
 		case OP_LoadArgument:
 		case OP_Goto:
 		case OP_GotoIfFalse:
@@ -298,9 +457,25 @@ static void disassemble(
 			print_argument(stream, read_argument(&ip));
 			break;
 		case OP_PushList:
+			print_type(stream, tarot_read8bit(ip, &ip));
+			break;
 		case OP_PushDict:
+			print_argument(stream, read_argument(&ip));
 			print_type(stream, tarot_read8bit(ip, &ip));
 			break;
+		case OP_PushChannel: {
+			enum tarot_datatype type = tarot_read8bit(ip, &ip);
+			print_argument(stream, tarot_read8bit(ip, &ip));
+			print_type(stream, type);
+			break;
+		}
+		case OP_ChannelSend:
+			print_argument(stream, tarot_read8bit(ip, &ip));
+			break;
+		case OP_StringBuild:
+		case OP_ScratchStringBuild:
+			print_parts(stream, bytecode, &ip);
+			break;
 		case OP_CastToFloat:
 		case OP_CastToInteger:
 		case OP_CastToRational:
@@ -311,10 +486,17 @@ static void disassemble(
 			break;
 		case OP_CallForeignFunction:
 			print_foreign_function(stream, bytecode, read_argument(&ip));
+			print_type(stream, read_argument(&ip));
 			break;
 		case OP_CallFunction:
 			print_function(stream, bytecode, read_argument(&ip));
 			break;
+		case OP_Launch:
+			print_launch(stream, bytecode, &ip);
+			break;
+		case OP_ParallelFor:
+			print_parallel_for(stream, &ip);
+			break;
 		case OP_PushFloat:
 			print_float(stream, bytecode, read_argument(&ip));
 			break;
@@ -383,6 +565,14 @@ static void print_header_section(
 	print_section_size(stream,"functions:   ", bytecode->header->size.functions);
 	print_section_size(stream,"foreign funs:", bytecode->header->size.foreign_functions);
 	print_section_size(stream,"data:        ", bytecode->header->size.data);
+	if (bytecode->num_elided_regions > 0) {
+		tarot_fprintf(
+			stream,
+			"elided regions: %zu instructions (%zu Bytes)\n",
+			bytecode->num_elided_regions,
+			bytecode->num_elided_regions * sizeof(uint8_t)
+		);
+	}
 	tarot_indent(stream, -1);
 }
 
@@ -430,18 +620,18 @@ static void print_function_section(
 		struct tarot_function *function = &bytecode->functions[i];
 		tarot_printf("[%zu] ", i);
 		if (instructions[function->address] == OP_Debug) {
-			uint16_t index = tarot_read16bit(&instructions[function->address+1], NULL);
+			tarot_address index = tarot_read_argument(&instructions[function->address+1], NULL);
 			const char *function_name = read_string(bytecode, index);
 			print_name(stream, function_name);
 		}
 		tarot_printf(
-			"address: %u (parameters: %u, returns: %s, method: %s, variables: %u, finally: %u)\n",
-			function->address,
+			"address: %zu (parameters: %zu, returns: %s, method: %s, variables: %zu, finally: %zu)\n",
+			(size_t)function->address,
 			tarot_num_parameters(function),
 			tarot_bool_string(tarot_returns(function)),
 			tarot_bool_string(tarot_is_method(function)),
 			tarot_num_variables(function),
-			function->finally
+			(size_t)function->finally
 		);
 	}
 	tarot_indent(stream, -1);
@@ -458,7 +648,7 @@ static void print_foreign_function_section(
 		struct tarot_function *function = &bytecode->foreign_functions[i];
 		const char *function_name = read_string(bytecode, function->address);
 		tarot_printf(
-			"[%zu] %s%s%s (parameters: %d, returns: %s)\n",
+			"[%zu] %s%s%s (parameters: %zu, returns: %s)\n",
 			i,
 			tarot_color_string(TAROT_COLOR_YELLOW),
 			function_name,
@@ -497,13 +687,20 @@ void tarot_print_bytecode(
  *****************************************************************************/
 
 struct tarot_generator {
-	struct tarot_bytecode_header *bytecode;
 	struct bytecode_offset {
-		uint16_t instructions;
-		uint16_t functions;
-		uint16_t foreign_functions;
-		uint16_t data;
+		size_t instructions;
+		size_t functions;
+		size_t foreign_functions;
+		size_t data;
 	} offset;
+	/* The sections grow as they are written and are copied into
+	 * the final bytecode once generation has finished. */
+	struct bytecode_capacity {
+		size_t instructions;
+		size_t functions;
+		size_t foreign_functions;
+		size_t data;
+	} capacity;
 	struct tarot_node *ref;
 	uint8_t *instructions;
 	uint8_t *functions;
@@ -511,14 +708,88 @@ struct tarot_generator {
 	uint8_t *data;
 	bool must_copy;
 	bool write_to;
+	bool used_scratch; /* scratch memory is in use by the current statement */
+	size_t num_elided_regions;
+	/* Data offsets of the string literals written so far, hashed by address.
+	 * Literals are interned, so each distinct text is only written once. */
+	struct literal {
+		struct tarot_string *string;
+		tarot_address offset;
+	} *literals;
+	size_t num_literals;
+	size_t literals_capacity;
+	/* Instruction offsets of the jump arguments of break statements
+	 * that still wait for the end address of their enclosing loop. */
+	size_t *breaks;
+	size_t num_breaks;
+	size_t breaks_capacity;
 };
 
 static void initialize_generator(struct tarot_generator *generator) {
 	memset(generator, 0, sizeof(*generator));
 }
 
-static bool read_only(struct tarot_generator *generator) {
-	return generator->bytecode == NULL;
+/**
+ * Makes room for at least size bytes in the given section,
+ * doubling its capacity as often as necessary.
+ */
+static uint8_t* grow_section(uint8_t *section, size_t *capacity, size_t size) {
+	if (size > *capacity) {
+		size_t new_capacity = *capacity > 0 ? *capacity : 256;
+		while (new_capacity < size) {
+			new_capacity *= 2;
+		}
+		section = tarot_realloc(section, new_capacity);
+		*capacity = new_capacity;
+	}
+	return section;
+}
+
+/* Returns the address at which size bytes of instructions can be written */
+static uint8_t* reserve_instructions(struct tarot_generator *generator, size_t size) {
+	generator->instructions = grow_section(
+		generator->instructions,
+		&generator->capacity.instructions,
+		generator->offset.instructions + size
+	);
+	return &generator->instructions[generator->offset.instructions];
+}
+
+/* Returns the address at which size bytes of data can be written */
+static uint8_t* reserve_data(struct tarot_generator *generator, size_t size) {
+	generator->data = grow_section(
+		generator->data,
+		&generator->capacity.data,
+		generator->offset.data + size
+	);
+	return &generator->data[generator->offset.data];
+}
+
+/* Returns the entry of the function with the given index */
+static struct tarot_function* reserve_function(
+	struct tarot_generator *generator,
+	size_t index
+) {
+	generator->functions = grow_section(
+		generator->functions,
+		&generator->capacity.functions,
+		(index + 1) * sizeof(struct tarot_function)
+	);
+	generator->offset.functions += sizeof(struct tarot_function);
+	return (struct tarot_function*)&generator->functions[index * sizeof(struct tarot_function)];
+}
+
+/* Returns the entry of the next foreign function */
+static struct tarot_function* reserve_foreign_function(struct tarot_generator *generator) {
+	struct tarot_function *function;
+	generator->foreign_functions = grow_section(
+		generator->foreign_functions,
+		&generator->capacity.foreign_functions,
+		generator->offset.foreign_functions + sizeof(*function)
+	);
+	function = (struct tarot_function*)&generator->foreign_functions[generator->offset.foreign_functions];
+	generator->offset.foreign_functions += sizeof(*function);
+	return function;
 }
 
 /**
@@ -528,12 +799,36 @@ static void write_instruction(
 	struct tarot_generator *generator,
 	enum tarot_opcode opcode
 ) {
-	if (not read_only(generator)) {
-		generator->instructions[generator->offset.instructions] = opcode;
-	}
+	*reserve_instructions(generator, 1) = opcode;
 	generator->offset.instructions++;
 }
 
+/**
+ * Writes a region instruction only if the enclosed code may allocate,
+ * otherwise counts it as elided for the bytecode statistics.
+ */
+static void write_region_instruction(
+	struct tarot_generator *generator,
+	enum tarot_opcode opcode,
+	bool is_required
+) {
+	if (is_required) {
+		write_instruction(generator, opcode);
+	} else {
+		generator->num_elided_regions++;
+	}
+}
+
+/**
+ * Releases the scratch memory at the end of a statement that used it.
+ */
+static void reset_scratch(struct tarot_generator *generator) {
+	if (generator->used_scratch) {
+		write_instruction(generator, OP_ResetScratch);
+		generator->used_scratch = false;
+	}
+}
+
 /**
  * Writes an argument for a preceding instruction to the instruction segment.
  */
@@ -541,9 +836,7 @@ static void write_instruction_argument_8bit(
 	struct tarot_generator *generator,
 	uint8_t value
 ) {
-	if (not read_only(generator)) {
-		tarot_write8bit(&generator->instructions[generator->offset.instructions], value);
-	}
+	tarot_write8bit(reserve_instructions(generator, sizeof(value)), value);
 	generator->offset.instructions += sizeof(value);
 }
 
@@ -554,9 +847,7 @@ static void write_instruction_argument_16bit(
 	struct tarot_generator *generator,
 	uint16_t value
 ) {
-	if (not read_only(generator)) {
-		tarot_write16bit(&generator->instructions[generator->offset.instructions], value);
-	}
+	tarot_write16bit(reserve_instructions(generator, sizeof(value)), value);
 	generator->offset.instructions += sizeof(value);
 }
 
@@ -567,9 +858,7 @@ static void write_instruction_argument_24bit(
 	struct tarot_generator *generator,
 	uint32_t value
 ) {
-	if (not read_only(generator)) {
-		tarot_write24bit(&generator->instructions[generator->offset.instructions], value);
-	}
+	tarot_write24bit(reserve_instructions(generator, sizeof(value)), value);
 	generator->offset.instructions += sizeof(value);
 }
 
@@ -578,14 +867,63 @@ static void write_instruction_argument_24bit(
  */
 static void write_argument(
 	struct tarot_generator *generator,
-	uint16_t value
+	tarot_address value
 ) {
-	if (not read_only(generator)) {
-		tarot_write16bit(&generator->instructions[generator->offset.instructions], value);
-	}
+	tarot_write_argument(reserve_instructions(generator, sizeof(value)), value);
+	generator->offset.instructions += sizeof(value);
+}
+
+/**
+ * Writes the variable index for a preceding LoadVariablePointer instruction.
+ */
+static void write_slot(
+	struct tarot_generator *generator,
+	tarot_slot value
+) {
+	tarot_write_slot(reserve_instructions(generator, sizeof(value)), value);
 	generator->offset.instructions += sizeof(value);
 }
 
+/**
+ * Writes a placeholder for a jump address that is not known yet and
+ * returns its offset, so it can be patched once the address is known.
+ */
+static size_t write_forward_argument(struct tarot_generator *generator) {
+	size_t offset = generator->offset.instructions;
+	write_argument(generator, 0);
+	return offset;
+}
+
+/**
+ * Patches the placeholder at the given offset to jump to the current
+ * end of the instruction segment.
+ */
+static void patch_argument(struct tarot_generator *generator, size_t offset) {
+	tarot_write_argument(&generator->instructions[offset], generator->offset.instructions);
+}
+
+/* Remembers the jump argument of a break statement for patch_breaks */
+static void write_break_argument(struct tarot_generator *generator) {
+	if (generator->num_breaks == generator->breaks_capacity) {
+		generator->breaks_capacity = generator->breaks_capacity > 0 ? generator->breaks_capacity * 2 : 16;
+		generator->breaks = tarot_realloc(
+			generator->breaks,
+			sizeof(*generator->breaks) * generator->breaks_capacity
+		);
+	}
+	generator->breaks[generator->num_breaks++] = write_forward_argument(generator);
+}
+
+/**
+ * Patches the break statements written since the given count to jump to
+ * the current end of the instruction segment, which is the end of the loop.
+ */
+static void patch_breaks(struct tarot_generator *generator, size_t first) {
+	while (generator->num_breaks > first) {
+		patch_argument(generator, generator->breaks[--generator->num_breaks]);
+	}
+}
+
 /**
  * Writes a boolean value to the instruction segment.
  */
@@ -599,9 +937,7 @@ static void write_boolean(struct tarot_generator *generator, bool value) {
 static void write_float(struct tarot_generator *generator, double value) {
 	write_instruction(generator, OP_PushFloat);
 	write_argument(generator, generator->offset.data);
-	if (not read_only(generator)) {
-		tarot_write_float(&generator->data[generator->offset.data], value);
-	}
+	tarot_write_float(reserve_data(generator, sizeof(value)), value);
 	generator->offset.data += sizeof(value);
 }
 
@@ -609,44 +945,101 @@ static void write_float(struct tarot_generator *generator, double value) {
  * Writes an integer value to the data segment.
  */
 static void write_integer(struct tarot_generator *generator, tarot_integer *value) {
+	size_t size = tarot_sizeof_integer(value);
 	write_instruction(generator, OP_PushInteger);
 	write_argument(generator, generator->offset.data);
-	if (not read_only(generator)) {
-		tarot_export_integer(&generator->data[generator->offset.data], value);
-	}
-	generator->offset.data += tarot_sizeof_integer(value);
+	tarot_export_integer(reserve_data(generator, size), value);
+	generator->offset.data += size;
 }
 
 /**
  * Writes a rational value to the data segment.
  */
 static void write_rational(struct tarot_generator *generator, tarot_rational *value) {
+	size_t size = tarot_sizeof_rational(value);
 	write_instruction(generator, OP_PushRational);
 	write_argument(generator, generator->offset.data);
-	if (not read_only(generator)) {
-		tarot_export_rational(&generator->data[generator->offset.data], value);
-	}
-	generator->offset.data += tarot_sizeof_rational(value);
+	tarot_export_rational(reserve_data(generator, size), value);
+	generator->offset.data += size;
 }
 
 /**
  * Writes a string value to the data segment.
  */
 static void write_string(struct tarot_generator *generator, struct tarot_string *value) {
-	if (not read_only(generator)) {
-		tarot_export_string(&generator->data[generator->offset.data], value);
+	size_t size = tarot_string_length(value) + 1;
+	tarot_export_string(reserve_data(generator, size), value);
+	generator->offset.data += size;
+}
+
+/* Returns the slot of the literal in the table of written literals */
+static struct literal* find_literal(
+	struct tarot_generator *generator,
+	struct tarot_string *value
+) {
+	size_t mask = generator->literals_capacity - 1;
+	size_t i = ((size_t)value ^ ((size_t)value >> 4)) & mask;
+	while (
+		generator->literals[i].string != NULL and
+		generator->literals[i].string != value
+	) {
+		i = (i + 1) & mask;
+	}
+	return &generator->literals[i];
+}
+
+static void grow_literals(struct tarot_generator *generator) {
+	struct literal *literals = generator->literals;
+	size_t capacity = generator->literals_capacity;
+	size_t i;
+	generator->literals_capacity = capacity > 0 ? capacity * 2 : 64;
+	generator->literals = tarot_malloc(
+		sizeof(*literals) * generator->literals_capacity
+	);
+	for (i = 0; i < capacity; i++) {
+		if (literals[i].string != NULL) {
+			*find_literal(generator, literals[i].string) = literals[i];
+		}
+	}
+	tarot_free(literals);
+}
+
+static void forget_literals(struct tarot_generator *generator) {
+	tarot_free(generator->literals);
+	generator->literals = NULL;
+	generator->num_literals = 0;
+	generator->literals_capacity = 0;
+}
+
+/**
+ * Writes a string literal to the data segment unless it has already been
+ * written and returns its address.
+ */
+static tarot_address write_literal(
+	struct tarot_generator *generator,
+	struct tarot_string *value
+) {
+	struct literal *literal;
+	if ((generator->num_literals + 1) * 2 > generator->literals_capacity) {
+		grow_literals(generator);
 	}
-	generator->offset.data += tarot_string_length(value) + 1;
+	literal = find_literal(generator, value);
+	if (literal->string == NULL) {
+		literal->string = value;
+		literal->offset = generator->offset.data;
+		generator->num_literals++;
+		write_string(generator, value);
+	}
+	return literal->offset;
 }
 
 /**
- * Writes a string value to the data segment and pushes the address to
+ * Writes a string literal to the data segment and pushes the address to
  * the stack via the PushString instruction.
  */
 static void push_string(struct tarot_generator *generator, struct tarot_string *value) {
 	write_instruction(generator, OP_PushString);
-	write_argument(generator, generator->offset.data);
-	write_string(generator, value);
+	write_argument(generator, write_literal(generator, value));
 }
 
 /**
@@ -655,93 +1048,70 @@ static void push_string(struct tarot_generator *generator, struct tarot_string *
 static void write_debug(struct tarot_generator *generator, struct tarot_string *value) {
 	write_instruction(generator, OP_Debug);
 	write_argument(generator, generator->offset.data);
-	if (not read_only(generator)) {
-		tarot_export_string(&generator->data[generator->offset.data], value);
-	}
-	generator->offset.data += tarot_string_length(value) + 1;
+	write_string(generator, value);
 }
 
 /**
  * Registers the given function in the function segment
  */
 static void register_function(struct tarot_generator *generator, struct tarot_node *node) {
-	struct tarot_function *function;
-	if (not read_only(generator)) {
-		function = function_index(generator->bytecode, FunctionDefinition(node)->index);
-		tarot_setup_function(
-			function,
-			FunctionDefinition(node)->address,
-			FunctionDefinition(node)->finally,
-			Block(FunctionDefinition(node)->parameters)->num_elements,
-			tarot_list_length(FunctionDefinition(node)->scope)
-			- Block(FunctionDefinition(node)->parameters)->num_elements,
-			FunctionDefinition(node)->return_value != NULL,
-			false
-		);
-	}
-	generator->offset.functions += sizeof(*function);
+	tarot_setup_function(
+		reserve_function(generator, FunctionDefinition(node)->index),
+		FunctionDefinition(node)->address,
+		FunctionDefinition(node)->finally,
+		Block(FunctionDefinition(node)->parameters)->num_elements,
+		scope_length(FunctionDefinition(node)->scope)
+		- Block(FunctionDefinition(node)->parameters)->num_elements,
+		FunctionDefinition(node)->return_value != NULL,
+		false
+	);
 }
 
 static void register_method(struct tarot_generator *generator, struct tarot_node *node) {
-	struct tarot_function *function;
-	if (not read_only(generator)) {
-		function = function_index(generator->bytecode, MethodDefinition(node)->index);
-		tarot_setup_function(
-			function,
-			generator->offset.instructions,
-			generator->offset.instructions,
-			Block(MethodDefinition(node)->parameters)->num_elements,
-			tarot_list_length(MethodDefinition(node)->scope)
-			- Block(MethodDefinition(node)->parameters)->num_elements,
-			MethodDefinition(node)->return_value != NULL,
-			false
-		);
-	}
-	generator->offset.functions += sizeof(*function);
+	tarot_setup_function(
+		reserve_function(generator, MethodDefinition(node)->index),
+		generator->offset.instructions,
+		generator->offset.instructions,
+		Block(MethodDefinition(node)->parameters)->num_elements,
+		scope_length(MethodDefinition(node)->scope)
+		- Block(MethodDefinition(node)->parameters)->num_elements,
+		MethodDefinition(node)->return_value != NULL,
+		false
+	);
 }
 
 static void register_constructor(struct tarot_generator *generator, struct tarot_node *node) {
-	struct tarot_function *function;
-	if (not read_only(generator)) {
-		function = function_index(generator->bytecode, ClassConstructor(node)->index);
-		tarot_setup_function(
-			function,
-			generator->offset.instructions,
-			generator->offset.instructions,
-			Block(ClassConstructor(node)->parameters)->num_elements,
-			tarot_list_length(ClassConstructor(node)->scope)
-			- Block(ClassConstructor(node)->parameters)->num_elements,
-			true,
-			true
-		);
-	}
-	generator->offset.functions += sizeof(*function);
+	tarot_setup_function(
+		reserve_function(generator, ClassConstructor(node)->index),
+		generator->offset.instructions,
+		generator->offset.instructions,
+		Block(ClassConstructor(node)->parameters)->num_elements,
+		scope_length(ClassConstructor(node)->scope)
+		- Block(ClassConstructor(node)->parameters)->num_elements,
+		true,
+		true
+	);
 }
 
 /**
  * Registers the given foreign function in the function segment
  */
 static void register_foreign_function(struct tarot_generator *generator, struct tarot_node *node) {
-	struct tarot_function *function;
-	if (not read_only(generator)) {
-		function = (struct tarot_function*)&generator->foreign_functions[generator->offset.foreign_functions];
-		tarot_setup_function(
-			function,
-			generator->offset.data,
-			generator->offset.data,
-			Block(ForeignFunction(node)->parameters)->num_elements,
-			0,
-			ForeignFunction(node)->return_value != NULL,
-			false
-		);
-	}
+	tarot_setup_function(
+		reserve_foreign_function(generator),
+		generator->offset.data,
+		generator->offset.data,
+		Block(ForeignFunction(node)->parameters)->num_elements,
+		0,
+		ForeignFunction(node)->return_value != NULL,
+		false
+	);
 	write_string(generator, name_of(node));
-	generator->offset.foreign_functions += sizeof(*function);
 }
 
 /**
- * Allocates bytecode based on the offsets determined in
- * an initial read-only generator pass over the abstract syntax tree.
+ * Allocates the bytecode and copies the sections that were
+ * written by the generator into it.
  */
 static struct tarot_bytecode_header* allocate_bytecode(struct tarot_generator *generator) {
 	struct tarot_bytecode_header *bytecode = NULL;
@@ -754,33 +1124,125 @@ static struct tarot_bytecode_header* allocate_bytecode(struct tarot_generator *g
 	);
 	bytecode = tarot_malloc(total_size);
 	strcpy(bytecode->magic, "TAROT");
-	bytecode->flags = 0x00;
+	bytecode->flags = TAROT_BYTECODE_FORMAT;
 	bytecode->size.instructions = generator->offset.instructions;
 	bytecode->size.functions    = generator->offset.functions;
 	bytecode->size.foreign_functions = generator->offset.foreign_functions;
 	bytecode->size.data         = generator->offset.data;
+	assert(generator->offset.functions <= generator->capacity.functions);
+	if (generator->offset.instructions > 0) {
+		memcpy(tarot_bytecode_instructions(bytecode), generator->instructions, generator->offset.instructions);
+	}
+	if (generator->offset.functions > 0) {
+		memcpy(tarot_bytecode_functions(bytecode), generator->functions, generator->offset.functions);
+	}
+	if (generator->offset.foreign_functions > 0) {
+		memcpy(tarot_bytecode_foreign_functions(bytecode), generator->foreign_functions, generator->offset.foreign_functions);
+	}
+	if (generator->offset.data > 0) {
+		memcpy(tarot_bytecode_data(bytecode), generator->data, generator->offset.data);
+	}
 	return bytecode;
 }
 
 /**
- * Sets the bytecode attribute of the given generator and thereby
- * grants it write privileges to said bytecode.
+ * Releases the sections and tables owned by the generator.
  */
-static void set_bytecode(
-	struct tarot_generator *generator,
-	struct tarot_bytecode_header *bytecode
-) {
-	initialize_generator(generator); /* rewind */
-	generator->bytecode = bytecode;
-	generator->instructions = tarot_bytecode_instructions(bytecode);
-	generator->functions = tarot_bytecode_functions(bytecode);
-	generator->foreign_functions = tarot_bytecode_foreign_functions(bytecode);
-	generator->data = tarot_bytecode_data(bytecode);
+static void free_generator(struct tarot_generator *generator) {
+	tarot_free(generator->instructions);
+	tarot_free(generator->functions);
+	tarot_free(generator->foreign_functions);
+	tarot_free(generator->data);
+	tarot_free(generator->breaks);
+	forget_literals(generator);
+}
+
+/**
+ * Reports an error if a section outgrew the addresses of the bytecode format.
+ */
+static bool exceeds_limits(struct tarot_generator *generator) {
+	const char *section = NULL;
+	if (generator->offset.instructions > TAROT_MAX_ADDRESS) {
+		section = "instructions";
+	} else if (generator->offset.data > TAROT_MAX_ADDRESS) {
+		section = "data";
+	} else if (generator->offset.functions > TAROT_MAX_ADDRESS) {
+		section = "functions";
+	} else if (generator->offset.foreign_functions > TAROT_MAX_ADDRESS) {
+		section = "foreign functions";
+	}
+	if (section != NULL) {
+		tarot_error(
+			"The %s of the program exceed the %zu Bytes addressable by the %s bytecode format!",
+			section,
+			(size_t)TAROT_MAX_ADDRESS,
+			TAROT_BYTECODE_FORMAT ? "wide" : "compact"
+		);
+		return true;
+	}
+	return false;
 }
 
 /* Forward declaration */
 static void generate(struct tarot_generator *generator, struct tarot_node *node);
 
+TAROT_INLINE
+static size_t constant_slot(tarot_address address, size_t capacity) {
+	return (address * 2654435761UL) & (capacity - 1);
+}
+
+/* Turns the interned literals into immortal strings, which the virtual
+ * machine pushes instead of creating a string from the data section */
+static void create_constants(
+	struct tarot_generator *generator,
+	struct tarot_bytecode *bytecode
+) {
+	size_t i;
+	if (generator->num_literals == 0) {
+		return;
+	}
+	bytecode->constants_capacity = generator->literals_capacity;
+	bytecode->constants = tarot_malloc(sizeof(*bytecode->constants) * bytecode->constants_capacity);
+	for (i = 0; i < generator->literals_capacity; i++) {
+		struct literal *literal = &generator->literals[i];
+		if (literal->string != NULL) {
+			size_t slot = constant_slot(literal->offset, bytecode->constants_capacity);
+			while (bytecode->constants[slot].string != NULL) {
+				slot = (slot + 1) & (bytecode->constants_capacity - 1);
+			}
+			bytecode->constants[slot].address = literal->offset;
+			bytecode->constants[slot].string = tarot_copy_string(literal->string);
+			tarot_make_immortal(bytecode->constants[slot].string);
+		}
+	}
+}
+
+static void free_constants(struct tarot_bytecode *bytecode) {
+	size_t i;
+	for (i = 0; i < bytecode->constants_capacity; i++) {
+		tarot_free(bytecode->constants[i].string);
+	}
+	tarot_free(bytecode->constants);
+}
+
+struct tarot_string* tarot_string_constant(
+	struct tarot_bytecode *bytecode,
+	tarot_address address
+) {
+	size_t slot;
+	if (bytecode->constants == NULL) {
+		return NULL;
+	}
+	slot = constant_slot(address, bytecode->constants_capacity);
+	while (bytecode->constants[slot].string != NULL) {
+		if (bytecode->constants[slot].address == address) {
+			return bytecode->constants[slot].string;
+		}
+		slot = (slot + 1) & (bytecode->constants_capacity - 1);
+	}
+	return NULL;
+}
+
 struct tarot_bytecode* tarot_create_bytecode(struct tarot_node *ast) {
 	struct tarot_bytecode *bytecode = NULL;
 	struct tarot_generator generator;
@@ -788,16 +1250,23 @@ struct tarot_bytecode* tarot_create_bytecode(struct tarot_node *ast) {
 		struct tarot_bytecode_header *header = NULL;
 		initialize_generator(&generator);
 		generate(&generator, ast);
-		header = allocate_bytecode(&generator);
-		set_bytecode(&generator, header);
-		generate(&generator, ast);
-		bytecode = construct_bytecode_interface(header);
+		assert(generator.num_breaks == 0);
+		if (not exceeds_limits(&generator)) {
+			header = allocate_bytecode(&generator);
+			bytecode = construct_bytecode_interface(header);
+			bytecode->num_elided_regions = generator.num_elided_regions;
+			create_constants(&generator, bytecode);
+		}
+		free_generator(&generator);
 	}
 	return bytecode;
 }
 
 void tarot_free_bytecode(struct tarot_bytecode *bytecode) {
 	if (bytecode != NULL) {
+		free_constants(bytecode);
+		tarot_free(bytecode->foreign_index);
+		tarot_free(bytecode->bindings);
 		tarot_free(bytecode->header);
 		tarot_free(bytecode);
 	}
@@ -829,6 +1298,7 @@ static void generate_block(
 	size_t i;
 	for (i = 0; i < Block(node)->num_elements; i++) {
 		generate(generator, Block(node)->elements[i]);
+		reset_scratch(generator);
 	}
 }
 
@@ -1161,6 +1631,11 @@ static void generate_abs(
 	}
 }
 
+static void generate_channel_call(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+);
+
 static void generate_function_call(
 	struct tarot_generator *generator,
 	struct tarot_node *node
@@ -1180,12 +1655,17 @@ static void generate_function_call(
 		generate(generator, FunctionCall(node)->arguments);
 		write_instruction(generator, OP_CallForeignFunction);
 		write_argument(generator, index_of(definition_of(node)));
+		write_argument(generator, Type(type_of(node))->type);
 	} else if (kind_of(definition_of(node)) == NODE_Builtin) {
 		struct tarot_node *definition = definition_of(node); /* NODE_builtin */
+		if (Builtin(definition)->builtin_type == TYPE_CHANNEL) {
+			generate_channel_call(generator, node);
+			return;
+		}
 		generator->must_copy = true;
 		generate(generator, FunctionCall(node)->arguments);
 		write_instruction(generator, OP_LoadVariablePointer);
-		write_instruction_argument_8bit(generator, tarot_cast8bit(index_of(Relation(FunctionCall(node)->identifier)->parent)));
+		write_slot(generator, index_of(Relation(FunctionCall(node)->identifier)->parent));
 		generator->must_copy = false;
 		write_instruction(generator, OP_ListAppend);
 	} else if (kind_of(definition_of(node)) == NODE_Class) {
@@ -1230,6 +1710,24 @@ static void generate_subscript(
 	struct tarot_node *node
 ) {
 	generate(generator, Subscript(node)->identifier);
+	if (generator->write_to) {
+		/* The container was pushed as a pointer, the index is read as usual */
+		generator->write_to = false;
+		generate(generator, Subscript(node)->index);
+		generator->write_to = true;
+		switch (Type(type_of(Subscript(node)->identifier))->type) {
+			default:
+				tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase!");
+				break;
+			case TYPE_LIST:
+				write_instruction(generator, OP_LoadListIndex);
+				break;
+			case TYPE_DICT:
+				write_instruction(generator, OP_LoadDictIndex);
+				break;
+		}
+		return;
+	}
 	generate(generator, Subscript(node)->index);
 	switch (Type(type_of(Subscript(node)->identifier))->type) {
 		default:
@@ -1335,24 +1833,86 @@ static void generate_dict(
 	struct tarot_node *node
 ) {
 	size_t i;
+	bool must_copy = generator->must_copy;
+	/* The dict owns its elements, so variables are copied into it */
+	generator->must_copy = true;
 	for (i = 0; i < Dict(node)->num_elements; i++) {
 		generate(generator, Dict(node)->elements[i]);
 	}
+	generator->must_copy = must_copy;
 	write_instruction(generator, OP_PushDict);
 	write_argument(generator, Dict(node)->num_elements);
+	write_instruction_argument_8bit(generator, Type(Type(type_of(node))->subtype)->type);
 }
 
-static void generate_fstring(
+static void generate_channel(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
+	struct tarot_node *capacity = ChannelExpression(node)->capacity;
+	if (capacity != NULL) {
+		generate(generator, capacity);
+	}
+	write_instruction(generator, OP_PushChannel);
+	write_instruction_argument_8bit(generator, Type(Type(type_of(node))->subtype)->type);
+	write_instruction_argument_8bit(generator, capacity != NULL);
+}
+
+/* Returns the datatype a piece is formatted from by OP_StringBuild */
+static enum tarot_datatype piece_type(struct tarot_node *piece) {
+	enum tarot_datatype type;
+	if (kind_of(piece) == NODE_FStringString) {
+		return TYPE_VOID;
+	}
+	type = Type(type_of(piece))->type;
+	return type == TYPE_LIST ? TYPE_STRING : type;
+}
+
+/* Joins the pieces from first onwards with a single OP_StringBuild */
+static void generate_pieces(
+	struct tarot_generator *generator,
+	struct tarot_node *node,
+	size_t first,
+	bool is_temporary
+) {
+	struct tarot_node *piece;
 	size_t i;
-	for (i = 0; i < FString(node)->num_elements; i++) {
-		generate(generator, FString(node)->elements[i]);
-		if (i > 0) {
-			write_instruction(generator, OP_StringConcat);
+	for (i = first; i < FString(node)->num_elements; i++) {
+		piece = FString(node)->elements[i];
+		switch (piece_type(piece)) {
+			default:
+				generate(generator, FStringExpression(piece)->expression);
+				break;
+			case TYPE_VOID:
+				break;
+			case TYPE_STRING:
+				generate(generator, piece);
+				break;
 		}
 	}
+	write_instruction(generator, is_temporary ? OP_ScratchStringBuild : OP_StringBuild);
+	write_argument(generator, FString(node)->num_elements - first);
+	for (i = first; i < FString(node)->num_elements; i++) {
+		piece = FString(node)->elements[i];
+		write_instruction_argument_8bit(generator, piece_type(piece));
+		if (kind_of(piece) == NODE_FStringString) {
+			write_argument(generator, write_literal(generator, FStringString(piece)->value));
+		}
+	}
+	if (is_temporary) {
+		generator->used_scratch = true;
+	}
+}
+
+static void generate_fstring(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+) {
+	if (FString(node)->num_elements == 1 and not FString(node)->is_temporary) {
+		generate(generator, FString(node)->elements[0]);
+	} else {
+		generate_pieces(generator, node, 0, FString(node)->is_temporary);
+	}
 }
 
 static void generate_fstring_string(
@@ -1401,14 +1961,111 @@ static void generate_raise(
 }
 
 /* If not used at final return, might free before initialization! */
+static void generate_copy(struct tarot_generator *generator, struct tarot_node *node) {
+	switch (Type(type_of(node))->type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			write_instruction(generator, OP_CopyInteger);
+			break;
+		case TYPE_RATIONAL:
+			write_instruction(generator, OP_CopyRational);
+			break;
+		case TYPE_STRING:
+			write_instruction(generator, OP_CopyString);
+			break;
+		case TYPE_LIST:
+			write_instruction(generator, OP_CopyList);
+			break;
+		case TYPE_DICT:
+			write_instruction(generator, OP_CopyDict);
+			break;
+		case TYPE_CHANNEL:
+			write_instruction(generator, OP_CopyChannel);
+			break;
+	}
+}
+
+/* A variable read for the last time hands over its value instead of a copy */
+static bool is_moved(struct tarot_node *value) {
+	if (kind_of(value) != NODE_Identifier or not Identifier(value)->is_last_use) {
+		return false;
+	}
+	if (kind_of(link_of(value)) != NODE_Variable) {
+		return false;
+	}
+	switch (Type(type_of(value))->type) {
+		default:
+			return false;
+		case TYPE_INTEGER:
+		case TYPE_RATIONAL:
+		case TYPE_STRING:
+		case TYPE_LIST:
+		case TYPE_DICT:
+		case TYPE_CHANNEL:
+			return true;
+	}
+}
+
+static void generate_move(struct tarot_generator *generator, struct tarot_node *value) {
+	write_instruction(generator, OP_MoveValue);
+	write_argument(generator, index_of(link_of(value)));
+}
+
+static void free_variable(
+	struct tarot_generator *generator,
+	struct tarot_node *symbol
+) {
+	switch (Type(type_of(symbol))->type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_FreeInteger);
+			break;
+		case TYPE_RATIONAL:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_FreeRational);
+			break;
+		case TYPE_STRING:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_FreeString);
+			break;
+		case TYPE_LIST:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_FreeList);
+			break;
+		case TYPE_DICT:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_FreeDict);
+			write_argument(generator, Type(Type(type_of(symbol))->subtype)->type);
+			break;
+		case TYPE_CHANNEL:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_FreeChannel);
+			break;
+		case TYPE_CUSTOM:
+			write_instruction(generator, OP_LoadVariablePointer);
+			write_slot(generator, index_of(symbol));
+			write_instruction(generator, OP_Read);
+			write_instruction(generator, OP_DeleteObject);
+	}
+}
+
 static void free_function_variables(
 	struct tarot_generator *generator,
-	struct tarot_list *scope,
+	struct scope *scope,
 	struct tarot_node *except
 ) {
 	size_t i;
-	for (i = 0; i < tarot_list_length(scope); i++) {
-		struct tarot_node *symbol = *(struct tarot_node**)tarot_list_element(scope, i);
+	for (i = 0; i < scope_length(scope); i++) {
+		struct tarot_node *symbol = scope_symbol(scope, i);
 		if (kind_of(symbol) != NODE_Variable) {
 			continue;
 		}
@@ -1417,41 +2074,80 @@ static void free_function_variables(
 				continue; /* skip this symbol */
 			}
 		}
-		switch (Type(type_of(symbol))->type) {
-			default:
-				break;
-			case TYPE_INTEGER:
-				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, tarot_cast8bit(index_of(symbol)));
-				write_instruction(generator, OP_FreeInteger);
-				break;
-			case TYPE_RATIONAL:
-				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, index_of(symbol));
-				write_instruction(generator, OP_FreeRational);
-				break;
-			case TYPE_STRING:
-				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, index_of(symbol));
-				write_instruction(generator, OP_FreeString);
-				break;
-			case TYPE_LIST:
-				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, index_of(symbol));
-				write_instruction(generator, OP_FreeList);
-				break;
-			case TYPE_DICT:
-				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, index_of(symbol));
-				write_instruction(generator, OP_FreeDict);
-				write_argument(generator, Type(Type(type_of(symbol))->subtype)->type);
-				break;
-			case TYPE_CUSTOM:
-				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, index_of(symbol));
-				write_instruction(generator, OP_Read);
-				write_instruction(generator, OP_DeleteObject);
-		}
+		free_variable(generator, symbol);
+	}
+}
+
+/* Hands a value over to another thread, as an argument of a launched
+ * thread or over a channel. The value outlives the current statement.
+ * Returns whether the other thread owns the value and must free it. */
+static bool generate_handover(
+	struct tarot_generator *generator,
+	struct tarot_node *expression
+) {
+	/* Like return values, borrowed arguments are copied */
+	bool is_borrowed = (
+		kind_of(expression) == NODE_Identifier or
+		kind_of(expression) == NODE_Subscript or
+		kind_of(expression) == NODE_Relation
+	);
+	generate(generator, expression);
+	switch (Type(type_of(expression))->type) {
+		default:
+			return false;
+		case TYPE_INTEGER:
+		case TYPE_RATIONAL:
+		case TYPE_STRING:
+		case TYPE_LIST:
+		case TYPE_DICT:
+		case TYPE_CHANNEL:
+			if (is_borrowed) {
+				generate_copy(generator, expression);
+			}
+			write_instruction(generator, OP_UnTrack);
+			return true;
+		case TYPE_CUSTOM:
+			if (is_borrowed) {
+				write_instruction(generator, OP_CopyObject);
+			}
+			write_instruction(generator, OP_UnTrack);
+			return true;
+	}
+}
+
+static void generate_launch(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+) {
+	struct tarot_node *call = LaunchStatement(node)->call;
+	struct tarot_node *arguments = FunctionCall(call)->arguments;
+	bool owned[TAROT_MAX_PARAMETERS];
+	size_t i;
+	for (i = 0; i < Block(arguments)->num_elements; i++) {
+		owned[i] = generate_handover(generator, Block(arguments)->elements[i]);
+		reset_scratch(generator);
+	}
+	write_instruction(generator, OP_Launch);
+	write_argument(generator, index_of(definition_of(call)));
+	for (i = 0; i < Block(arguments)->num_elements; i++) {
+		write_instruction_argument_8bit(generator, owned[i]);
+	}
+}
+
+/* Sends or receives a value over a channel */
+static void generate_channel_call(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+) {
+	struct tarot_node *relation = FunctionCall(node)->identifier;
+	struct tarot_node *arguments = FunctionCall(node)->arguments;
+	generate(generator, Relation(relation)->parent);
+	if (tarot_match_string(Relation(relation)->child, "send")) {
+		bool owned = generate_handover(generator, Block(arguments)->elements[0]);
+		write_instruction(generator, OP_ChannelSend);
+		write_instruction_argument_8bit(generator, owned);
+	} else {
+		write_instruction(generator, OP_ChannelReceive);
 	}
 }
 
@@ -1463,13 +2159,43 @@ static void generate_return(
 		/* Copy value, for all others we can return without copy (remove ccopy in vm.c op_returnvalue)
 	}*/
 	/* Need to free all variables except the one we are returning */
-	free_function_variables(generator, scope_of(ReturnStatement(node)->function), ReturnStatement(node)->expression);
-	generate(generator, ReturnStatement(node)->expression);
-	if (kind_of(ReturnStatement(node)->expression) != NODE_Identifier) {
-		write_instruction(generator, OP_UnTrack);
+	struct tarot_node *expression = ReturnStatement(node)->expression;
+	free_function_variables(generator, scope_of(ReturnStatement(node)->function), expression);
+	if (kind_of(expression) == NODE_Identifier and kind_of(link_of(expression)) == NODE_Variable) {
+		/* The variable was spared above, its value moves to the caller */
+		write_instruction(generator, OP_LoadValue);
+		write_argument(generator, index_of(link_of(expression)));
+	} else {
+		/* Parameters, elements and attributes are borrowed from elsewhere */
+		bool is_borrowed = (
+			kind_of(expression) == NODE_Identifier or
+			kind_of(expression) == NODE_Subscript or
+			kind_of(expression) == NODE_Relation
+		);
+		generate(generator, expression);
+		switch (Type(type_of(expression))->type) {
+			default:
+				break;
+			case TYPE_INTEGER:
+			case TYPE_RATIONAL:
+			case TYPE_STRING:
+			case TYPE_LIST:
+			case TYPE_DICT:
+			case TYPE_CHANNEL:
+				if (is_borrowed) {
+					generate_copy(generator, expression);
+				}
+				write_instruction(generator, OP_UnTrack);
+				break;
+			case TYPE_CUSTOM:
+				if (not is_borrowed) {
+					write_instruction(generator, OP_UnTrack);
+				}
+				break;
+		}
 	}
 	write_instruction(generator, OP_Return);
-	write_argument(generator, Type(type_of(ReturnStatement(node)->expression))->type);
+	write_argument(generator, Type(type_of(expression))->type);
 }
 
 static void generate_assert(
@@ -1534,7 +2260,6 @@ static void generate_function(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
-	register_function(generator, node);
 	FunctionDefinition(node)->address = generator->offset.instructions;
 	write_debug(generator, name_of(node));
 	generate(generator, FunctionDefinition(node)->block);
@@ -1542,6 +2267,7 @@ static void generate_function(
 	free_function_variables(generator, scope_of(node), NULL);
 	write_instruction(generator, OP_Return);
 	write_argument(generator, TYPE_VOID);
+	register_function(generator, node); /* once the finally address is known */
 }
 
 static void generate_method(
@@ -1571,22 +2297,6 @@ static void generate_namespace(
 	generate(generator, Namespace(node)->block);
 }
 
-static void generate_copy(struct tarot_generator *generator, struct tarot_node *node) {
-	switch (Type(type_of(node))->type) {
-		default:
-			break;
-		case TYPE_INTEGER:
-			write_instruction(generator, OP_CopyInteger);
-			break;
-		case TYPE_RATIONAL:
-			write_instruction(generator, OP_CopyRational);
-			break;
-		case TYPE_STRING:
-			write_instruction(generator, OP_CopyString);
-			break;
-	}
-}
-
 static void generate_identifier(
 	struct tarot_generator *generator,
 	struct tarot_node *node
@@ -1597,6 +2307,11 @@ static void generate_identifier(
 			break;
 		case NODE_Variable:
 		case NODE_Constant:
+			if (generator->write_to) {
+				write_instruction(generator, OP_LoadVariablePointer);
+				write_slot(generator, index_of(link_of(node)));
+				break;
+			}
 			write_instruction(generator, OP_LoadValue);
 			write_argument(generator, index_of(link_of(node)));
 			if (generator->must_copy) {
@@ -1628,77 +2343,221 @@ static void generate_if(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
+	size_t middle;
+	size_t end = 0;
 	generate(generator, IfStatement(node)->condition);
 	write_instruction(generator, OP_GotoIfFalse);
-	write_argument(generator, IfStatement(node)->middle);
+	middle = write_forward_argument(generator);
 	generate(generator, IfStatement(node)->block);
 	if (IfStatement(node)->elseif != NULL) {
 		write_instruction(generator, OP_Goto);
-		write_argument(generator, IfStatement(node)->end);
+		end = write_forward_argument(generator);
+	}
+	patch_argument(generator, middle);
+	if (IfStatement(node)->elseif != NULL) {
+		generate(generator, IfStatement(node)->elseif);
+		patch_argument(generator, end);
 	}
-	IfStatement(node)->middle = generator->offset.instructions;
-	generate(generator, IfStatement(node)->elseif);
-	IfStatement(node)->end = generator->offset.instructions;
 }
 
 static void generate_while(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
+	bool condition_region = WhileLoop(node)->condition_allocates;
+	bool block_region = Block(WhileLoop(node)->block)->allocates;
+	size_t first_break = generator->num_breaks;
+	size_t end;
 	WhileLoop(node)->start = generator->offset.instructions;
-	write_instruction(generator, OP_PushRegion);
+	write_region_instruction(generator, OP_PushRegion, condition_region);
 	generate(generator, WhileLoop(node)->condition);
+	reset_scratch(generator);
 	write_instruction(generator, OP_GotoIfFalse);
-	write_argument(generator, WhileLoop(node)->end);
-	write_instruction(generator, OP_PushRegion);
+	end = write_forward_argument(generator);
+	write_region_instruction(generator, OP_PushRegion, block_region);
 	generate(generator, WhileLoop(node)->block);
-	write_instruction(generator, OP_PopRegion);
-	write_instruction(generator, OP_PopRegion);
+	write_region_instruction(generator, OP_PopRegion, block_region);
+	write_region_instruction(generator, OP_PopRegion, condition_region);
 	write_instruction(generator, OP_Goto);
 	write_argument(generator, WhileLoop(node)->start);
-	WhileLoop(node)->end = generator->offset.instructions;
-	write_instruction(generator, OP_PopRegion);
+	patch_argument(generator, end);
+	patch_breaks(generator, first_break);
+	write_region_instruction(generator, OP_PopRegion, condition_region);
 }
 
-static void generate_for(
+/* Iterates from the current value of the iterator up to the end of the
+ * range, or up to the end of its chunk in a parallel loop */
+static void generate_iterations(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
-	generate(generator, ForLoop(node)->identifier); /* Initial assign of iterator start value */
+	bool condition_region = ForLoop(node)->condition_allocates;
+	bool block_region = ForLoop(node)->block_allocates;
+	size_t first_break = generator->num_breaks;
+	size_t end;
 	ForLoop(node)->start = generator->offset.instructions;
-	write_instruction(generator, OP_PushRegion);
+	write_region_instruction(generator, OP_PushRegion, condition_region);
 	write_instruction(generator, OP_LoadValue);
 	write_argument(generator, Variable(ForLoop(node)->identifier)->index);
-	generate(generator, RangeExpression(ForLoop(node)->expression)->end);
+	if (ForLoop(node)->is_parallel) {
+		write_instruction(generator, OP_ChunkEnd);
+	} else {
+		generate(generator, RangeExpression(ForLoop(node)->expression)->end);
+	}
 	write_instruction(generator, OP_IntegerLessThan);
 	write_instruction(generator, OP_GotoIfFalse);
-	write_argument(generator, ForLoop(node)->end);
-	write_instruction(generator, OP_PushRegion);
+	end = write_forward_argument(generator);
+	write_region_instruction(generator, OP_PushRegion, block_region);
 	generate(generator, ForLoop(node)->block);
 	write_instruction(generator, OP_LoadValue);
 	write_argument(generator, Variable(ForLoop(node)->identifier)->index);
 	generate(generator, RangeExpression(ForLoop(node)->expression)->stepsize);
 	write_instruction(generator, OP_IntegerAddition);
 	write_instruction(generator, OP_LoadVariablePointer);
-	write_argument(generator, Variable(ForLoop(node)->identifier)->index);
+	write_slot(generator, Variable(ForLoop(node)->identifier)->index);
 	write_instruction(generator, OP_StoreInteger);
-	write_instruction(generator, OP_PopRegion);
-	write_instruction(generator, OP_PopRegion);
+	write_region_instruction(generator, OP_PopRegion, block_region);
+	write_region_instruction(generator, OP_PopRegion, condition_region);
 	write_instruction(generator, OP_Goto);
 	write_argument(generator, ForLoop(node)->start);
-	ForLoop(node)->end = generator->offset.instructions;
+	patch_argument(generator, end);
+	patch_breaks(generator, first_break);
+	write_region_instruction(generator, OP_PopRegion, condition_region);
+}
+
+static void free_chunk_variable(
+	struct tarot_node **nodeptr,
+	struct scope_stack *stack,
+	void *data
+) {
+	unused(stack);
+	if (kind_of(*nodeptr) == NODE_Variable) {
+		free_variable(data, *nodeptr);
+	}
+}
+
+/* The chunks run the loop on threads of their own. They borrow the
+ * variables of the function and free the ones declared in the body */
+static void generate_parallel_for(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+) {
+	struct tarot_node *iterator = ForLoop(node)->identifier;
+	struct tarot_node *reduction = ForLoop(node)->reduction;
+	size_t join;
+	write_instruction(generator, OP_PushRegion);
+	generate(generator, Variable(iterator)->value);
+	generate(generator, RangeExpression(ForLoop(node)->expression)->end);
+	generate(generator, RangeExpression(ForLoop(node)->expression)->stepsize);
+	write_instruction(generator, OP_ParallelFor);
+	write_slot(generator, index_of(iterator));
+	if (reduction != NULL) {
+		write_slot(generator, index_of(link_of(reduction)));
+		write_instruction_argument_8bit(generator, Type(type_of(reduction))->type);
+	} else {
+		write_slot(generator, 0);
+		write_instruction_argument_8bit(generator, TYPE_VOID);
+	}
+	write_instruction_argument_8bit(generator, ForLoop(node)->operator);
+	write_instruction_argument_8bit(generator, ForLoop(node)->is_ordered);
+	join = write_forward_argument(generator);
+	generate_iterations(generator, node);
+	free_variable(generator, iterator);
+	tarot_traverse(&ForLoop(node)->block, free_chunk_variable, NULL, generator);
+	write_instruction(generator, OP_EndChunk);
+	patch_argument(generator, join);
+	write_instruction(generator, OP_JoinChunks);
 	write_instruction(generator, OP_PopRegion);
 }
 
+static void generate_for(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+) {
+	if (ForLoop(node)->is_parallel) {
+		generate_parallel_for(generator, node);
+		return;
+	}
+	generate(generator, ForLoop(node)->identifier); /* Initial assign of iterator start value */
+	generate_iterations(generator, node);
+}
+
+static enum tarot_opcode in_place_opcode(struct tarot_node *value) {
+	if (kind_of(value) == NODE_FString) {
+		return OP_StringAppendInPlace;
+	}
+	switch (Type(type_of(value))->type) {
+		default:
+			tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase!");
+			return OP_NoOperation;
+		case TYPE_INTEGER:
+			switch (ArithmeticExpression(value)->operator) {
+				default:
+					tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase!");
+					return OP_NoOperation;
+				case EXPR_ADD:
+					return OP_IntegerAddInPlace;
+				case EXPR_SUBTRACT:
+					return OP_IntegerSubtractInPlace;
+				case EXPR_MULTIPLY:
+					return OP_IntegerMultiplyInPlace;
+				case EXPR_DIVIDE:
+					return OP_IntegerDivideInPlace;
+				case EXPR_MODULO:
+					return OP_IntegerModuloInPlace;
+			}
+		case TYPE_RATIONAL:
+			switch (ArithmeticExpression(value)->operator) {
+				default:
+					tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase!");
+					return OP_NoOperation;
+				case EXPR_ADD:
+					return OP_RationalAddInPlace;
+				case EXPR_SUBTRACT:
+					return OP_RationalSubtractInPlace;
+				case EXPR_MULTIPLY:
+					return OP_RationalMultiplyInPlace;
+				case EXPR_DIVIDE:
+					return OP_RationalDivideInPlace;
+			}
+	}
+}
+
+/*
+ * [x = x op y] where x exclusively owns its value (see Assignment.in_place):
+ * Only y is evaluated, then x is updated without allocating a new result.
+ */
+static void generate_in_place_assignment(
+	struct tarot_generator *generator,
+	struct tarot_node *node
+) {
+	struct tarot_node *value = Assignment(node)->value;
+	if (kind_of(value) == NODE_FString) {
+		generate_pieces(generator, value, 1, true);
+	} else {
+		generate(generator, ArithmeticExpression(value)->right_operand);
+	}
+	write_instruction(generator, OP_LoadVariablePointer);
+	write_slot(generator, index_of(Assignment(node)->identifier));
+	write_instruction(generator, in_place_opcode(value));
+}
+
 static void generate_assignment(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
 	struct tarot_node *definition = definition_of(Assignment(node)->identifier);
-	bool must_copy = false;
+	if (Assignment(node)->in_place) {
+		generate_in_place_assignment(generator, node);
+		return;
+	}
 	generator->ref = node;
 	generator->write_to = false;
-	generate(generator, Assignment(node)->value);
+	if (is_moved(Assignment(node)->value)) {
+		generate_move(generator, Assignment(node)->value);
+	} else {
+		generate(generator, Assignment(node)->value);
+	}
 	switch (Type(type_of(Assignment(node)->value))->type) {
 		case TYPE_CUSTOM:
 			write_instruction(generator, OP_UnTrack);
@@ -1706,11 +2565,16 @@ static void generate_assignment(
 		default: break;
 	}
 	generator->ref = NULL;
-	if (kind_of(Assignment(node)->value) == NODE_Identifier) {
-		must_copy = true;
+	/* Values that are still owned elsewhere are copied before the target
+	 * pointer is pushed, the copy is what gets stored */
+	if (
+		(kind_of(Assignment(node)->value) == NODE_Identifier and not is_moved(Assignment(node)->value)) or
+		kind_of(Assignment(node)->value) == NODE_Subscript or
+		kind_of(Assignment(node)->value) == NODE_Relation
+	) {
+		generate_copy(generator, Assignment(node)->value);
 	}
 
-
 	generator->write_to = true;
 	generate(generator, Assignment(node)->identifier);/*
 	if (kind_of(Assignment(node)->identifier) == NODE_Subscript) {
@@ -1718,7 +2582,7 @@ static void generate_assignment(
 		switch (Type(type_of(definition))->type) {
 			default:
 				write_instruction(generator, OP_LoadVariablePointer);
-				write_instruction_argument_8bit(generator, index_of(node));
+				write_slot(generator, index_of(node));
 				break;
 			case TYPE_LIST: /* FIXME: Not quite right when assigning list to list (not index element) /
 				generate(generator, Subscript(subscript)->identifier);
@@ -1734,7 +2598,7 @@ static void generate_assignment(
 		}
 	} else {
 		write_instruction(generator, OP_LoadVariablePointer);
-		write_instruction_argument_8bit(generator, index_of(Assignment(node)->identifier));
+		write_slot(generator, index_of(Assignment(node)->identifier));
 	}*/
 	generator->write_to = false;
 
@@ -1750,29 +2614,23 @@ static void generate_assignment(
 			write_instruction(generator, OP_StoreValue);
 			break;
 		case TYPE_INTEGER:
-			if (must_copy) {
-				write_instruction(generator, OP_CopyInteger);
-			}
 			write_instruction(generator, OP_StoreInteger);
 			break;
 		case TYPE_RATIONAL:
-			if (must_copy) {
-				write_instruction(generator, OP_CopyRational);
-			}
 			write_instruction(generator, OP_StoreRational);
 			break;
 		case TYPE_STRING:
-			if (must_copy) {
-				write_instruction(generator, OP_CopyString);
-			}
 			write_instruction(generator, OP_StoreString);
 			break;
 		case TYPE_LIST:
-			if (must_copy) {
-				write_instruction(generator, OP_CopyList);
-			}
 			write_instruction(generator, OP_StoreList);
 			break;
+		case TYPE_DICT:
+			write_instruction(generator, OP_StoreDict);
+			break;
+		case TYPE_CHANNEL:
+			write_instruction(generator, OP_StoreChannel);
+			break;
 	}
 	/*write_argument(generator, index_of(Assignment(node)->identifier));*/
 }
@@ -1832,16 +2690,18 @@ static void generate_try(
 	struct tarot_generator *generator,
 	struct tarot_node *node
 ) {
+	size_t handlers_start;
+	size_t handlers_end;
 	write_instruction(generator, OP_PushTry);
-	write_argument(generator, TryStatement(node)->handlers_start);
+	handlers_start = write_forward_argument(generator);
 	generate(generator, TryStatement(node)->block);
 	write_instruction(generator, OP_PopTry);
 	TryStatement(node)->end = generator->offset.instructions;
 	write_instruction(generator, OP_Goto);
-	write_argument(generator, TryStatement(node)->handlers_end);
-	TryStatement(node)->handlers_start = generator->offset.instructions;
+	handlers_end = write_forward_argument(generator);
+	patch_argument(generator, handlers_start);
 	generate(generator, TryStatement(node)->handlers);
-	TryStatement(node)->handlers_end = generator->offset.instructions;
+	patch_argument(generator, handlers_end);
 }
 
 static void generate_catch(
@@ -1859,10 +2719,14 @@ static void generate_variable(
 ) {
 	bool must_copy = false;
 	generator->ref = node;
-	generate(generator, Variable(node)->value);
+	if (is_moved(Variable(node)->value)) {
+		generate_move(generator, Variable(node)->value);
+	} else {
+		generate(generator, Variable(node)->value);
+	}
 	generator->ref = NULL;
 	if (
-		kind_of(Variable(node)->value) == NODE_Identifier or
+		(kind_of(Variable(node)->value) == NODE_Identifier and not is_moved(Variable(node)->value)) or
 		kind_of(Variable(node)->value) == NODE_Subscript or
 		kind_of(Variable(node)->value) == NODE_Relation
 	) {
@@ -1880,6 +2744,11 @@ static void generate_variable(
 				write_instruction(generator, OP_CopyInteger);
 			}
 			break;
+		case TYPE_RATIONAL:
+			if (must_copy) {
+				write_instruction(generator, OP_CopyRational);
+			}
+			break;
 		case TYPE_STRING:
 			if (must_copy) {
 				write_instruction(generator, OP_CopyString);
@@ -1890,9 +2759,19 @@ static void generate_variable(
 				write_instruction(generator, OP_CopyList);
 			}
 			break;
+		case TYPE_DICT:
+			if (must_copy) {
+				write_instruction(generator, OP_CopyDict);
+			}
+			break;
+		case TYPE_CHANNEL:
+			if (must_copy) {
+				write_instruction(generator, OP_CopyChannel);
+			}
+			break;
 	}
 	write_instruction(generator, OP_LoadVariablePointer);
-	write_instruction_argument_8bit(generator, index_of(node));
+	write_slot(generator, index_of(node));
 
 	switch (Type(type_of(Variable(node)->value))->type) {
 		default:
@@ -1901,12 +2780,21 @@ static void generate_variable(
 		case TYPE_INTEGER:
 			write_instruction(generator, OP_StoreInteger);
 			break;
+		case TYPE_RATIONAL:
+			write_instruction(generator, OP_StoreRational);
+			break;
 		case TYPE_STRING:
 			write_instruction(generator, OP_StoreString);
 			break;
 		case TYPE_LIST:
 			write_instruction(generator, OP_StoreList);
 			break;
+		case TYPE_DICT:
+			write_instruction(generator, OP_StoreDict);
+			break;
+		case TYPE_CHANNEL:
+			write_instruction(generator, OP_StoreChannel);
+			break;
 	}
 }
 
@@ -1916,7 +2804,7 @@ static void generate_constant(
 ) {
 	generate(generator, Constant(node)->value);
 	write_instruction(generator, OP_LoadVariablePointer);
-	write_instruction_argument_8bit(generator, index_of(node));
+	write_slot(generator, index_of(node));
 	write_instruction(generator, OP_StoreValue);
 }
 
@@ -1925,9 +2813,13 @@ static void generate_break(
 	struct tarot_node *node
 ) {
 	struct tarot_node *loop = Break(node)->loop;
-	write_instruction(generator, OP_PopRegion);
+	if (kind_of(loop) == NODE_For) {
+		write_region_instruction(generator, OP_PopRegion, ForLoop(loop)->block_allocates);
+	} else {
+		write_region_instruction(generator, OP_PopRegion, Block(WhileLoop(loop)->block)->allocates);
+	}
 	write_instruction(generator, OP_Goto);
-	write_argument(generator, WhileLoop(loop)->end);
+	write_break_argument(generator);
 }
 
 static void generate_breakpoint(
@@ -1995,6 +2887,9 @@ static void generate(struct tarot_generator *generator, struct tarot_node *node)
 		case NODE_Dict:
 			generate_dict(generator, node);
 			break;
+		case NODE_Channel:
+			generate_channel(generator, node);
+			break;
 		case NODE_FString:
 			generate_fstring(generator, node);
 			break;
@@ -2046,6 +2941,9 @@ static void generate(struct tarot_generator *generator, struct tarot_node *node)
 		case NODE_Raise:
 			generate_raise(generator, node);
 			break;
+		case NODE_Launch:
+			generate_launch(generator, node);
+			break;
 		case NODE_Return:
 			generate_return(generator, node);
 			break;
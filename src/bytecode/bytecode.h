@@ -3,6 +3,55 @@
 
 #include "defines.h"
 
+/******************************************************************************
+ * MARK: Format
+ *****************************************************************************/
+
+/**
+ * Flag of tarot_bytecode_header for bytecode in the wide format.
+ * The compact format uses 16-bit instruction arguments, which limits a
+ * program to 64 KiB of instructions and 64 KiB of data. The wide format
+ * uses 32-bit arguments and allows larger function frames. The format is
+ * chosen at build time by defining TAROT_WIDE_BYTECODE.
+ */
+#define TAROT_BYTECODE_WIDE 0x01
+
+#ifdef TAROT_WIDE_BYTECODE
+typedef uint32_t tarot_address;
+typedef uint16_t tarot_slot;
+typedef uint32_t tarot_function_info;
+#define TAROT_BYTECODE_FORMAT TAROT_BYTECODE_WIDE
+#define TAROT_MAX_ADDRESS 0xFFFFFFFFUL
+#define TAROT_PARAMETER_BITS 8
+#define TAROT_VARIABLE_BITS 16
+#else
+typedef uint16_t tarot_address;
+typedef uint8_t tarot_slot;
+typedef uint16_t tarot_function_info;
+#define TAROT_BYTECODE_FORMAT 0x00
+#define TAROT_MAX_ADDRESS 0xFFFFUL
+#define TAROT_PARAMETER_BITS 4
+#define TAROT_VARIABLE_BITS 7
+#endif
+
+#define TAROT_MAX_PARAMETERS ((1UL << TAROT_PARAMETER_BITS) - 1)
+#define TAROT_MAX_VARIABLES  ((1UL << TAROT_VARIABLE_BITS) - 1)
+
+#ifdef TAROT_SOURCE
+/* Instruction arguments are addresses, slots are variable indices */
+#ifdef TAROT_WIDE_BYTECODE
+#define tarot_read_argument  tarot_read32bit
+#define tarot_write_argument tarot_write32bit
+#define tarot_read_slot      tarot_read16bit
+#define tarot_write_slot     tarot_write16bit
+#else
+#define tarot_read_argument  tarot_read16bit
+#define tarot_write_argument tarot_write16bit
+#define tarot_read_slot      tarot_read8bit
+#define tarot_write_slot     tarot_write8bit
+#endif
+#endif /* TAROT_SOURCE */
+
 /******************************************************************************
  * MARK: Function
  *****************************************************************************/
@@ -11,11 +60,13 @@
 struct tarot_bytecode_header;
 struct tarot_iostream;
 struct tarot_node;
+struct tarot_thread;
+union tarot_value;
 
 struct tarot_function {
-	uint16_t address;
-	uint16_t finally;
-	uint16_t info;
+	tarot_address address;
+	tarot_address finally;
+	tarot_function_info info;
 };
 
 extern size_t tarot_num_parameters(struct tarot_function *function);
@@ -26,6 +77,43 @@ extern bool tarot_returns(struct tarot_function *function);
 
 extern bool tarot_is_method(struct tarot_function *function);
 
+/**
+ * A native function that implements a foreign function. It takes the
+ * arguments from the thread and pushes the return value onto its stack.
+ */
+typedef void (*tarot_foreign_function)(struct tarot_thread *thread);
+
+/**
+ * A native function that takes the arguments of a foreign function as an
+ * array and stores the return value in result, unless the foreign function
+ * returns nothing. The values are laid out as for tarot_invoke_function.
+ * It is called without setting up a frame on the thread, which makes it
+ * cheaper to call than a tarot_foreign_function.
+ */
+typedef void (*tarot_native_function)(
+	const union tarot_value *arguments,
+	size_t num_arguments,
+	union tarot_value *result
+);
+
+/**
+ * Binds a native function to the foreign function of the given name, in
+ * either calling convention. The array based one takes precedence.
+ */
+struct tarot_foreign_binding {
+	const char *name;
+	tarot_foreign_function function;
+	tarot_native_function native;
+};
+
+/**
+ * The native function called for a foreign function, unbound if both are NULL.
+ */
+struct tarot_foreign_call {
+	tarot_foreign_function function;
+	tarot_native_function native;
+};
+
 /******************************************************************************
  * MARK: Bytecode
  *****************************************************************************/
@@ -50,6 +138,17 @@ struct tarot_bytecode {
 	uint16_t num_functions;
 	uint16_t num_foreign_functions;
 	size_t size;
+	size_t num_elided_regions; /* statistics, only known after generation */
+	uint16_t *foreign_index; /* foreign functions by name, see below */
+	size_t foreign_capacity; /* number of slots of the index */
+	struct tarot_foreign_call *bindings; /* NULL until functions are bound */
+	/* Immortal string literals hashed by data address, NULL unless the
+	 * bytecode was generated in this process */
+	struct tarot_string_constant {
+		tarot_address address;
+		struct tarot_string *string;
+	} *constants;
+	size_t constants_capacity;
 };
 
 /**
@@ -60,6 +159,35 @@ extern struct tarot_function* tarot_lookup_function(
 	const char *function_name
 );
 
+/**
+ * Returns the string literal stored at the given address of the data
+ * section as an immortal string, or NULL if the bytecode has none.
+ */
+extern struct tarot_string* tarot_string_constant(
+	struct tarot_bytecode *bytecode,
+	tarot_address address
+);
+
+/**
+ * Returns the foreign function with the given name, or NULL if the bytecode
+ * declares none. The names are looked up in a hash index.
+ */
+extern struct tarot_function* tarot_lookup_foreign_function(
+	struct tarot_bytecode *bytecode,
+	const char *function_name
+);
+
+/**
+ * Binds native functions to the foreign functions of the bytecode, for all
+ * virtual machines that are created from it afterwards. Bindings of names
+ * the bytecode does not declare are ignored.
+ */
+extern void tarot_bind_foreign_functions(
+	struct tarot_bytecode *bytecode,
+	const struct tarot_foreign_binding *bindings,
+	size_t num_bindings
+);
+
 /**
  * Generates bytecode from an abstract syntax tree.
  */
@@ -75,6 +203,18 @@ extern void tarot_free_bytecode(struct tarot_bytecode *bytecode);
  */
 extern struct tarot_bytecode* tarot_import_bytecode(const char *path);
 
+/**
+ * Creates bytecode from a copy of the bytecode image of size bytes.
+ * Returns NULL without raising an error if the image is not valid
+ * bytecode of the format of this build.
+ */
+extern struct tarot_bytecode* tarot_load_bytecode(const void *image, size_t size);
+
+/**
+ * Returns the size of the bytecode image in bytes.
+ */
+extern size_t tarot_sizeof_bytecode(struct tarot_bytecode *bytecode);
+
 /**
  * Exports bytecode to the given binary file.
  */
@@ -97,7 +237,7 @@ extern uint8_t* tarot_bytecode_foreign_functions(struct tarot_bytecode_header *b
 extern uint8_t* tarot_bytecode_data(struct tarot_bytecode_header *bytecode);
 
 #ifdef TAROT_SOURCE
-extern const char* read_string(struct tarot_bytecode *bytecode, uint16_t offset);
+extern const char* read_string(struct tarot_bytecode *bytecode, tarot_address offset);
 #endif /* TAROT_SOURCE */
 
 extern const char* tarot_get_function_name(
@@ -0,0 +1,221 @@
+#define TAROT_SOURCE
+#include "tarot.h"
+
+/*
+ * A cache entry is named after the hash of the root source and of the
+ * compiler build. It holds the keys and paths of all modules of the
+ * program followed by the bytecode image:
+ *
+ *   "TAROTMC\0" | number of modules | [length fnv djb path...]... | image
+ *
+ * Modules are analyzed and compiled as a whole, so an entry is only
+ * valid while every one of its modules is unchanged.
+ */
+
+static const char cache_magic[8] = "TAROTMC";
+
+/* Identifies the compiler build that generated a cache entry */
+static const char build_identity[] = {
+	"Tarot " TAROT_VERSION " " __DATE__ " " __TIME__
+};
+
+/* Length and two independent hashes (FNV-1a and djb2) of a source */
+struct source_key {
+	uint32_t length;
+	uint32_t fnv;
+	uint32_t djb;
+};
+
+static void hash_bytes(struct source_key *key, const char *bytes, size_t length) {
+	size_t i;
+	for (i = 0; i < length; i++) {
+		key->fnv = (key->fnv ^ (unsigned char)bytes[i]) * 16777619UL;
+		key->djb = key->djb * 33 + (unsigned char)bytes[i];
+	}
+	key->length += length;
+}
+
+static void initialize_key(struct source_key *key) {
+	key->length = 0;
+	key->fnv = 2166136261UL;
+	key->djb = 5381;
+}
+
+/* Hashes the file at path, returns false if it cannot be read */
+static bool hash_file(struct source_key *key, const char *path) {
+	char *source;
+	size_t size;
+	initialize_key(key);
+	if (not tarot_file_exists(path)) {
+		return false;
+	}
+	if ((source = tarot_read_file(path, &size)) == NULL) {
+		return false;
+	}
+	hash_bytes(key, source, size);
+	tarot_free(source);
+	return true;
+}
+
+/* Returns the path of the cache entry for the source at path */
+static struct tarot_string* entry_path(const char *directory, const char *path) {
+	struct source_key key;
+	uint8_t format = TAROT_BYTECODE_FORMAT;
+	char fnv[TAROT_NUMBER_TEXT_SIZE];
+	char djb[TAROT_NUMBER_TEXT_SIZE];
+	if (not hash_file(&key, path)) {
+		return NULL;
+	}
+	hash_bytes(&key, build_identity, sizeof(build_identity));
+	hash_bytes(&key, (const char*)&format, sizeof(format));
+	tarot_format_unsigned(fnv, key.fnv, 16, 8);
+	tarot_format_unsigned(djb, key.djb, 16, 8);
+	return tarot_create_string("%s/%s%s.bin", directory, fnv, djb);
+}
+
+/******************************************************************************
+ * MARK: Load
+ *****************************************************************************/
+
+/* Reads a 32-bit value from the entry unless it would read past its end */
+static bool read_value(uint8_t **cursor, uint8_t *end, uint32_t *value) {
+	if (end - *cursor < 4) {
+		return false;
+	}
+	*value = tarot_read32bit(*cursor, cursor);
+	return true;
+}
+
+/* Checks that the module recorded at the cursor is unchanged */
+static bool read_module(uint8_t **cursor, uint8_t *end) {
+	struct source_key expected, actual;
+	uint32_t path_length;
+	const char *path;
+	if (
+		not read_value(cursor, end, &expected.length) or
+		not read_value(cursor, end, &expected.fnv) or
+		not read_value(cursor, end, &expected.djb) or
+		not read_value(cursor, end, &path_length) or
+		(uint32_t)(end - *cursor) <= path_length
+	) {
+		return false;
+	}
+	path = (const char*)*cursor;
+	*cursor += path_length + 1;
+	return (
+		path[path_length] == '\0' and
+		hash_file(&actual, path) and
+		actual.length == expected.length and
+		actual.fnv == expected.fnv and
+		actual.djb == expected.djb
+	);
+}
+
+struct tarot_bytecode* tarot_load_cached_bytecode(
+	const char *directory,
+	const char *path
+) {
+	struct tarot_bytecode *bytecode = NULL;
+	struct tarot_string *entry = entry_path(directory, path);
+	uint8_t *contents, *cursor, *end;
+	uint32_t i, num_modules;
+	size_t size;
+	if (entry == NULL) {
+		return NULL;
+	}
+	if (
+		tarot_file_exists(tarot_string_text(entry)) and
+		(contents = tarot_read_file(tarot_string_text(entry), &size)) != NULL
+	) {
+		cursor = contents;
+		end = contents + size;
+		if (
+			size > sizeof(cache_magic) and
+			memcmp(contents, cache_magic, sizeof(cache_magic)) == 0
+		) {
+			cursor += sizeof(cache_magic);
+			if (read_value(&cursor, end, &num_modules)) {
+				for (i = 0; i < num_modules; i++) {
+					if (not read_module(&cursor, end)) {
+						break;
+					}
+				}
+				if (i == num_modules) {
+					bytecode = tarot_load_bytecode(cursor, end - cursor);
+				}
+			}
+		}
+		tarot_free(contents);
+	}
+	tarot_free_string(entry);
+	return bytecode;
+}
+
+/******************************************************************************
+ * MARK: Store
+ *****************************************************************************/
+
+/* The cache entry being assembled */
+struct entry {
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+};
+
+static void append_bytes(struct entry *entry, const void *bytes, size_t size) {
+	if (entry->length + size > entry->capacity) {
+		entry->capacity = 2 * (entry->length + size);
+		entry->data = tarot_realloc(entry->data, entry->capacity);
+	}
+	memcpy(entry->data + entry->length, bytes, size);
+	entry->length += size;
+}
+
+static void append_value(struct entry *entry, uint32_t value) {
+	uint8_t buffer[4];
+	tarot_write32bit(buffer, value);
+	append_bytes(entry, buffer, sizeof(buffer));
+}
+
+void tarot_cache_bytecode(
+	const char *directory,
+	struct tarot_node *modules,
+	struct tarot_bytecode *bytecode
+) {
+	struct tarot_string *path = entry_path(directory, Module(modules)->path);
+	struct entry entry;
+	struct source_key key;
+	struct tarot_node *module;
+	uint32_t num_modules = 0;
+	if (path == NULL) {
+		return;
+	}
+	for (module = modules; module != NULL; module = Module(module)->next_module) {
+		num_modules++;
+	}
+	memset(&entry, 0, sizeof(entry));
+	append_bytes(&entry, cache_magic, sizeof(cache_magic));
+	append_value(&entry, num_modules);
+	for (module = modules; module != NULL; module = Module(module)->next_module) {
+		if (not hash_file(&key, Module(module)->path)) {
+			break;
+		}
+		append_value(&entry, key.length);
+		append_value(&entry, key.fnv);
+		append_value(&entry, key.djb);
+		append_value(&entry, strlen(Module(module)->path));
+		append_bytes(&entry, Module(module)->path, strlen(Module(module)->path) + 1);
+	}
+	if (module == NULL) {
+		append_bytes(&entry, bytecode->header, tarot_sizeof_bytecode(bytecode));
+		/* A missing cache directory is not an error, the program still runs */
+		if (
+			not tarot_file_writable(tarot_string_text(path)) or
+			tarot_write_to_file(tarot_string_text(path), entry.data, entry.length) != 1
+		) {
+			tarot_warning("Failed to write the cache entry %s", tarot_string_text(path));
+		}
+	}
+	tarot_free(entry.data);
+	tarot_free_string(path);
+}
@@ -0,0 +1,30 @@
+#ifndef TAROT_CACHE_H
+#define TAROT_CACHE_H
+
+#include "defines.h"
+
+/* Forward declaration */
+struct tarot_bytecode;
+struct tarot_node;
+
+/**
+ * Loads the bytecode compiled from the source file at path from the cache
+ * directory. Returns NULL if the cache holds no bytecode for the current
+ * contents of the file and of every module it imports.
+ */
+extern struct tarot_bytecode* tarot_load_cached_bytecode(
+	const char *directory,
+	const char *path
+);
+
+/**
+ * Stores the bytecode compiled from the given modules in the cache
+ * directory, together with the hashes of their sources.
+ */
+extern void tarot_cache_bytecode(
+	const char *directory,
+	struct tarot_node *modules,
+	struct tarot_bytecode *bytecode
+);
+
+#endif /* TAROT_CACHE_H */
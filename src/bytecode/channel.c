@@ -0,0 +1,215 @@
+#define TAROT_SOURCE
+#include "tarot.h"
+
+struct message {
+	union tarot_value value;
+	bool owned;
+};
+
+struct wait_queue {
+	struct tarot_thread *first;
+	struct tarot_thread *last;
+};
+
+struct tarot_channel {
+	struct message *messages; /* ring buffer */
+	size_t size;
+	size_t head;
+	size_t length;
+	size_t capacity; /* zero if unbounded */
+	enum tarot_datatype type;
+	struct wait_queue senders;
+	struct wait_queue receivers;
+	void *lock; /* guards the channel, NULL on a single worker */
+};
+
+struct tarot_channel* tarot_create_channel(
+	int type,
+	size_t capacity,
+	bool is_shared
+) {
+	struct tarot_channel *channel = tarot_malloc(sizeof(*channel));
+	memset(channel, 0, sizeof(*channel));
+	channel->size = capacity > 0 ? capacity : 8;
+	channel->messages = tarot_malloc(sizeof(*channel->messages) * channel->size);
+	channel->capacity = capacity;
+	channel->type = type;
+	if (is_shared) {
+		channel->lock = tarot_threading.create_mutex();
+	}
+	tarot_tag(channel, TYPE_CHANNEL);
+	return channel;
+}
+
+void tarot_lock_channel(struct tarot_channel *channel) {
+	if (channel->lock != NULL) {
+		tarot_threading.lock(channel->lock);
+	}
+}
+
+void tarot_unlock_channel(struct tarot_channel *channel) {
+	if (channel->lock != NULL) {
+		tarot_threading.unlock(channel->lock);
+	}
+}
+
+struct tarot_channel* tarot_share_channel(struct tarot_channel *channel) {
+	tarot_lock_channel(channel);
+	tarot_retain(channel);
+	tarot_unlock_channel(channel);
+	return channel;
+}
+
+static void free_message(enum tarot_datatype type, struct message *message) {
+	if (not message->owned) {
+		return;
+	}
+	switch (type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			tarot_free_integer(message->value.Integer);
+			break;
+		case TYPE_RATIONAL:
+			tarot_free_rational(message->value.Rational);
+			break;
+		case TYPE_STRING:
+			tarot_free_string(message->value.String);
+			break;
+		case TYPE_LIST:
+			tarot_free_list(message->value.List);
+			break;
+		case TYPE_DICT:
+			tarot_free_dictionary(message->value.Dict);
+			break;
+		case TYPE_CHANNEL:
+			tarot_free_channel(message->value.Channel);
+			break;
+		case TYPE_CUSTOM:
+			tarot_free_object(message->value.Object);
+			break;
+	}
+}
+
+void tarot_free_channel(struct tarot_channel *channel) {
+	bool is_last;
+	size_t i;
+	if (channel == NULL) {
+		return;
+	}
+	tarot_lock_channel(channel);
+	is_last = tarot_release(channel);
+	tarot_unlock_channel(channel);
+	if (not is_last) {
+		return;
+	}
+	/* Parked threads hold a reference, so none can be left waiting */
+	assert(channel->senders.first == NULL);
+	assert(channel->receivers.first == NULL);
+	for (i = 0; i < channel->length; i++) {
+		free_message(channel->type, &channel->messages[(channel->head + i) % channel->size]);
+	}
+	if (channel->lock != NULL) {
+		tarot_threading.free_mutex(channel->lock);
+	}
+	tarot_free(channel->messages);
+	tarot_free(channel);
+}
+
+int tarot_channel_datatype(struct tarot_channel *channel) {
+	return channel->type;
+}
+
+bool tarot_channel_is_full(struct tarot_channel *channel) {
+	return channel->capacity > 0 and channel->length >= channel->capacity;
+}
+
+bool tarot_channel_is_empty(struct tarot_channel *channel) {
+	return channel->length == 0;
+}
+
+/* Doubles the ring buffer of an unbounded channel, unwrapping its contents */
+static void grow_channel(struct tarot_channel *channel) {
+	struct message *messages = tarot_malloc(sizeof(*messages) * channel->size * 2);
+	size_t i;
+	for (i = 0; i < channel->length; i++) {
+		messages[i] = channel->messages[(channel->head + i) % channel->size];
+	}
+	tarot_free(channel->messages);
+	channel->messages = messages;
+	channel->size *= 2;
+	channel->head = 0;
+}
+
+void tarot_channel_push(
+	struct tarot_channel *channel,
+	union tarot_value value,
+	bool owned
+) {
+	struct message *message;
+	assert(not tarot_channel_is_full(channel));
+	if (channel->length == channel->size) {
+		grow_channel(channel);
+	}
+	message = &channel->messages[(channel->head + channel->length) % channel->size];
+	message->value = value;
+	message->owned = owned;
+	channel->length++;
+}
+
+union tarot_value tarot_channel_pop(
+	struct tarot_channel *channel,
+	bool *owned
+) {
+	struct message *message;
+	assert(not tarot_channel_is_empty(channel));
+	message = &channel->messages[channel->head];
+	channel->head = (channel->head + 1) % channel->size;
+	channel->length--;
+	*owned = message->owned;
+	return message->value;
+}
+
+static void add_waiter(struct wait_queue *queue, struct tarot_thread *thread) {
+	thread->next_thread = NULL;
+	if (queue->first == NULL) {
+		queue->first = thread;
+	} else {
+		queue->last->next_thread = thread;
+	}
+	queue->last = thread;
+}
+
+static struct tarot_thread* take_waiter(struct wait_queue *queue) {
+	struct tarot_thread *thread = queue->first;
+	if (thread != NULL) {
+		queue->first = thread->next_thread;
+		if (queue->first == NULL) {
+			queue->last = NULL;
+		}
+		thread->next_thread = NULL;
+	}
+	return thread;
+}
+
+void tarot_wait_to_send(
+	struct tarot_channel *channel,
+	struct tarot_thread *thread
+) {
+	add_waiter(&channel->senders, thread);
+}
+
+void tarot_wait_to_receive(
+	struct tarot_channel *channel,
+	struct tarot_thread *thread
+) {
+	add_waiter(&channel->receivers, thread);
+}
+
+struct tarot_thread* tarot_wake_sender(struct tarot_channel *channel) {
+	return take_waiter(&channel->senders);
+}
+
+struct tarot_thread* tarot_wake_receiver(struct tarot_channel *channel) {
+	return take_waiter(&channel->receivers);
+}
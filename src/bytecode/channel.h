@@ -0,0 +1,92 @@
+#ifndef TAROT_CHANNEL_H
+#define TAROT_CHANNEL_H
+
+/**
+ * Channels pass values between the threads of a virtual machine.
+ * A value sent over a channel leaves the region of the sending thread and
+ * is adopted into the region of the receiving thread. Threads that would
+ * block on a channel are parked in one of its wait-queues, until a thread
+ * on the other end wakes them.
+ */
+
+#include "defines.h"
+
+struct tarot_channel;
+struct tarot_thread;
+union tarot_value;
+
+/**
+ * Creates a channel for values of the given datatype. A channel with a
+ * capacity of zero is unbounded. Channels shared by several workers are
+ * guarded by a mutex.
+ */
+extern struct tarot_channel* tarot_create_channel(
+	int type,
+	size_t capacity,
+	bool is_shared
+);
+
+/**
+ * Adds a reference to a channel.
+ */
+extern struct tarot_channel* tarot_share_channel(struct tarot_channel *channel);
+
+/**
+ * Drops a reference to a channel. The last reference frees the channel and
+ * the values still queued.
+ */
+extern void tarot_free_channel(struct tarot_channel *channel);
+
+/* Only available to tarot source files */
+#ifdef TAROT_SOURCE
+
+/**
+ * Guards a channel while it is used. The following functions require the
+ * channel to be locked.
+ */
+extern void tarot_lock_channel(struct tarot_channel *channel);
+extern void tarot_unlock_channel(struct tarot_channel *channel);
+
+extern int tarot_channel_datatype(struct tarot_channel *channel);
+extern bool tarot_channel_is_full(struct tarot_channel *channel);
+extern bool tarot_channel_is_empty(struct tarot_channel *channel);
+
+/**
+ * Queues a value. Owned values are freed along with the channel.
+ */
+extern void tarot_channel_push(
+	struct tarot_channel *channel,
+	union tarot_value value,
+	bool owned
+);
+
+/**
+ * Dequeues the oldest value. The channel must not be empty.
+ */
+extern union tarot_value tarot_channel_pop(
+	struct tarot_channel *channel,
+	bool *owned
+);
+
+/**
+ * Parks a thread until a value can be sent or received.
+ */
+extern void tarot_wait_to_send(
+	struct tarot_channel *channel,
+	struct tarot_thread *thread
+);
+extern void tarot_wait_to_receive(
+	struct tarot_channel *channel,
+	struct tarot_thread *thread
+);
+
+/**
+ * Removes the thread parked longest from a wait-queue and returns it.
+ * Returns NULL if no thread is waiting.
+ */
+extern struct tarot_thread* tarot_wake_sender(struct tarot_channel *channel);
+extern struct tarot_thread* tarot_wake_receiver(struct tarot_channel *channel);
+
+#endif /* TAROT_SOURCE */
+
+#endif /* TAROT_CHANNEL_H */
@@ -17,9 +17,15 @@ const char* opcode_string(enum tarot_opcode opcode) {
 		"CallForeignFunction",
 		"CallFunction",
 		"Return",
+		"Launch",
+		"ParallelFor",
+		"ChunkEnd",
+		"EndChunk",
+		"JoinChunks",
 		"PushRegion",
 		"PopRegion",
 		"LoadValue",
+		"MoveValue",
 		"StoreValue",
 		"CopyValue",
 		"PopValue",
@@ -61,6 +67,11 @@ const char* opcode_string(enum tarot_opcode opcode) {
 		"IntegerGreaterThan",
 		"IntegerGreaterEqual",
 		"IntegerEquality",
+		"IntegerAddInPlace",
+		"IntegerSubtractInPlace",
+		"IntegerMultiplyInPlace",
+		"IntegerDivideInPlace",
+		"IntegerModuloInPlace",
 		"PushFloat",
 		"CastToFloat",
 		"FloatAbs",
@@ -97,6 +108,10 @@ const char* opcode_string(enum tarot_opcode opcode) {
 		"RationalGreaterThan",
 		"RationalGreaterEqual",
 		"RationalEquality",
+		"RationalAddInPlace",
+		"RationalSubtractInPlace",
+		"RationalMultiplyInPlace",
+		"RationalDivideInPlace",
 		"PushString",
 		"CopyString",
 		"StoreString",
@@ -106,6 +121,10 @@ const char* opcode_string(enum tarot_opcode opcode) {
 		"StringContains",
 		"StringConcat",
 		"StringLength",
+		"StringAppendInPlace",
+		"StringBuild",
+		"ScratchStringBuild",
+		"ResetScratch",
 		"PushList",
 		"ListIndex",
 		"FreeList",
@@ -114,6 +133,12 @@ const char* opcode_string(enum tarot_opcode opcode) {
 		"PushDict",
 		"DictIndex",
 		"FreeDict",
+		"PushChannel",
+		"CopyChannel",
+		"StoreChannel",
+		"FreeChannel",
+		"ChannelSend",
+		"ChannelReceive",
 		"PrintBoolean",
 		"PrintInteger",
 		"PrintFloat",
@@ -123,6 +148,8 @@ const char* opcode_string(enum tarot_opcode opcode) {
 		"PrintDict",
 		"StoreList",
 		"CopyList",
+		"StoreDict",
+		"CopyDict",
 		"NewLine",
 		"Input"
 	};
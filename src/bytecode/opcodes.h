@@ -48,11 +48,55 @@ enum tarot_opcode {
 	OP_CallForeignFunction,
 	OP_CallFunction,
 	OP_Return,
+
+	/**
+	 * OP_Launch [function_index] [owned:8bit]*
+	 * Moves the arguments of a function off the stack and calls the function
+	 * on a new green thread. Each argument is followed by a flag that tells
+	 * whether the new thread owns and eventually frees the value.
+	 */
+	OP_Launch,
+
+	/**
+	 * OP_ParallelFor [iterator:slot] [reduction:slot] [type:8bit]
+	 *               [operator:8bit] [ordered:8bit] [join_address]
+	 * Pops the stepsize, the end and the start of a range off the stack and
+	 * splits the range into chunks. Each chunk runs the instructions that
+	 * follow on a thread of its own, with a copy of the variables of the
+	 * current function. The thread is parked until all chunks ended and
+	 * continues at the join address. A reduction of type TYPE_VOID means
+	 * the loop does not reduce a variable.
+	 */
+	OP_ParallelFor,
+
+	/**
+	 * Pushes the start of the next chunk, where the chunk of the thread ends.
+	 */
+	OP_ChunkEnd,
+
+	/**
+	 * Hands over the partial result of the reduction and halts the thread of
+	 * the chunk. The last chunk wakes the thread that runs the loop.
+	 */
+	OP_EndChunk,
+
+	/**
+	 * Combines the partial results of the chunks into the reduced variable
+	 * and prints the buffered output of an ordered loop, in chunk order.
+	 */
+	OP_JoinChunks,
 	/* MARK: Memory */
 	OP_PushRegion,
 	OP_PopRegion,
 	OP_LoadValue,
 
+	/**
+	 * OP_MoveValue [variable]
+	 * Pushes the value of a variable that is never read again and clears the
+	 * variable. The value is handed to the current region until stored.
+	 */
+	OP_MoveValue,
+
 	/**
 	 * Pops two values off the stack. Stores the value inside
 	 * the variable.
@@ -102,6 +146,18 @@ enum tarot_opcode {
 	OP_IntegerGreaterThan,
 	OP_IntegerGreaterEqual,
 	OP_IntegerEquality,
+
+	/**
+	 * Pops a variable pointer and an operand off the stack. Updates the
+	 * number owned by the variable in place instead of allocating a result.
+	 * Only emitted for variables that exclusively own their value.
+	 * Stack: [TOP > variable > operand > ...]
+	 */
+	OP_IntegerAddInPlace,
+	OP_IntegerSubtractInPlace,
+	OP_IntegerMultiplyInPlace,
+	OP_IntegerDivideInPlace,
+	OP_IntegerModuloInPlace,
 	/* MARK: Float */
 	OP_PushFloat,
 	OP_CastToFloat,
@@ -140,6 +196,10 @@ enum tarot_opcode {
 	OP_RationalGreaterThan,
 	OP_RationalGreaterEqual,
 	OP_RationalEquality,
+	OP_RationalAddInPlace,
+	OP_RationalSubtractInPlace,
+	OP_RationalMultiplyInPlace,
+	OP_RationalDivideInPlace,
 	/* MARK: String */
 	OP_PushString,
 	OP_CopyString,
@@ -150,6 +210,31 @@ enum tarot_opcode {
 	OP_StringContains,
 	OP_StringConcat,
 	OP_StringLength,
+
+	/**
+	 * Pops a variable pointer and a string off the stack. Appends the string
+	 * to the one owned by the variable, reusing its spare capacity.
+	 * Stack: [TOP > variable > string > ...]
+	 */
+	OP_StringAppendInPlace,
+
+	/**
+	 * OP_StringBuild [n] [type]...
+	 * Builds a string out of n parts with a single allocation. The datatype
+	 * of each part follows as an 8-bit argument. Parts of TYPE_VOID are
+	 * literals stored in the data segment at the 16-bit offset following
+	 * their datatype, all other parts are popped off the stack.
+	 * Stack: [TOP > part n > ... > part 1 > ...]
+	 */
+	OP_StringBuild,
+
+	/**
+	 * Like OP_StringBuild, but places the string in the scratch memory of
+	 * the frame instead of the region. Only emitted for strings that die
+	 * within their statement, OP_ResetScratch then releases all of them.
+	 */
+	OP_ScratchStringBuild,
+	OP_ResetScratch,
 	/* MARK: List */
 	OP_PushList,
 	OP_ListIndex,
@@ -159,6 +244,32 @@ enum tarot_opcode {
 	OP_PushDict,
 	OP_DictIndex,
 	OP_FreeDict,
+	/* MARK: Channel */
+
+	/**
+	 * OP_PushChannel [type:8bit] [bounded:8bit]
+	 * Creates a channel for values of the given datatype. A bounded channel
+	 * pops its capacity off the stack.
+	 */
+	OP_PushChannel,
+	OP_CopyChannel,
+	OP_StoreChannel,
+	OP_FreeChannel,
+
+	/**
+	 * OP_ChannelSend [owned:8bit]
+	 * Pops a value and a channel off the stack and queues the value. The
+	 * flag tells whether the receiving thread owns and frees the value.
+	 * Parks the thread while a bounded channel is full.
+	 * Stack: [TOP > value > channel > ...]
+	 */
+	OP_ChannelSend,
+
+	/**
+	 * Pops a channel off the stack and pushes the oldest value queued.
+	 * Parks the thread while the channel is empty.
+	 */
+	OP_ChannelReceive,
 	/* MARK: I/O */
 	OP_PrintBoolean,
 	OP_PrintInteger,
@@ -169,6 +280,8 @@ enum tarot_opcode {
 	OP_PrintDict,
 	OP_StoreList,
 	OP_CopyList,
+	OP_StoreDict,
+	OP_CopyDict,
 	OP_NewLine,
 	OP_Input
 };
@@ -15,7 +15,7 @@ void tarot_push_region(struct tarot_thread *thread) {
 	void *container;
 	current_frame(thread)->scope.index++;
 	assert(current_frame(thread)->scope.index < sizeof(current_frame(thread)->scope.indices));
-	if (current_frame(thread)->scope.index == 1) {
+	if (current_frame(thread)->scope.index == 1 and *current_region(thread) == NULL) {
 		*current_region(thread) = tarot_create_list(sizeof(void*), 10, NULL);
 	}
 	current_frame(thread)->scope.indices[current_frame(thread)->scope.index-1] = tarot_list_length(*current_region(thread));
@@ -48,15 +48,15 @@ void tarot_pop_region(struct tarot_thread *thread) {
 			case TYPE_DICT:
 				tarot_free_dictionary(ptr);
 				break;
+			case TYPE_CHANNEL:
+				tarot_free_channel(ptr);
+				break;
 			case TYPE_CUSTOM:
 				tarot_free_object(ptr);
 				break;
 		}
 	}
-	if (current_frame(thread)->scope.index == 1) {
-		tarot_clear_list(region);
-		tarot_free_list(region);
-	}
+	/* The emptied region is kept by the frame, see clear_callstack */
 	current_frame(thread)->scope.index--;
 }
 
@@ -76,6 +76,51 @@ void tarot_clear_regions(struct tarot_thread *thread) {
 	}
 }
 
+void* tarot_scratch_alloc(struct tarot_thread *thread, size_t size) {
+	struct tarot_scratch *scratch = &thread->scratch;
+	struct block_header *header;
+	size_t blocksize = sizeof(*header) * (1 + (size + sizeof(*header) - 1) / sizeof(*header));
+	if (scratch->memory == NULL) {
+		scratch->memory = tarot_malloc(TAROT_SCRATCH_SIZE);
+	}
+	if (scratch->top + blocksize > TAROT_SCRATCH_SIZE) {
+		void *memory = tarot_malloc(size);
+		if (scratch->overflow == NULL) {
+			scratch->overflow = tarot_create_list(sizeof(memory), 4, NULL);
+		}
+		tarot_list_append(&scratch->overflow, &memory);
+		return memory;
+	}
+	header = (struct block_header*)&scratch->memory[scratch->top];
+	header->size = size;
+	header->type = 0;
+	header->references = 1;
+	header->cache = NULL;
+	scratch->top += blocksize;
+	return end_of_struct(header);
+}
+
+TAROT_INLINE
+void tarot_reset_scratch(struct tarot_thread *thread) {
+	thread->scratch.top = current_frame(thread)->scratch;
+	tarot_free_scratch_overflow(thread, current_frame(thread)->overflow);
+}
+
+size_t tarot_scratch_overflow(struct tarot_thread *thread) {
+	if (thread->scratch.overflow == NULL) {
+		return 0;
+	}
+	return tarot_list_length(thread->scratch.overflow);
+}
+
+void tarot_free_scratch_overflow(struct tarot_thread *thread, size_t length) {
+	while (tarot_scratch_overflow(thread) > length) {
+		void *memory;
+		tarot_list_pop(&thread->scratch.overflow, &memory);
+		tarot_free(memory);
+	}
+}
+
 bool tarot_is_tracked(struct tarot_thread *thread, void *ptr) {
 	return tarot_list_contains(*current_region(thread), &ptr);
 }
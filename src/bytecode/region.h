@@ -26,4 +26,34 @@ extern void tarot_clear_regions(struct tarot_thread *thread);
 
 extern bool tarot_is_tracked(struct tarot_thread *thread, void *ptr);
 
+/**
+ * Scratch memory for temporaries that die within their statement.
+ * Every thread owns a buffer of TAROT_SCRATCH_SIZE bytes that is handed out
+ * bump-pointer style. Each callframe owns the part of the buffer above the
+ * mark set on entry, which is released on return or by a scratch reset.
+ * The blocks carry a header like those of tarot_malloc, but must never be
+ * freed or resized. Once the buffer is exhausted, blocks are allocated on
+ * the heap instead and freed along with the scratch memory.
+ */
+extern void* tarot_scratch_alloc(struct tarot_thread *thread, size_t size);
+
+/**
+ * Releases all scratch memory allocated by the current callframe.
+ */
+extern void tarot_reset_scratch(struct tarot_thread *thread);
+
+/**
+ * Returns the number of scratch blocks that were allocated on the heap.
+ */
+extern size_t tarot_scratch_overflow(struct tarot_thread *thread);
+
+/**
+ * Frees the scratch blocks on the heap until only length of them remain.
+ */
+extern void tarot_free_scratch_overflow(struct tarot_thread *thread, size_t length);
+
+#ifndef TAROT_SCRATCH_SIZE
+#define TAROT_SCRATCH_SIZE 4096
+#endif
+
 #endif /* TAROT_REGION_H */
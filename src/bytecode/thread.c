@@ -10,6 +10,15 @@ static void stack_push(struct tarot_stack *stack, union tarot_value value) {
 	stack->base[stack->ptr++] = value;
 }
 
+/* Makes room for size more values above the top of the stack */
+TAROT_INLINE
+static void stack_reserve(struct tarot_stack *stack, size_t size) {
+	if (stack->ptr + size > stack->size) {
+		stack->size = 16 + (stack->ptr + size) * 2;
+		stack->base = tarot_realloc(stack->base, sizeof(*stack->base) * stack->size);
+	}
+}
+
 TAROT_INLINE
 static union tarot_value stack_pop(struct tarot_stack *stack) {
 	union tarot_value value = stack->base[--stack->ptr];
@@ -49,8 +58,13 @@ static void pop_frame(struct tarot_callstack *callstack) {
 	callstack->index--;
 }
 
+/* Frames keep their region once it was created, for the next call */
 TAROT_INLINE
 static void clear_callstack(struct tarot_callstack *stack) {
+	size_t i;
+	for (i = 0; i < stack->size; i++) {
+		tarot_free_list(stack->frames[i].scope.region);
+	}
 	tarot_free(stack->frames);
 	memset(stack, 0, sizeof(*stack));
 }
@@ -72,11 +86,12 @@ union tarot_value* tarot_topptr(struct tarot_thread *thread) {
 }
 
 union tarot_value tarot_argument(struct tarot_thread *thread, uint8_t index) {
-	uint8_t num_variables = tarot_num_variables(current_frame(thread)->function);
-	return thread->stack.base[thread->stack.baseptr - num_variables - index - 1];
+	struct tarot_function *function = current_frame(thread)->function;
+	size_t num_arguments = tarot_num_parameters(function) + tarot_num_variables(function);
+	return thread->stack.base[thread->stack.baseptr - num_arguments + index];
 }
 
-union tarot_value* tarot_variable(struct tarot_thread *thread, uint8_t index) {
+union tarot_value* tarot_variable(struct tarot_thread *thread, tarot_slot index) {
 	return &thread->stack.base[thread->stack.baseptr - index - 1];
 }
 
@@ -87,13 +102,20 @@ union tarot_value* tarot_self(struct tarot_thread *thread) {
 /* frame: [arguments] [baseptr|ptr] [space for variables] */
 /* in call: [arguments] [space for variables] [baseptr|ptr] */
 /* return: [baseptr|ptr] [arguments] [space for variables] */
-uint16_t tarot_call(struct tarot_thread *thread, struct tarot_function *function) {
+tarot_address tarot_call(struct tarot_thread *thread, struct tarot_function *function) {
 	push_frame(&thread->callstack);
 	current_frame(thread)->return_address = thread->instruction_pointer;
 	current_frame(thread)->function = function;
 	current_frame(thread)->baseptr = thread->stack.baseptr;
 	current_frame(thread)->ptr = thread->stack.ptr;
-	thread->stack.ptr += tarot_num_variables(function);
+	current_frame(thread)->scratch = thread->scratch.top;
+	current_frame(thread)->overflow = tarot_scratch_overflow(thread);
+	if (tarot_num_variables(function) > 0) {
+		/* Variables start out empty, as a store frees the previous value */
+		stack_reserve(&thread->stack, tarot_num_variables(function));
+		memset(&thread->stack.base[thread->stack.ptr], 0, sizeof(*thread->stack.base) * tarot_num_variables(function));
+		thread->stack.ptr += tarot_num_variables(function);
+	}
 	thread->stack.baseptr = thread->stack.ptr;
 	return function->address;
 }
@@ -108,6 +130,8 @@ void* tarot_return(struct tarot_thread *thread) {
 	}
 	thread->stack.baseptr = current_frame(thread)->baseptr;
 	thread->stack.ptr = current_frame(thread)->ptr - tarot_num_parameters(current_frame(thread)->function); /* discard call args from stack */
+	thread->scratch.top = current_frame(thread)->scratch;
+	tarot_free_scratch_overflow(thread, current_frame(thread)->overflow);
 	pop_frame(&thread->callstack);
 	if (returns_value) {
 		tarot_push(thread, return_value);
@@ -121,9 +145,37 @@ struct tarot_thread* create_thread(uint8_t *instruction_pointer) {
 	return thread;
 }
 
+void reset_thread(struct tarot_thread *thread, uint8_t *instruction_pointer) {
+	while (thread->callstack.index > 0) {
+		tarot_clear_regions(thread);
+		pop_frame(&thread->callstack);
+	}
+	if (thread->stack.ptr > 0) {
+		memset(thread->stack.base, 0, sizeof(*thread->stack.base) * thread->stack.ptr);
+	}
+	thread->stack.ptr = 0;
+	thread->stack.baseptr = 0;
+	thread->scratch.top = 0;
+	tarot_free_scratch_overflow(thread, 0);
+	tarot_free_list(thread->stacktrace);
+	thread->stacktrace = NULL;
+	thread->instruction_pointer = instruction_pointer;
+	thread->next_thread = NULL;
+	thread->previous_thread = NULL;
+	thread->chunk = NULL;
+	thread->loop = NULL;
+	thread->output = NULL;
+	thread->result = NULL;
+	thread->except = false;
+	thread->yielded = false;
+}
+
 void free_thread(struct tarot_thread *thread) {
+	reset_thread(thread, NULL);
 	clear_stack(&thread->stack);
 	clear_callstack(&thread->callstack);
+	tarot_free(thread->scratch.memory);
+	tarot_free_list(thread->scratch.overflow);
 	tarot_free(thread);
 }
 
@@ -134,7 +186,7 @@ void print_thread(struct tarot_thread *thread) {
 	for (i = 0; i < thread->callstack.index; i++) {
 		size_t k;
 		struct tarot_function *function = thread->callstack.frames[i].function;
-		tarot_printf("Function [%zu] (address:%d)\n", i, function->address);
+		tarot_printf("Function [%zu] (address:%zu)\n", i, (size_t)function->address);
 		tarot_println("  .arguments:");
 		for (k = 0; k < tarot_num_parameters(function); k++) {
 			tarot_printf("\t[%zu] %p\n", k, tarot_argument(thread, k).Pointer);
@@ -159,7 +211,7 @@ void print_thread(struct tarot_thread *thread) {
 	}
 }
 
-void push_try(struct tarot_thread *thread, uint16_t handlers_start) {
+void push_try(struct tarot_thread *thread, tarot_address handlers_start) {
 	assert(current_frame(thread)->except.index < lengthof(current_frame(thread)->except.frames));
 	current_frame(thread)->except.frames[current_frame(thread)->except.index++] = handlers_start;
 }
@@ -178,7 +230,7 @@ bool handler_available(struct tarot_thread *thread) {
 	return false;
 }
 
-uint16_t current_try(struct tarot_thread *thread) {
+tarot_address current_try(struct tarot_thread *thread) {
 	assert(current_frame(thread)->except.index > 0);
 	return current_frame(thread)->except.frames[current_frame(thread)->except.index-1];
 }
@@ -186,7 +238,7 @@ uint16_t current_try(struct tarot_thread *thread) {
 bool handle_exception(struct tarot_thread *thread) {
 	unsigned int i;
 	for (i = current_frame(thread)->except.index; i > 0; i--) {
-		uint16_t frame = current_frame(thread)->except.frames[i-1];
+		tarot_address frame = current_frame(thread)->except.frames[i-1];
 
 	}
 }
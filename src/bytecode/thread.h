@@ -5,6 +5,8 @@
 
 /* Forward declaration */
 struct tarot_thread;
+struct tarot_chunk;
+struct tarot_parallel_loop;
 union tarot_value;
 #include "datatypes/value.h"
 
@@ -31,14 +33,14 @@ extern union tarot_value tarot_argument(struct tarot_thread *thread, uint8_t ind
 /**
  * Provides access to the variable at the specfied index.
  */
-extern union tarot_value* tarot_variable(struct tarot_thread *thread, uint8_t index);
+extern union tarot_value* tarot_variable(struct tarot_thread *thread, tarot_slot index);
 
 extern union tarot_value* tarot_self(struct tarot_thread *thread);
 
 /**
  *
  */
-extern uint16_t tarot_call(struct tarot_thread *thread, struct tarot_function *function);
+extern tarot_address tarot_call(struct tarot_thread *thread, struct tarot_function *function);
 
 /**
  *
@@ -62,8 +64,14 @@ struct tarot_scope {
 	uint8_t index;
 };
 
+struct tarot_scratch {
+	uint8_t *memory;
+	size_t top;
+	struct tarot_list *overflow; /* heap blocks that did not fit into memory */
+};
+
 struct tarot_exception_stack {
-	uint16_t frames[16];
+	tarot_address frames[16];
 	uint8_t index;
 };
 
@@ -75,6 +83,8 @@ struct stackframe {
 	struct tarot_exception_stack except;
 	size_t baseptr;
 	size_t ptr;
+	size_t scratch; /* start of the frame's scratch memory */
+	size_t overflow; /* and of its overflow blocks */
 };
 
 struct tarot_callstack {
@@ -83,6 +93,12 @@ struct tarot_callstack {
 	size_t size;
 };
 
+/* Receives the return value of a function called by the host */
+struct tarot_result {
+	union tarot_value value;
+	bool has_returned; /* false if the function raised an exception */
+};
+
 struct tarot_thread {
 	uint8_t *instruction_pointer;
 	struct tarot_thread *next_thread;
@@ -90,7 +106,13 @@ struct tarot_thread {
 	struct tarot_stack stack;
 	struct tarot_callstack callstack;
 	struct tarot_list *stacktrace;
+	struct tarot_scratch scratch;
+	struct tarot_chunk *chunk; /* part of a parallel for loop run by the thread */
+	struct tarot_parallel_loop *loop; /* parallel for loop joined by the thread */
+	struct tarot_string **output; /* buffers the printed output, NULL if unbuffered */
+	struct tarot_result *result; /* of a function called by the host, NULL otherwise */
 	bool except;
+	bool yielded; /* the thread yielded before blocking */
 };
 
 /**
@@ -98,6 +120,12 @@ struct tarot_thread {
  */
 extern struct tarot_thread* create_thread(uint8_t *instruction_pointer);
 
+/**
+ * Resets a thread that halted, so that it can run again from the given
+ * instruction. Keeps the memory of its stacks.
+ */
+extern void reset_thread(struct tarot_thread *thread, uint8_t *instruction_pointer);
+
 /**
  * Frees a stack and it's associated memory.
  */
@@ -107,9 +135,9 @@ extern void print_thread(struct tarot_thread *thread);
 
 extern struct stackframe* current_frame(struct tarot_thread *thread);
 
-extern void push_try(struct tarot_thread *thread, uint16_t handlers_start);
+extern void push_try(struct tarot_thread *thread, tarot_address handlers_start);
 extern void pop_try(struct tarot_thread *thread);
-extern uint16_t current_try(struct tarot_thread *thread);
+extern tarot_address current_try(struct tarot_thread *thread);
 extern bool handle_exception(struct tarot_thread *thread);
 extern bool handler_available(struct tarot_thread *thread);
 
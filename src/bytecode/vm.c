@@ -2,128 +2,1178 @@
 #include "tarot.h"
 #include "bytecode/opcodes.h"
 
+/**
+ * A worker runs threads on one OS thread. It takes the threads from its own
+ * ready-queue and steals from the queues of other workers once it is empty.
+ */
+struct tarot_worker {
+	struct tarot_virtual_machine *vm;
+	struct tarot_thread *ready_threads;
+	size_t num_ready_threads;
+	size_t index;
+	void *lock; /* guards the ready-queue, NULL on a single worker */
+	void *os_thread;
+	struct tarot_context *context; /* the worker runs in */
+};
+
 struct tarot_virtual_machine {
 	struct tarot_bytecode *bytecode;
-	struct tarot_thread *ready_threads;
-	tarot_foreign_function *functions;
+	struct tarot_worker *workers;
+	struct tarot_foreign_call *functions; /* owned unless the machine is pooled */
 	uint16_t num_functions;
-	uint16_t num_ready_threads;
+	size_t num_workers;
+	size_t num_threads; /* threads that have not halted yet */
+	size_t num_parked_threads; /* threads waiting on a channel */
+	bool is_deadlocked;
+	void *lock; /* guards the thread counters and the output streams */
+	struct tarot_context *context; /* the machine was started in */
+	struct tarot_thread *spare_thread; /* halted thread kept for reuse */
+	struct tarot_virtual_machine_pool *pool; /* the machine belongs to */
+	struct tarot_virtual_machine *next_machine; /* idle in the pool */
+};
+
+/**
+ * The machines of a pool share the bytecode and the foreign functions bound
+ * to it. Released machines keep their memory until they are acquired again.
+ */
+struct tarot_virtual_machine_pool {
+	struct tarot_bytecode *bytecode;
+	struct tarot_foreign_call *functions;
+	struct tarot_virtual_machine *idle_machines;
+	void *lock; /* guards the idle machines, NULL without threading */
+};
+
+/**
+ * A chunk of consecutive iterations of a parallel for loop. Its thread
+ * leaves the partial result of the reduction and the buffered output of an
+ * ordered loop behind, for the thread that joins the loop.
+ */
+struct tarot_chunk {
+	struct tarot_parallel_loop *loop;
+	tarot_integer *end; /* first iteration of the next chunk */
+	union tarot_value result;
+	struct tarot_string *output; /* NULL unless the loop is ordered */
+};
+
+struct tarot_parallel_loop {
+	struct tarot_thread *parent;
+	struct tarot_chunk *chunks;
+	size_t num_chunks;
+	size_t num_running; /* chunks that did not end yet, and the parent */
+	tarot_slot reduction;
+	enum tarot_datatype type; /* of the reduction, TYPE_VOID if none */
+	enum ArithmeticExpressionOperator operator;
+	bool is_ordered;
+};
+
+/* The state of a thread once the worker got it back from run_thread */
+enum thread_state {
+	THREAD_READY,
+	THREAD_PARKED,
+	THREAD_HALTED
 };
 
+/* Return address of the entry function of a launched thread */
+static uint8_t exit_instruction = OP_Halt;
+
+TAROT_INLINE
+static void lock(void *mutex) {
+	if (mutex != NULL) {
+		tarot_threading.lock(mutex);
+	}
+}
+
+TAROT_INLINE
+static void unlock(void *mutex) {
+	if (mutex != NULL) {
+		tarot_threading.unlock(mutex);
+	}
+}
+
 /**
- * Enqueues a thread into a thread queue.
+ * Enqueues a thread at the end of the ready-queue of a worker.
  */
 static void add_ready_thread(
-	struct tarot_virtual_machine *vm,
+	struct tarot_worker *worker,
 	struct tarot_thread *thread
 ) {
-	assert(vm != NULL);
+	assert(worker != NULL);
 	assert(thread != NULL);
-	if(vm->num_ready_threads == 0) {
-		vm->ready_threads = thread;
+	lock(worker->lock);
+	if(worker->num_ready_threads == 0) {
+		worker->ready_threads = thread;
+		thread->next_thread = thread;
+		thread->previous_thread = thread;
 	} else {
-		vm->ready_threads->previous_thread->next_thread = thread;
-		thread->next_thread = vm->ready_threads;
-		thread->previous_thread = vm->ready_threads->previous_thread;
-		vm->ready_threads->previous_thread = thread;
+		worker->ready_threads->previous_thread->next_thread = thread;
+		thread->next_thread = worker->ready_threads;
+		thread->previous_thread = worker->ready_threads->previous_thread;
+		worker->ready_threads->previous_thread = thread;
 	}
+	worker->num_ready_threads++;
+	unlock(worker->lock);
 }
 
 /**
- * Removes a thread from a thread queue.
+ * Removes a thread from the ready-queue of a worker. The worker itself takes
+ * the first thread, thieves take the last one.
+ * Returns NULL if no thread is ready.
  */
-static struct tarot_thread* get_ready_thread(struct tarot_virtual_machine *vm) {
-	struct tarot_thread *thread = vm->ready_threads;
-	if(vm->num_ready_threads > 1) {
-		thread->previous_thread->next_thread = thread->next_thread;
-		thread->next_thread->previous_thread = thread->previous_thread;
-	} else {
-		vm->ready_threads = NULL;
+static struct tarot_thread* get_ready_thread(
+	struct tarot_worker *worker,
+	bool last
+) {
+	struct tarot_thread *thread = NULL;
+	lock(worker->lock);
+	if (worker->num_ready_threads > 0) {
+		thread = worker->ready_threads;
+		if (last) {
+			thread = thread->previous_thread;
+		}
+		if(worker->num_ready_threads > 1) {
+			thread->previous_thread->next_thread = thread->next_thread;
+			thread->next_thread->previous_thread = thread->previous_thread;
+			if (thread == worker->ready_threads) {
+				worker->ready_threads = thread->next_thread;
+			}
+		} else {
+			worker->ready_threads = NULL;
+		}
+		worker->num_ready_threads--;
+		thread->next_thread = NULL;
+		thread->previous_thread = NULL;
+	}
+	unlock(worker->lock);
+	return thread;
+}
+
+TAROT_INLINE
+static bool has_ready_threads(struct tarot_worker *worker) {
+	bool result;
+	lock(worker->lock);
+	result = worker->num_ready_threads > 0;
+	unlock(worker->lock);
+	return result;
+}
+
+/**
+ * Takes the next thread of a worker, or steals one from another worker.
+ * Returns NULL if no worker has a thread ready.
+ */
+static struct tarot_thread* take_thread(struct tarot_worker *worker) {
+	struct tarot_virtual_machine *vm = worker->vm;
+	struct tarot_thread *thread = get_ready_thread(worker, false);
+	size_t i;
+	for (i = 1; thread == NULL and i < vm->num_workers; i++) {
+		struct tarot_worker *victim = &vm->workers[(worker->index + i) % vm->num_workers];
+		thread = get_ready_thread(victim, true);
 	}
 	return thread;
 }
 
 /**
- * Spawns a new thread and enqueues it to the ready-queue.
+ * Spawns a new thread and enqueues it to the ready-queue of a worker.
+ * The thread must be set up before, as other workers may steal it at once.
+ */
+static void spawn_thread(
+	struct tarot_worker *worker,
+	struct tarot_thread *thread
+) {
+	struct tarot_virtual_machine *vm = worker->vm;
+	lock(vm->lock);
+	vm->num_threads++;
+	unlock(vm->lock);
+	add_ready_thread(worker, thread);
+}
+
+/**
+ * Returns a thread that starts at the given instruction, reusing the spare
+ * thread of the virtual machine if there is one.
  */
-static struct tarot_thread* spawn_thread(
+static struct tarot_thread* new_thread(
 	struct tarot_virtual_machine *vm,
-	uint8_t *ip
+	uint8_t *instruction_pointer
 ) {
-	struct tarot_thread *thread = create_thread(ip);
-	add_ready_thread(vm, thread);
-	vm->num_ready_threads++;
+	struct tarot_thread *thread;
+	lock(vm->lock);
+	thread = vm->spare_thread;
+	vm->spare_thread = NULL;
+	unlock(vm->lock);
+	if (thread == NULL) {
+		return create_thread(instruction_pointer);
+	}
+	reset_thread(thread, instruction_pointer);
 	return thread;
 }
 
-void tarot_register_foreign_function(
+/**
+ * Frees a thread that halted, or keeps it as the spare thread.
+ * Returns the number of remaining threads.
+ */
+static size_t exit_thread(
 	struct tarot_virtual_machine *vm,
+	struct tarot_thread *thread
+) {
+	size_t num_threads;
+	lock(vm->lock);
+	num_threads = --vm->num_threads;
+	if (vm->spare_thread == NULL) {
+		vm->spare_thread = thread;
+		thread = NULL;
+	}
+	unlock(vm->lock);
+	if (thread != NULL) {
+		free_thread(thread);
+	}
+	return num_threads;
+}
+
+/**
+ * Spawns a thread that runs a function. The arguments are moved from the
+ * stack of the launching thread, owned arguments are freed on return.
+ */
+static void launch_thread(
+	struct tarot_worker *worker,
+	struct tarot_thread *parent,
+	struct tarot_function *function,
+	uint8_t *owned
+) {
+	size_t i, num_arguments = tarot_num_parameters(function);
+	union tarot_value *arguments = &parent->stack.base[parent->stack.ptr - num_arguments];
+	struct tarot_thread *thread = new_thread(worker->vm, &exit_instruction);
+	for (i = 0; i < num_arguments; i++) {
+		tarot_push(thread, arguments[i]);
+	}
+	thread->instruction_pointer = &worker->vm->bytecode->instructions[tarot_call(thread, function)];
+	tarot_push_region(thread);
+	for (i = 0; i < num_arguments; i++) {
+		if (owned[i]) {
+			tarot_add_to_region(thread, arguments[i].Pointer);
+		}
+	}
+	for (i = 0; i < num_arguments; i++) {
+		tarot_pop(parent);
+	}
+	spawn_thread(worker, thread);
+}
+
+/**
+ * Enqueues a thread that was parked on a channel to the ready-queue of a
+ * worker. Does nothing if no thread was woken.
+ */
+static void wake_thread(
+	struct tarot_worker *worker,
+	struct tarot_thread *thread
+) {
+	struct tarot_virtual_machine *vm = worker->vm;
+	if (thread != NULL) {
+		lock(vm->lock);
+		vm->num_parked_threads--;
+		unlock(vm->lock);
+		add_ready_thread(worker, thread);
+	}
+}
+
+/**
+ * Counts a thread that was parked on a locked channel. Once it is unlocked,
+ * another worker may wake and run the thread at any time.
+ */
+static void count_parked_thread(struct tarot_virtual_machine *vm) {
+	lock(vm->lock);
+	vm->num_parked_threads++;
+	unlock(vm->lock);
+}
+
+/**
+ * Queues a value on a channel and wakes a receiver. Parks the thread and
+ * returns false if the channel is full.
+ */
+static bool send_value(
+	struct tarot_worker *worker,
+	struct tarot_thread *thread,
+	struct tarot_channel *channel,
+	union tarot_value value,
+	bool owned
+) {
+	struct tarot_thread *receiver;
+	tarot_lock_channel(channel);
+	if (tarot_channel_is_full(channel)) {
+		tarot_wait_to_send(channel, thread);
+		count_parked_thread(worker->vm);
+		tarot_unlock_channel(channel);
+		return false;
+	}
+	tarot_channel_push(channel, value, owned);
+	receiver = tarot_wake_receiver(channel);
+	tarot_unlock_channel(channel);
+	wake_thread(worker, receiver);
+	return true;
+}
+
+/**
+ * Dequeues a value from a channel and wakes a sender. Parks the thread and
+ * returns false if the channel is empty.
+ */
+static bool receive_value(
+	struct tarot_worker *worker,
+	struct tarot_thread *thread,
+	struct tarot_channel *channel,
+	union tarot_value *value,
+	bool *owned
+) {
+	struct tarot_thread *sender;
+	tarot_lock_channel(channel);
+	if (tarot_channel_is_empty(channel)) {
+		tarot_wait_to_receive(channel, thread);
+		count_parked_thread(worker->vm);
+		tarot_unlock_channel(channel);
+		return false;
+	}
+	*value = tarot_channel_pop(channel, owned);
+	sender = tarot_wake_sender(channel);
+	tarot_unlock_channel(channel);
+	wake_thread(worker, sender);
+	return true;
+}
+
+/**
+ * Opens the stream a thread prints to. The chunks of an ordered parallel for
+ * loop print to a buffer, which is printed once the loop is joined.
+ * Requires the lock of the virtual machine.
+ */
+static struct tarot_iostream* open_output(struct tarot_thread *thread) {
+	if (thread->output == NULL) {
+		return tarot_stdout;
+	}
+	return tarot_fstropen(thread->output, TAROT_OUTPUT);
+}
+
+/**
+ * Ends the line a thread prints to. A new string stream starts out at the
+ * first column, so a buffer ends its line unless it already ends in one.
+ * Requires the lock of the virtual machine.
+ */
+static void print_newline(struct tarot_thread *thread) {
+	struct tarot_iostream *output;
+	size_t length;
+	if (thread->output == NULL) {
+		tarot_newline(tarot_stdout);
+		return;
+	}
+	length = tarot_string_length(*thread->output);
+	if (length > 0 and tarot_string_text(*thread->output)[length-1] != '\n') {
+		output = tarot_fstropen(thread->output, TAROT_OUTPUT);
+		tarot_fputc(output, '\n');
+		tarot_fclose(output);
+	}
+}
+
+/* Returns the value of the iteration at the given index */
+static tarot_integer* iteration_value(
+	tarot_integer *start,
+	tarot_integer *stepsize,
+	size_t index
+) {
+	tarot_integer *value = tarot_create_integer_from_short(index);
+	tarot_multiply_integers_in_place(value, stepsize);
+	tarot_add_integers_in_place(value, start);
+	return value;
+}
+
+/**
+ * Counts the iterations of a range like the sequential for loop, which runs
+ * while the iterator is less than the end. Returns zero on an error.
+ */
+static size_t count_iterations(
+	tarot_integer *start,
+	tarot_integer *end,
+	tarot_integer *stepsize
+) {
+	tarot_integer *count, *one;
+	size_t num_iterations = 0;
+	if (tarot_compare_integers(start, end) >= 0) {
+		return 0;
+	}
+	if (tarot_integer_to_float(stepsize) <= 0) {
+		tarot_error("Stepsize of a parallel for loop must be positive!");
+		return 0;
+	}
+	one = tarot_create_integer_from_short(1);
+	count = tarot_subtract_integers(end, start);
+	tarot_add_integers_in_place(count, stepsize);
+	tarot_subtract_integers_in_place(count, one);
+	tarot_divide_integers_in_place(count, stepsize);
+	if (tarot_integer_fits_short(count)) {
+		num_iterations = tarot_integer_to_short(count);
+	} else {
+		tarot_error("Range of a parallel for loop is too large!");
+	}
+	tarot_free_integer(count);
+	tarot_free_integer(one);
+	return num_iterations;
+}
+
+/* Returns the value a chunk starts its part of a reduction with */
+static union tarot_value identity_value(
+	enum tarot_datatype type,
+	enum ArithmeticExpressionOperator operator
+) {
+	union tarot_value z;
+	short identity = operator == EXPR_MULTIPLY ? 1 : 0;
+	memset(&z, 0, sizeof(z));
+	switch (type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			z.Integer = tarot_create_integer_from_short(identity);
+			break;
+		case TYPE_FLOAT:
+			z.Float = identity;
+			break;
+		case TYPE_RATIONAL:
+			z.Rational = tarot_create_rational_from_short(identity);
+			break;
+		case TYPE_STRING:
+			z.String = tarot_create_string("");
+			break;
+	}
+	return z;
+}
+
+/* Combines the partial result of a chunk into the reduced variable */
+static void reduce_value(
+	enum tarot_datatype type,
+	enum ArithmeticExpressionOperator operator,
+	union tarot_value *variable,
+	union tarot_value value
+) {
+	switch (type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			if (operator == EXPR_MULTIPLY) {
+				tarot_multiply_integers_in_place(variable->Integer, value.Integer);
+			} else {
+				tarot_add_integers_in_place(variable->Integer, value.Integer);
+			}
+			tarot_free_integer(value.Integer);
+			break;
+		case TYPE_FLOAT:
+			if (operator == EXPR_MULTIPLY) {
+				variable->Float *= value.Float;
+			} else {
+				variable->Float += value.Float;
+			}
+			break;
+		case TYPE_RATIONAL:
+			if (operator == EXPR_MULTIPLY) {
+				tarot_multiply_rationals_in_place(variable->Rational, value.Rational);
+			} else {
+				tarot_add_rationals_in_place(variable->Rational, value.Rational);
+			}
+			tarot_free_rational(value.Rational);
+			break;
+		case TYPE_STRING:
+			tarot_extend_string(&variable->String, value.String);
+			tarot_free_string(value.String);
+			break;
+	}
+}
+
+/**
+ * Spawns the thread of a chunk. It runs the loop in a copy of the frame of
+ * the parent, which lends it the values of all variables. Only the iterator
+ * and the reduced variable are set up for the chunk.
+ */
+static void start_chunk(
+	struct tarot_worker *worker,
+	struct tarot_thread *parent,
+	struct tarot_chunk *chunk,
+	tarot_slot iterator,
+	tarot_integer *first,
+	uint8_t *code
+) {
+	struct tarot_parallel_loop *loop = chunk->loop;
+	struct stackframe *frame = current_frame(parent);
+	size_t num_parameters = tarot_num_parameters(frame->function);
+	size_t num_variables = tarot_num_variables(frame->function);
+	union tarot_value *values = &parent->stack.base[parent->stack.baseptr - num_parameters - num_variables];
+	struct tarot_thread *thread = new_thread(worker->vm, &exit_instruction);
+	size_t i;
+	for (i = 0; i < num_parameters; i++) {
+		tarot_push(thread, values[i]);
+	}
+	tarot_call(thread, frame->function);
+	memcpy(
+		&thread->stack.base[thread->stack.baseptr - num_variables],
+		&values[num_parameters],
+		sizeof(*values) * num_variables
+	);
+	current_frame(thread)->self = frame->self;
+	thread->instruction_pointer = code;
+	thread->chunk = chunk;
+	thread->output = loop->is_ordered ? &chunk->output : parent->output;
+	tarot_push_region(thread);
+	tarot_variable(thread, iterator)->Integer = first;
+	if (loop->type != TYPE_VOID) {
+		*tarot_variable(thread, loop->reduction) = identity_value(loop->type, loop->operator);
+	}
+	spawn_thread(worker, thread);
+}
+
+/**
+ * Splits a range into chunks of about equal size and starts them. The
+ * parent holds on to the loop until it waits for the chunks.
+ */
+static void start_parallel_loop(
+	struct tarot_worker *worker,
+	struct tarot_thread *parent,
+	struct tarot_parallel_loop *loop,
+	tarot_slot iterator,
+	tarot_integer *start,
+	tarot_integer *end,
+	tarot_integer *stepsize,
+	uint8_t *code
+) {
+	size_t i, first = 0, num_iterations = count_iterations(start, end, stepsize);
+	loop->parent = parent;
+	loop->num_chunks = num_iterations < TAROT_PARALLEL_CHUNKS ? num_iterations : TAROT_PARALLEL_CHUNKS;
+	loop->num_running = loop->num_chunks + 1;
+	loop->chunks = tarot_malloc(sizeof(*loop->chunks) * loop->num_chunks);
+	parent->loop = loop;
+	for (i = 0; i < loop->num_chunks; i++) {
+		struct tarot_chunk *chunk = &loop->chunks[i];
+		/* The first chunks take one of the remaining iterations each */
+		size_t remainder = num_iterations % loop->num_chunks;
+		size_t next = num_iterations / loop->num_chunks * (i + 1) + (i < remainder ? i + 1 : remainder);
+		chunk->loop = loop;
+		chunk->end = iteration_value(start, stepsize, next);
+		if (loop->is_ordered) {
+			chunk->output = tarot_create_string("");
+		}
+		start_chunk(worker, parent, chunk, iterator, iteration_value(start, stepsize, first), code);
+		first = next;
+	}
+}
+
+/**
+ * Parks the parent of a parallel for loop until its chunks ended. Returns
+ * false if they ended already, the parent then joins the loop at once.
+ */
+static bool wait_for_chunks(
+	struct tarot_worker *worker,
+	struct tarot_parallel_loop *loop
+) {
+	struct tarot_virtual_machine *vm = worker->vm;
+	bool is_parked;
+	lock(vm->lock);
+	is_parked = --loop->num_running > 0;
+	if (is_parked) {
+		vm->num_parked_threads++;
+	}
+	unlock(vm->lock);
+	return is_parked;
+}
+
+/* Ends the chunk of a thread, the last one wakes the parent of the loop */
+static void end_chunk(
+	struct tarot_worker *worker,
+	struct tarot_chunk *chunk
+) {
+	struct tarot_virtual_machine *vm = worker->vm;
+	struct tarot_parallel_loop *loop = chunk->loop;
+	bool is_last;
+	lock(vm->lock);
+	is_last = --loop->num_running == 0;
+	unlock(vm->lock);
+	if (is_last) {
+		wake_thread(worker, loop->parent);
+	}
+}
+
+/**
+ * Prints the buffered output of an ordered loop and combines the partial
+ * results of the chunks, both in the order of the range. Frees the loop.
+ */
+static void join_parallel_loop(
+	struct tarot_virtual_machine *vm,
+	struct tarot_thread *thread
+) {
+	struct tarot_parallel_loop *loop = thread->loop;
+	size_t i;
+	if (loop->is_ordered) {
+		struct tarot_iostream *output;
+		lock(vm->lock);
+		output = open_output(thread);
+		for (i = 0; i < loop->num_chunks; i++) {
+			tarot_print_string(output, loop->chunks[i].output);
+		}
+		tarot_fclose(output);
+		unlock(vm->lock);
+	}
+	for (i = 0; i < loop->num_chunks; i++) {
+		struct tarot_chunk *chunk = &loop->chunks[i];
+		if (loop->type != TYPE_VOID) {
+			reduce_value(loop->type, loop->operator, tarot_variable(thread, loop->reduction), chunk->result);
+		}
+		tarot_free_integer(chunk->end);
+		tarot_free_string(chunk->output);
+	}
+	tarot_free(loop->chunks);
+	tarot_free(loop);
+	thread->loop = NULL;
+}
+
+/* Binds a function to the foreign function of the bytecode with its name */
+static void bind_foreign_function(
+	struct tarot_bytecode *bytecode,
+	struct tarot_foreign_call *functions,
 	const char *name,
-	tarot_foreign_function func
+	tarot_foreign_function func,
+	tarot_native_function native
 ) {
-	unsigned int index;
+	struct tarot_function *function;
 	assert(name != NULL);
-	assert(func != NULL);
+	assert(func != NULL or native != NULL);
+	function = tarot_lookup_foreign_function(bytecode, name);
+	if (function != NULL) {
+		unsigned int index = function - bytecode->foreign_functions;
+		tarot_debug("bound function '%s' to index %d\n", name, index);
+		functions[index].function = func;
+		functions[index].native = native;
+	}
+}
 
-	for (index = 0; index < vm->bytecode->num_foreign_functions; index++) {
-		struct tarot_function *function = &vm->bytecode->foreign_functions[index];
-		const char *function_name = (const char*)&vm->bytecode->data[function->address];
-		if (!strcmp(function_name, name)) {
-			tarot_debug("bound function '%s' to index %d\n", name, index);
-			vm->functions[index] = func;
-			break;
+/* Reports the foreign functions no function is bound to */
+static bool is_fully_bound(
+	struct tarot_bytecode *bytecode,
+	struct tarot_foreign_call *functions
+) {
+	bool is_bound = true;
+	unsigned int index;
+	for (index = 0; index < bytecode->num_foreign_functions; index++) {
+		if (functions[index].function == NULL and functions[index].native == NULL) {
+			struct tarot_function *function = &bytecode->foreign_functions[index];
+			const char *function_name = (const char*)&bytecode->data[function->address];
+			tarot_error("Foreign function '%s' is not registered!", function_name);
+			is_bound = false;
 		}
 	}
+	return is_bound;
 }
 
-struct tarot_virtual_machine* tarot_create_virtual_machine(struct tarot_bytecode *bytecode) {
+/* Copies the functions bound to the bytecode, if any */
+static void copy_bindings(
+	struct tarot_bytecode *bytecode,
+	struct tarot_foreign_call *functions
+) {
+	if (bytecode->bindings != NULL) {
+		memcpy(functions, bytecode->bindings, sizeof(*functions) * bytecode->num_foreign_functions);
+	}
+}
+
+void tarot_register_foreign_function(
+	struct tarot_virtual_machine *vm,
+	const char *name,
+	tarot_foreign_function func
+) {
+	bind_foreign_function(vm->bytecode, vm->functions, name, func, NULL);
+}
+
+void tarot_register_native_function(
+	struct tarot_virtual_machine *vm,
+	const char *name,
+	tarot_native_function native
+) {
+	bind_foreign_function(vm->bytecode, vm->functions, name, NULL, native);
+}
+
+void tarot_register_foreign_functions(
+	struct tarot_virtual_machine *vm,
+	const struct tarot_foreign_binding *bindings,
+	size_t num_bindings
+) {
+	size_t i;
+	for (i = 0; i < num_bindings; i++) {
+		bind_foreign_function(
+			vm->bytecode,
+			vm->functions,
+			bindings[i].name,
+			bindings[i].function,
+			bindings[i].native
+		);
+	}
+}
+
+/* Returns NULL if functions were bound to the bytecode, but not all of them */
+static struct tarot_virtual_machine* create_machine(
+	struct tarot_bytecode *bytecode,
+	struct tarot_virtual_machine_pool *pool
+) {
 	struct tarot_virtual_machine *vm = tarot_malloc(sizeof(*vm));
-	spawn_thread(vm, bytecode->instructions);
 	vm->bytecode = bytecode;
+	vm->num_functions = bytecode->num_foreign_functions;
+	if (pool != NULL) {
+		vm->functions = pool->functions;
+	} else {
+		vm->functions = tarot_malloc(sizeof(*vm->functions) * vm->num_functions);
+		copy_bindings(bytecode, vm->functions);
+	}
+	if (bytecode->bindings != NULL and not is_fully_bound(bytecode, vm->functions)) {
+		if (pool == NULL) {
+			tarot_free(vm->functions);
+		}
+		tarot_free(vm);
+		return NULL;
+	}
+	vm->pool = pool;
+	vm->num_workers = 1;
+	vm->workers = tarot_malloc(sizeof(*vm->workers));
+	vm->workers[0].vm = vm;
+	return vm;
+}
+
+/* Spawns the thread that runs the program, in the current context */
+static void start_machine(struct tarot_virtual_machine *vm) {
+	vm->context = tarot_current_context();
+	vm->workers[0].context = vm->context;
+	spawn_thread(&vm->workers[0], new_thread(vm, vm->bytecode->instructions));
+}
+
+/* Frees the threads that did not run, keeping one as the spare thread */
+static void stop_machine(struct tarot_virtual_machine *vm) {
+	size_t i;
+	for (i = 0; i < vm->num_workers; i++) {
+		struct tarot_thread *thread = NULL;
+		while ((thread = get_ready_thread(&vm->workers[i], false))) {
+			exit_thread(vm, thread);
+		}
+	}
+	vm->num_threads = 0;
+	vm->num_parked_threads = 0;
+	vm->is_deadlocked = false;
+}
+
+struct tarot_virtual_machine* tarot_create_virtual_machine(struct tarot_bytecode *bytecode) {
+	struct tarot_virtual_machine *vm = create_machine(bytecode, NULL);
+	if (vm != NULL) {
+		start_machine(vm);
+	}
 	return vm;
 }
 
 void tarot_free_virtual_machine(struct tarot_virtual_machine *vm) {
-	struct tarot_thread *thread = NULL;
-	while ((thread = get_ready_thread(vm))) {
-		free_thread(thread);
+	struct tarot_context *previous = tarot_enter_context(vm->context);
+	stop_machine(vm);
+	if (vm->spare_thread != NULL) {
+		free_thread(vm->spare_thread);
+	}
+	if (vm->pool == NULL) {
+		tarot_free(vm->functions);
 	}
+	tarot_free(vm->workers);
 	tarot_free(vm);
+	tarot_enter_context(previous);
+}
+
+bool tarot_invoke_function(
+	struct tarot_virtual_machine *vm,
+	struct tarot_function *function,
+	const union tarot_value *arguments,
+	union tarot_value *result
+) {
+	struct tarot_thread *thread = new_thread(vm, &exit_instruction);
+	struct tarot_result slot;
+	size_t i;
+	assert(function != NULL);
+	memset(&slot, 0, sizeof(slot));
+	for (i = 0; i < tarot_num_parameters(function); i++) {
+		tarot_push(thread, arguments[i]);
+	}
+	thread->instruction_pointer = &vm->bytecode->instructions[tarot_call(thread, function)];
+	thread->result = &slot;
+	tarot_push_region(thread);
+	spawn_thread(&vm->workers[0], thread);
+	tarot_attach_executor(vm);
+	if (slot.has_returned and result != NULL) {
+		*result = slot.value;
+	}
+	return slot.has_returned;
+}
+
+union tarot_value tarot_call_function(
+	struct tarot_virtual_machine *vm,
+	const char *function_name, ...
+) {
+	struct tarot_function *function = tarot_lookup_function(vm->bytecode, function_name);
+	union tarot_value arguments[TAROT_MAX_PARAMETERS];
+	union tarot_value result;
+	va_list ap;
+	size_t i;
+	assert(function != NULL);
+	va_start(ap, function_name);
+	for (i = 0; i < tarot_num_parameters(function); i++) {
+		arguments[i] = va_arg(ap, union tarot_value);
+	}
+	va_end(ap);
+	memset(&result, 0, sizeof(result));
+	tarot_invoke_function(vm, function, arguments, &result);
+	return result;
+}
+
+struct tarot_virtual_machine_pool* tarot_create_virtual_machine_pool(
+	struct tarot_bytecode *bytecode
+) {
+	struct tarot_virtual_machine_pool *pool = tarot_malloc(sizeof(*pool));
+	pool->bytecode = bytecode;
+	pool->functions = tarot_malloc(sizeof(*pool->functions) * bytecode->num_foreign_functions);
+	copy_bindings(bytecode, pool->functions);
+	if (tarot_has_threading()) {
+		pool->lock = tarot_threading.create_mutex();
+	}
+	return pool;
+}
+
+void tarot_free_virtual_machine_pool(struct tarot_virtual_machine_pool *pool) {
+	struct tarot_virtual_machine *vm;
+	while ((vm = pool->idle_machines) != NULL) {
+		pool->idle_machines = vm->next_machine;
+		/* The context the machine ran in last may be gone by now */
+		vm->context = tarot_current_context();
+		tarot_free_virtual_machine(vm);
+	}
+	if (pool->lock != NULL) {
+		tarot_threading.free_mutex(pool->lock);
+	}
+	tarot_free(pool->functions);
+	tarot_free(pool);
+}
+
+void tarot_register_pool_function(
+	struct tarot_virtual_machine_pool *pool,
+	const char *name,
+	tarot_foreign_function func
+) {
+	bind_foreign_function(pool->bytecode, pool->functions, name, func, NULL);
+}
+
+void tarot_register_pool_native_function(
+	struct tarot_virtual_machine_pool *pool,
+	const char *name,
+	tarot_native_function native
+) {
+	bind_foreign_function(pool->bytecode, pool->functions, name, NULL, native);
+}
+
+struct tarot_virtual_machine* tarot_acquire_virtual_machine(
+	struct tarot_virtual_machine_pool *pool
+) {
+	struct tarot_virtual_machine *vm;
+	lock(pool->lock);
+	vm = pool->idle_machines;
+	if (vm != NULL) {
+		pool->idle_machines = vm->next_machine;
+		vm->next_machine = NULL;
+	}
+	unlock(pool->lock);
+	if (vm == NULL) {
+		vm = create_machine(pool->bytecode, pool);
+	}
+	if (vm != NULL) {
+		start_machine(vm);
+	}
+	return vm;
+}
+
+void tarot_release_virtual_machine(struct tarot_virtual_machine *vm) {
+	struct tarot_virtual_machine_pool *pool = vm->pool;
+	assert(pool != NULL);
+	stop_machine(vm);
+	lock(pool->lock);
+	vm->next_machine = pool->idle_machines;
+	pool->idle_machines = vm;
+	unlock(pool->lock);
+}
+
+bool tarot_is_fully_bound(struct tarot_virtual_machine *vm) {
+	return is_fully_bound(vm->bytecode, vm->functions);
 }
 
 void tarot_execute_bytecode(struct tarot_bytecode *bytecode) {
 	struct tarot_virtual_machine *vm = tarot_create_virtual_machine(bytecode);
-	tarot_attach_executor(vm);
-	tarot_free_virtual_machine(vm);
+	if (vm != NULL) {
+		if (tarot_is_fully_bound(vm)) {
+			tarot_attach_executor(vm);
+		}
+		tarot_free_virtual_machine(vm);
+	}
 }
 
-void tarot_attach_executor(struct tarot_virtual_machine *vm) {
-	struct tarot_thread *thread = get_ready_thread(vm);
+/* Creates an empty string with room for length bytes, in scratch memory or
+ * in the region */
+static struct tarot_string* allocate_string(
+	struct tarot_thread *thread,
+	size_t length,
+	bool scratch
+) {
+	size_t size = tarot_string_size(length + 1);
+	void *memory;
+	if (scratch) {
+		memory = tarot_scratch_alloc(thread, size);
+	} else {
+		memory = tarot_malloc(size);
+		tarot_add_to_region(thread, memory);
+	}
+	return tarot_place_string(memory, length + 1);
+}
+
+/* Returns the length of a part of OP_StringBuild, an upper bound for numbers */
+static size_t part_length(enum tarot_datatype type, union tarot_value value) {
+	switch (type) {
+		default:
+			tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase!");
+			return 0;
+		case TYPE_BOOLEAN:
+			return strlen(tarot_bool_string(value.Boolean));
+		case TYPE_FLOAT:
+			return tarot_fstrlen("%f", value.Float);
+		case TYPE_INTEGER:
+			return tarot_integer_text_size(value.Integer);
+		case TYPE_RATIONAL:
+			return tarot_rational_text_size(value.Rational);
+		case TYPE_STRING:
+			return tarot_string_length(value.String);
+	}
+}
+
+static void append_text(struct tarot_string **stringptr, const char *text) {
+	size_t length = strlen(text);
+	memcpy(tarot_string_reserve(stringptr, length), text, length);
+	tarot_string_commit(*stringptr, length);
+}
+
+static void append_part(
+	struct tarot_string **stringptr,
+	enum tarot_datatype type,
+	union tarot_value value
+) {
+	char *text;
+	switch (type) {
+		default:
+			break;
+		case TYPE_BOOLEAN:
+			append_text(stringptr, tarot_bool_string(value.Boolean));
+			break;
+		case TYPE_FLOAT:
+			tarot_string_append(stringptr, "%f", value.Float);
+			break;
+		case TYPE_INTEGER:
+			text = tarot_string_reserve(stringptr, tarot_integer_text_size(value.Integer));
+			tarot_integer_to_text(value.Integer, text);
+			tarot_string_commit(*stringptr, strlen(text));
+			break;
+		case TYPE_RATIONAL:
+			text = tarot_string_reserve(stringptr, tarot_rational_text_size(value.Rational));
+			tarot_rational_to_text(value.Rational, text);
+			tarot_string_commit(*stringptr, strlen(text));
+			break;
+		case TYPE_STRING:
+			tarot_extend_string(stringptr, value.String);
+			break;
+	}
+}
+
+/* Executes OP_StringBuild, the parts are walked once to size the string
+ * and once more to write them */
+static struct tarot_string* build_string(
+	struct tarot_virtual_machine *vm,
+	struct tarot_thread *thread,
+	uint8_t **ipptr,
+	bool scratch
+) {
+	uint8_t *ip = *ipptr;
+	tarot_address num_parts = tarot_read_argument(ip, &ip);
+	uint8_t *parts = ip;
+	union tarot_value *values;
+	struct tarot_string *string;
+	size_t i, k, num_values = 0, length = 0;
+	for (i = 0; i < num_parts; i++) {
+		if (tarot_read8bit(ip, &ip) == TYPE_VOID) {
+			tarot_read_argument(ip, &ip);
+		} else {
+			num_values++;
+		}
+	}
+	*ipptr = ip;
+	values = tarot_topptr(thread) + 1 - num_values;
+	for (ip = parts, i = 0, k = 0; i < num_parts; i++) {
+		enum tarot_datatype type = tarot_read8bit(ip, &ip);
+		if (type == TYPE_VOID) {
+			length += strlen(read_string(vm->bytecode, tarot_read_argument(ip, &ip)));
+		} else {
+			length += part_length(type, values[k++]);
+		}
+	}
+	string = allocate_string(thread, length, scratch);
+	for (ip = parts, i = 0, k = 0; i < num_parts; i++) {
+		enum tarot_datatype type = tarot_read8bit(ip, &ip);
+		if (type == TYPE_VOID) {
+			append_text(&string, read_string(vm->bytecode, tarot_read_argument(ip, &ip)));
+		} else {
+			append_part(&string, type, values[k++]);
+		}
+	}
+	for (k = 0; k < num_values; k++) {
+		tarot_pop(thread);
+	}
+	return string;
+}
+
+/* Frees the return value of the entry function of a launched thread */
+static void discard_value(enum tarot_datatype type, union tarot_value value) {
+	switch (type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			tarot_free_integer(value.Integer);
+			break;
+		case TYPE_RATIONAL:
+			tarot_free_rational(value.Rational);
+			break;
+		case TYPE_STRING:
+			tarot_free_string(value.String);
+			break;
+		case TYPE_LIST:
+			tarot_free_list(value.List);
+			break;
+		case TYPE_CUSTOM:
+			tarot_free_object(value.Object);
+			break;
+		case TYPE_DICT:
+			tarot_free_dictionary(value.Dict);
+			break;
+		case TYPE_CHANNEL:
+			tarot_free_channel(value.Channel);
+			break;
+	}
+}
+
+/**
+ * Runs a thread for a time slice of TAROT_TIME_SLICE instructions, or until
+ * it would block. A thread that blocks on input yields while other threads
+ * are ready, a thread that blocks on a channel is parked. A parked thread
+ * belongs to the channel and must not be touched by the worker anymore.
+ */
+/* Adds a value returned by a function to the region of the caller */
+static void track_value(
+	struct tarot_thread *thread,
+	enum tarot_datatype type,
+	union tarot_value value
+) {
+	switch (type) {
+		default:
+			break;
+		case TYPE_INTEGER:
+			tarot_add_to_region(thread, value.Integer);
+			break;
+		case TYPE_RATIONAL:
+			tarot_add_to_region(thread, value.Rational);
+			break;
+		case TYPE_STRING:
+			tarot_add_to_region(thread, value.String);
+			break;
+		case TYPE_LIST:
+			tarot_add_to_region(thread, value.List);
+			break;
+		case TYPE_CUSTOM:
+			tarot_add_to_region(thread, value.Object);
+			break;
+		case TYPE_DICT:
+			tarot_add_to_region(thread, value.Dict);
+			break;
+		case TYPE_CHANNEL:
+			tarot_add_to_region(thread, value.Channel);
+			break;
+	}
+}
+
+/**
+ * Calls a foreign function in a frame of its own, which replaces the
+ * arguments on top of the stack by the return value. Returns false if no
+ * function was registered for it.
+ */
+static bool call_foreign_function(
+	struct tarot_virtual_machine *vm,
+	struct tarot_thread *thread,
+	size_t index
+) {
+	struct tarot_function *function = &vm->bytecode->foreign_functions[index];
+	struct tarot_foreign_call *call = &vm->functions[index];
+	if (call->native != NULL) {
+		/* The arguments are passed in place, without a frame */
+		size_t num_arguments = tarot_num_parameters(function);
+		union tarot_value result;
+		thread->stack.ptr -= num_arguments;
+		call->native(&thread->stack.base[thread->stack.ptr], num_arguments, &result);
+		if (tarot_returns(function)) {
+			tarot_push(thread, result);
+		}
+		return true;
+	}
+	if (call->function == NULL) {
+		tarot_error(
+			"Foreign function '%s' is not registered!",
+			read_string(vm->bytecode, function->address)
+		);
+		return false;
+	}
+	tarot_call(thread, function);
+	call->function(thread);
+	tarot_return(thread);
+	return true;
+}
+
+static enum thread_state run_thread(
+	struct tarot_worker *worker,
+	struct tarot_thread *thread
+) {
+	struct tarot_virtual_machine *vm = worker->vm;
 	uint8_t *ip = thread->instruction_pointer;
+	size_t budget = TAROT_TIME_SLICE;
 
 	for (;;) {
 		enum tarot_opcode opcode;
+		if (--budget == 0) {
+			if (has_ready_threads(worker)) {
+				goto yield;
+			}
+			budget = TAROT_TIME_SLICE;
+		}
 		tarot_debug("[%d] %s", ip - vm->bytecode->instructions, opcode_string(*ip));
 		opcode = *ip++;
 
 		switch (opcode) {
 			union tarot_value a, b, z;
 			enum tarot_datatype type;
+			struct tarot_iostream *output;
 			size_t i, length;
 
 		case OP_Halt: halt:
-			free_thread(thread);
-			return;
+			return THREAD_HALTED;
+
+		yield:
+			thread->instruction_pointer = ip;
+			return THREAD_READY;
 
 		case OP_NoOperation:
 			break;
 
 		case OP_Debug:
-			tarot_debug(read_string(vm->bytecode, tarot_read16bit(ip, &ip)));
+			tarot_debug(read_string(vm->bytecode, tarot_read_argument(ip, &ip)));
 			break;
 
 		case OP_Assert: {
-			const char *text = (const char*)&vm->bytecode->data[tarot_read16bit(ip, &ip)];
+			const char *text = (const char*)&vm->bytecode->data[tarot_read_argument(ip, &ip)];
 			if (not tarot_pop(thread).Boolean) {
 				tarot_error(text);
 				/* TODO: Pop all regions | get region index at start and pop until index */
@@ -138,7 +1188,7 @@ void tarot_attach_executor(struct tarot_virtual_machine *vm) {
 			break;
 
 		case OP_PushTry:
-			push_try(thread, tarot_read16bit(ip, &ip));
+			push_try(thread, tarot_read_argument(ip, &ip));
 			break;
 
 		case OP_PopTry:
@@ -162,7 +1212,7 @@ TODO:
 /* TODO: Include line number and file for occurance? */
 		case OP_RaiseException:
 			/* Make seperate push before raise, so that we can reraise via stack */
-			z.Index = tarot_read16bit(ip, &ip); /* exception uid */
+			z.Index = tarot_read_argument(ip, &ip); /* exception uid */
 			tarot_push(thread, z);
 			if (handler_available(thread)) {
 				ip = vm->bytecode->instructions + current_try(thread);
@@ -210,8 +1260,11 @@ TODO:
 			break;
 
 		case OP_StoreRational:
+			b = tarot_pop(thread);
 			z = tarot_pop(thread);
 			tarot_remove_from_region(thread, z.Rational);
+			tarot_free_rational(b.Value->Rational);
+			*b.Value = z;
 			break;
 
 		case OP_StoreString:
@@ -230,32 +1283,48 @@ TODO:
 			*b.Value = z;
 			break;
 
+		case OP_StoreDict:
+			b = tarot_pop(thread);
+			z = tarot_pop(thread);
+			tarot_remove_from_region(thread, z.Dict);
+			tarot_free_dictionary(b.Value->Dict);
+			*b.Value = z;
+			break;
+
 		case OP_LoadValue:
-			tarot_push(thread, *tarot_variable(thread, tarot_read16bit(ip, &ip)));
+			tarot_push(thread, *tarot_variable(thread, tarot_read_argument(ip, &ip)));
+			break;
+
+		case OP_MoveValue:
+			b.Value = tarot_variable(thread, tarot_read_argument(ip, &ip));
+			z = *b.Value;
+			b.Value->Pointer = NULL;
+			tarot_add_to_region(thread, z.Pointer);
+			tarot_push(thread, z);
 			break;
 
 		case OP_LoadArgument:
-			i = tarot_read16bit(ip, &ip);
+			i = tarot_read_argument(ip, &ip);
 			tarot_push(thread, tarot_argument(thread, i));
 			break;
 
 		case OP_LoadVariablePointer:
-			z.Value = tarot_variable(thread, tarot_read8bit(ip, &ip));
+			z.Value = tarot_variable(thread, tarot_read_slot(ip, &ip));
 			tarot_push(thread, z);
 			break;
 
 		case OP_LoadListIndex:
 			a = tarot_pop(thread);
-			z = tarot_pop(thread);
+			z = tarot_pop(thread); /* points to the list */
 			i = tarot_integer_to_short(a.Integer);
-			b.Value = (union tarot_value*)tarot_list_element(z.List, i);
+			b.Value = tarot_list_writable_element(&z.Value->List, i);
 			tarot_push(thread, b);
 			break;
 
 		case OP_LoadDictIndex:
 			a = tarot_pop(thread);
-			z = tarot_pop(thread);
-			b.Value = tarot_dict_lookup(z.List, a);
+			z = tarot_pop(thread); /* points to the dict */
+			b.Value = tarot_dict_lookup(z.Value->Dict, a);
 			tarot_push(thread, b);
 			break;
 
@@ -271,7 +1340,7 @@ TODO:
 		 */
 
 		case OP_NewObject:
-			i = tarot_read16bit(ip, &ip); /* number of attrs */
+			i = tarot_read_argument(ip, &ip); /* number of attrs */
 			z.Object = tarot_create_object(i);
 			tarot_push(thread, z);
 			/*tarot_add_to_region(thread, z.Object);*/
@@ -290,6 +1359,12 @@ TODO:
 			tarot_push(thread, a);
 			break;
 
+		case OP_CopyObject:
+			z.Object = tarot_copy_object(tarot_pop(thread).Object);
+			tarot_add_to_region(thread, z.Object);
+			tarot_push(thread, z);
+			break;
+
 		case OP_Read:
 			tarot_push(thread, *tarot_pop(thread).Value);
 			break;
@@ -307,47 +1382,33 @@ TODO:
 		 */
 
 		case OP_CallFunction:
-			thread->instruction_pointer = ip+2;
-			ip = &vm->bytecode->instructions[tarot_call(thread, &vm->bytecode->functions[tarot_read16bit(ip, &ip)])];
+			thread->instruction_pointer = ip + sizeof(tarot_address);
+			ip = &vm->bytecode->instructions[tarot_call(thread, &vm->bytecode->functions[tarot_read_argument(ip, &ip)])];
 			tarot_push_region(thread);
 			break;
 
 		case OP_Return:
-			type = tarot_read16bit(ip, &ip);
+			type = tarot_read_argument(ip, &ip);
 			z = tarot_top(thread);
 			tarot_pop_region(thread);
 			ip = tarot_return(thread);
-			switch (type) {
-				default:
-					break;
-				case TYPE_INTEGER:
-					tarot_add_to_region(thread, z.Integer);
-					break;
-				case TYPE_RATIONAL:
-					tarot_add_to_region(thread, z.Rational);
-					break;
-				case TYPE_STRING:
-					tarot_add_to_region(thread, z.String);
-					break;
-				case TYPE_LIST:
-					tarot_add_to_region(thread, z.List);
-					break;
-				case TYPE_CUSTOM:
-					tarot_add_to_region(thread, z.Object);
-					break;
-				case TYPE_DICT:
-					z.Dict = tarot_copy_dict(tarot_pop(thread).Dict);
-					/* All list elements are not in the region */
-					tarot_add_to_region(thread, z.Dict);
-					tarot_push(thread, z);
-					break;
+			if (ip == &exit_instruction) {
+				if (thread->result != NULL and not thread->except) {
+					thread->result->value = z;
+					thread->result->has_returned = true;
+				} else {
+					discard_value(type, z);
+				}
+				goto halt;
 			}
+			track_value(thread, type, z);
 			if (thread->except) {
 				if (handler_available(thread)) {
 					ip = vm->bytecode->instructions + current_try(thread);
 					thread->except = false;
 					tarot_print_stacktrace(tarot_stdout, vm->bytecode, thread->stacktrace);
 					tarot_free_list(thread->stacktrace);
+					thread->stacktrace = NULL;
 				} else {
 					/* goto finally+return */
 					thread->except = true;
@@ -357,15 +1418,71 @@ TODO:
 			}
 			break;
 
+		case OP_CallForeignFunction:
+			i = tarot_read_argument(ip, &ip);
+			type = tarot_read_argument(ip, &ip);
+			if (not call_foreign_function(vm, thread, i)) {
+				goto halt;
+			}
+			if (type != TYPE_VOID) {
+				track_value(thread, type, tarot_top(thread));
+			}
+			break;
+
+		case OP_Launch: {
+			struct tarot_function *function = &vm->bytecode->functions[tarot_read_argument(ip, &ip)];
+			launch_thread(worker, thread, function, ip);
+			ip += tarot_num_parameters(function);
+			break;
+		}
+
+		case OP_ParallelFor: {
+			struct tarot_parallel_loop *loop = tarot_malloc(sizeof(*loop));
+			tarot_slot iterator = tarot_read_slot(ip, &ip);
+			tarot_address join;
+			loop->reduction = tarot_read_slot(ip, &ip);
+			loop->type = *ip++;
+			loop->operator = *ip++;
+			loop->is_ordered = *ip++;
+			join = tarot_read_argument(ip, &ip);
+			z = tarot_pop(thread); /* stepsize */
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			start_parallel_loop(worker, thread, loop, iterator, a.Integer, b.Integer, z.Integer, ip);
+			ip = &vm->bytecode->instructions[join];
+			thread->instruction_pointer = ip;
+			if (wait_for_chunks(worker, loop)) {
+				return THREAD_PARKED;
+			}
+			break;
+		}
+
+		case OP_ChunkEnd:
+			z.Integer = thread->chunk->end;
+			tarot_push(thread, z);
+			break;
+
+		case OP_EndChunk:
+			if (thread->chunk->loop->type != TYPE_VOID) {
+				thread->chunk->result = *tarot_variable(thread, thread->chunk->loop->reduction);
+			}
+			tarot_clear_regions(thread);
+			end_chunk(worker, thread->chunk);
+			goto halt;
+
+		case OP_JoinChunks:
+			join_parallel_loop(vm, thread);
+			break;
+
 		case OP_Goto:
-			ip = &vm->bytecode->instructions[tarot_read16bit(ip, &ip)];
+			ip = &vm->bytecode->instructions[tarot_read_argument(ip, &ip)];
 			break;
 
 		case OP_GotoIfFalse:
 			if (not tarot_pop(thread).Boolean) {
-				ip = &vm->bytecode->instructions[tarot_read16bit(ip, &ip)];
+				ip = &vm->bytecode->instructions[tarot_read_argument(ip, &ip)];
 			} else {
-				tarot_read16bit(ip, &ip);
+				tarot_read_argument(ip, &ip);
 			}
 			break;
 
@@ -422,7 +1539,7 @@ TODO:
 		 */
 
 		case OP_PushInteger:
-			z.Integer = tarot_import_integer(&vm->bytecode->data[tarot_read16bit(ip, &ip)], NULL);
+			z.Integer = tarot_import_integer(&vm->bytecode->data[tarot_read_argument(ip, &ip)], NULL);
 			tarot_add_to_region(thread, z.Integer);
 			tarot_push(thread, z);
 			break;
@@ -434,17 +1551,23 @@ TODO:
 			break;
 
 		case OP_CopyList:
-			z.List = tarot_copy_list(tarot_pop(thread).List);
+			z.List = tarot_share_list(tarot_pop(thread).List);
 			tarot_add_to_region(thread, z.List);
 			tarot_push(thread, z);
 			break;
 
+		case OP_CopyDict:
+			z.Dict = tarot_copy_dict(tarot_pop(thread).Dict);
+			tarot_add_to_region(thread, z.Dict);
+			tarot_push(thread, z);
+			break;
+
 		case OP_FreeInteger:
 			tarot_free_integer(tarot_pop(thread).Value->Integer);
 			break;
 
 		case OP_CastToInteger:
-			type = tarot_read16bit(ip, &ip);
+			type = tarot_read_argument(ip, &ip);
 			z.Integer = tarot_integer_cast(tarot_pop(thread), type);
 			tarot_add_to_region(thread, z.Integer);
 			tarot_push(thread, z);
@@ -544,17 +1667,47 @@ TODO:
 			tarot_push(thread, z);
 			break;
 
+		case OP_IntegerAddInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_add_integers_in_place(b.Value->Integer, a.Integer);
+			break;
+
+		case OP_IntegerSubtractInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_subtract_integers_in_place(b.Value->Integer, a.Integer);
+			break;
+
+		case OP_IntegerMultiplyInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_multiply_integers_in_place(b.Value->Integer, a.Integer);
+			break;
+
+		case OP_IntegerDivideInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_divide_integers_in_place(b.Value->Integer, a.Integer);
+			break;
+
+		case OP_IntegerModuloInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_modulo_integers_in_place(b.Value->Integer, a.Integer);
+			break;
+
 		/*
 		 * MARK: Float
 		 */
 
 		case OP_PushFloat:
-			z.Float = tarot_read_float(&vm->bytecode->data[tarot_read16bit(ip, &ip)]);
+			z.Float = tarot_read_float(&vm->bytecode->data[tarot_read_argument(ip, &ip)]);
 			tarot_push(thread, z);
 			break;
 
 		case OP_CastToFloat:
-			switch (tarot_read16bit(ip, &ip)) {
+			switch (tarot_read_argument(ip, &ip)) {
 				default:
 					break;
 				case TYPE_FLOAT:
@@ -681,31 +1834,40 @@ TODO:
 		 */
 
 		case OP_PushRational:
-			z.Rational = tarot_import_rational(&vm->bytecode->data[tarot_read16bit(ip, &ip)]);
+			z.Rational = tarot_import_rational(&vm->bytecode->data[tarot_read_argument(ip, &ip)]);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
+		case OP_FreeRational:
+			tarot_free_rational(tarot_pop(thread).Value->Rational);
+			break;
+
 		case OP_CopyRational:
 			z.Rational = tarot_copy_rational(tarot_pop(thread).Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
 		case OP_CastToRational:
-			switch (tarot_read16bit(ip, &ip)) {
+			switch (tarot_read_argument(ip, &ip)) {
 				default:
 					break;
 				case TYPE_FLOAT:
 					z.Rational = tarot_create_rational_from_float(tarot_pop(thread).Float);
+					tarot_add_to_region(thread, z.Rational);
 					tarot_push(thread, z);
 					break;
 				case TYPE_INTEGER:
 					z.Rational = tarot_create_rational_from_integer(tarot_pop(thread).Integer);
+					tarot_add_to_region(thread, z.Rational);
 					tarot_push(thread, z);
 					break;
 				case TYPE_RATIONAL:
 					break;
 				case TYPE_STRING:
 					z.Rational = tarot_create_rational_from_string(tarot_pop(thread).String);
+					tarot_add_to_region(thread, z.Rational);
 					tarot_push(thread, z);
 					break;
 			}
@@ -713,11 +1875,13 @@ TODO:
 
 		case OP_RationalAbs:
 			z.Rational = tarot_rational_abs(tarot_pop(thread).Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
 		case OP_RationalNeg:
 			z.Rational = tarot_rational_neg(tarot_pop(thread).Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
@@ -725,6 +1889,7 @@ TODO:
 			b = tarot_pop(thread);
 			a = tarot_pop(thread);
 			z.Rational = tarot_add_rationals(a.Rational, b.Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
@@ -732,6 +1897,7 @@ TODO:
 			b = tarot_pop(thread);
 			a = tarot_pop(thread);
 			z.Rational = tarot_subtract_rationals(a.Rational, b.Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
@@ -739,6 +1905,7 @@ TODO:
 			b = tarot_pop(thread);
 			a = tarot_pop(thread);
 			z.Rational = tarot_multiply_rationals(a.Rational, b.Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
@@ -746,6 +1913,7 @@ TODO:
 			b = tarot_pop(thread);
 			a = tarot_pop(thread);
 			z.Rational = tarot_divide_rationals(a.Rational, b.Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
@@ -760,6 +1928,7 @@ TODO:
 			b = tarot_pop(thread);
 			a = tarot_pop(thread);
 			z.Rational = tarot_exponentiate_rationals(a.Rational, b.Rational);
+			tarot_add_to_region(thread, z.Rational);
 			tarot_push(thread, z);
 			break;
 
@@ -798,18 +1967,47 @@ TODO:
 			tarot_push(thread, z);
 			break;
 
+		case OP_RationalAddInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_add_rationals_in_place(b.Value->Rational, a.Rational);
+			break;
+
+		case OP_RationalSubtractInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_subtract_rationals_in_place(b.Value->Rational, a.Rational);
+			break;
+
+		case OP_RationalMultiplyInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_multiply_rationals_in_place(b.Value->Rational, a.Rational);
+			break;
+
+		case OP_RationalDivideInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_divide_rationals_in_place(b.Value->Rational, a.Rational);
+			break;
+
 		/*
 		 * MARK: String
 		 */
 
 		case OP_PushString:
-			z.String = tarot_import_string(&vm->bytecode->data[tarot_read16bit(ip, &ip)]);
+			i = tarot_read_argument(ip, &ip);
+			/* Immortal constants are tracked as well, stores look them up */
+			z.String = tarot_string_constant(vm->bytecode, i);
+			if (z.String == NULL) {
+				z.String = tarot_import_string(&vm->bytecode->data[i]);
+			}
 			tarot_add_to_region(thread, z.String);
 			tarot_push(thread, z);
 			break;
 
 		case OP_CopyString:
-			z.String = tarot_copy_string(tarot_pop(thread).String);
+			z.String = tarot_share_string(tarot_pop(thread).String);
 			tarot_add_to_region(thread, z.String);
 			tarot_push(thread, z);
 			break;
@@ -819,11 +2017,11 @@ TODO:
 			break;
 
 		case OP_CastToString:
-			switch (tarot_read16bit(ip, &ip)) {
+			switch (tarot_read_argument(ip, &ip)) {
 				default:
 					break;
 				case TYPE_BOOLEAN:
-					z.String = tarot_create_string(tarot_bool_string(tarot_pop(thread).Boolean));
+					z.String = tarot_create_string("%s", tarot_bool_string(tarot_pop(thread).Boolean));
 					tarot_add_to_region(thread, z.String);
 					tarot_push(thread, z);
 					break;
@@ -877,12 +2075,28 @@ TODO:
 			tarot_push(thread, z);
 			break;
 
+		case OP_StringBuild:
+		case OP_ScratchStringBuild:
+			z.String = build_string(vm, thread, &ip, opcode == OP_ScratchStringBuild);
+			tarot_push(thread, z);
+			break;
+
+		case OP_ResetScratch:
+			tarot_reset_scratch(thread);
+			break;
+
 		case OP_StringLength:
 			z = tarot_pop(thread);
 			z.Integer = tarot_create_integer_from_short(tarot_string_length(z.String));
 			tarot_push(thread, z);
 			break;
 
+		case OP_StringAppendInPlace:
+			b = tarot_pop(thread);
+			a = tarot_pop(thread);
+			tarot_extend_string(&b.Value->String, a.String);
+			break;
+
 		/*
 		 * MARK: List & Dict
 		 */
@@ -939,15 +2153,28 @@ TODO:
 			break;
 
 		case OP_PushDict:
-			length = tarot_read16bit(ip, &ip);
+			length = tarot_read_argument(ip, &ip);
+			type = tarot_read8bit(ip, &ip);
 			z.Dict = tarot_create_dictionary();
+			tarot_set_list_datatype(z.Dict, type);
 			for (i = 0; i < length; i++) {
 				union tarot_value value = tarot_pop(thread);
 				union tarot_value key = tarot_pop(thread);
+				/* The dict takes ownership of its keys and values */
+				tarot_remove_from_region(thread, key.String);
+				switch (type) {
+					default:
+						break;
+					case TYPE_INTEGER:
+					case TYPE_STRING:
+					case TYPE_LIST:
+					case TYPE_DICT:
+						tarot_remove_from_region(thread, value.Pointer);
+						break;
+				}
 				tarot_dict_insert(&z.Dict, key, value);
 			}
 			tarot_add_to_region(thread, z.Dict);
-			tarot_set_list_datatype(z.Dict, TYPE_STRING);
 			tarot_push(thread, z);
 			break;
 
@@ -958,16 +2185,72 @@ TODO:
 			tarot_push(thread, z);
 			break;
 
-		case OP_FreeDict: {/*
-			enum tarot_datatype type = tarot_read16bit(ip, &ip);
-			for (i = 0; i < tarot_list_length(var->List); i++) {
-				struct dict_item *item = tarot_list_element(var->List, i);
-				tarot_free_string(item->key.String);
-				if (type == TYPE_INTEGER) tarot_free_integer(item->value.Integer);
-				else if (type == TYPE_STRING) tarot_free_string(item->value.String);
-				else if (type == TYPE_RATIONAL) tarot_free_rational(item->value.Rational);
-			}*/
-			/*tarot_free_list(z.List);*/  /* currently still resides within region, would need a StoreList opcode */
+		case OP_FreeDict:
+			tarot_read_argument(ip, &ip); /* value type, the dict knows it as well */
+			tarot_free_dictionary(tarot_pop(thread).Value->Dict);
+			break;
+
+		/*
+		 * MARK: Channel
+		 */
+
+		case OP_PushChannel:
+			type = tarot_read8bit(ip, &ip);
+			length = 0; /* unbounded */
+			if (tarot_read8bit(ip, &ip)) {
+				int32_t capacity = tarot_integer_to_short(tarot_pop(thread).Integer);
+				if (capacity > 0) {
+					length = capacity;
+				}
+			}
+			z.Channel = tarot_create_channel(type, length, vm->num_workers > 1);
+			tarot_add_to_region(thread, z.Channel);
+			tarot_push(thread, z);
+			break;
+
+		case OP_CopyChannel:
+			z.Channel = tarot_share_channel(tarot_pop(thread).Channel);
+			tarot_add_to_region(thread, z.Channel);
+			tarot_push(thread, z);
+			break;
+
+		case OP_StoreChannel:
+			b = tarot_pop(thread);
+			z = tarot_pop(thread);
+			tarot_remove_from_region(thread, z.Channel);
+			tarot_free_channel(b.Value->Channel);
+			*b.Value = z;
+			break;
+
+		case OP_FreeChannel:
+			tarot_free_channel(tarot_pop(thread).Value->Channel);
+			break;
+
+		/* Both leave their operands on the stack until they succeed, a
+		 * parked thread executes the instruction again once woken */
+		case OP_ChannelSend: {
+			union tarot_value *operands = tarot_topptr(thread) - 1;
+			thread->instruction_pointer = ip - 1;
+			if (not send_value(worker, thread, operands[0].Channel, operands[1], *ip)) {
+				return THREAD_PARKED;
+			}
+			ip++;
+			tarot_pop(thread);
+			tarot_pop(thread);
+			break;
+		}
+
+		case OP_ChannelReceive: {
+			bool owned;
+			thread->instruction_pointer = ip - 1;
+			if (not receive_value(worker, thread, tarot_top(thread).Channel, &z, &owned)) {
+				return THREAD_PARKED;
+			}
+			tarot_pop(thread);
+			if (owned) {
+				tarot_add_to_region(thread, z.Pointer);
+			}
+			tarot_push(thread, z);
 			break;
 		}
 
@@ -976,40 +2259,79 @@ TODO:
 		 */
 
 		case OP_PrintBoolean:
-			tarot_fputs(tarot_stdout, tarot_bool_string(tarot_pop(thread).Boolean));
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_fputs(output, tarot_bool_string(tarot_pop(thread).Boolean));
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_PrintInteger:
-			tarot_print_integer(tarot_stdout, tarot_pop(thread).Integer);
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_print_integer(output, tarot_pop(thread).Integer);
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_PrintFloat:
-			tarot_printf("%f", tarot_pop(thread).Float);
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_fprintf(output, "%f", tarot_pop(thread).Float);
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_PrintRational:
-			tarot_print_rational(tarot_stdout, tarot_pop(thread).Rational);
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_print_rational(output, tarot_pop(thread).Rational);
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_PrintString:
-			tarot_print_string(tarot_stdout, tarot_pop(thread).String);
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_print_string(output, tarot_pop(thread).String);
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_PrintList:
-			tarot_print_list(tarot_stdout, tarot_pop(thread).List);
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_print_list(output, tarot_pop(thread).List);
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_PrintDict:
-			tarot_print_dict(tarot_stdout, tarot_pop(thread).Dict);
+			lock(vm->lock);
+			output = open_output(thread);
+			tarot_print_dict(output, tarot_pop(thread).Dict);
+			tarot_fclose(output);
+			unlock(vm->lock);
 			break;
 
 		case OP_NewLine:
-			tarot_newline(tarot_stdout);
+			lock(vm->lock);
+			print_newline(thread);
+			unlock(vm->lock);
 			break;
 
 		case OP_Input: {
+			/* Lets the other threads run before blocking on the input */
+			if (has_ready_threads(worker) and not thread->yielded) {
+				thread->yielded = true;
+				ip--;
+				goto yield;
+			}
+			thread->yielded = false;
+			lock(vm->lock);
 			tarot_print_string(tarot_stdout, tarot_pop(thread).String);
 			z.String = tarot_input_string(tarot_stdin);
+			unlock(vm->lock);
 			tarot_add_to_region(thread, z.String);
 			tarot_push(thread, z);
 			break;
@@ -1019,3 +2341,105 @@ TODO:
 
 	} /* for */
 }
+
+/**
+ * Runs threads until all threads of the virtual machine halted.
+ */
+static void run_worker(void *argument) {
+	struct tarot_worker *worker = argument;
+	struct tarot_virtual_machine *vm = worker->vm;
+	struct tarot_context *previous = tarot_enter_context(worker->context);
+	for (;;) {
+		struct tarot_thread *thread = take_thread(worker);
+		if (thread == NULL) {
+			bool is_done;
+			lock(vm->lock);
+			if (
+				vm->num_threads > 0 and
+				vm->num_threads == vm->num_parked_threads and
+				not vm->is_deadlocked
+			) {
+				tarot_error("Deadlock: All threads are waiting on channels!");
+				vm->is_deadlocked = true;
+			}
+			is_done = vm->num_threads == 0 or vm->is_deadlocked;
+			unlock(vm->lock);
+			if (is_done) {
+				break;
+			}
+			/* The remaining threads are running on other workers */
+			tarot_threading.yield();
+			continue;
+		}
+		switch (run_thread(worker, thread)) {
+			case THREAD_READY:
+				add_ready_thread(worker, thread);
+				break;
+			case THREAD_PARKED:
+				break;
+			case THREAD_HALTED:
+				exit_thread(vm, thread);
+				break;
+		}
+	}
+	tarot_enter_context(previous);
+}
+
+void tarot_attach_executor(struct tarot_virtual_machine *vm) {
+	tarot_attach_workers(vm, 1);
+}
+
+void tarot_attach_workers(struct tarot_virtual_machine *vm, size_t num_workers) {
+	struct tarot_context *previous;
+	void *allocation_lock = NULL;
+	size_t i;
+	assert(vm->num_workers == 1);
+	if (num_workers > 1 and not tarot_has_threading()) {
+		tarot_warning("Threading is not available, running on a single worker!");
+		num_workers = 1;
+	}
+	if (num_workers == 1) {
+		run_worker(&vm->workers[0]);
+		return;
+	}
+
+	/* The other workers get contexts of their own for their scratch buffers,
+	 * sharing the statistics of the context of the machine */
+	previous = tarot_enter_context(vm->context);
+	vm->workers = tarot_realloc(vm->workers, sizeof(*vm->workers) * num_workers);
+	memset(&vm->workers[1], 0, sizeof(*vm->workers) * (num_workers - 1));
+	vm->num_workers = num_workers;
+	vm->lock = tarot_threading.create_mutex();
+	allocation_lock = tarot_threading.create_mutex();
+	tarot_set_allocation_lock(allocation_lock);
+	for (i = 0; i < num_workers; i++) {
+		vm->workers[i].vm = vm;
+		vm->workers[i].index = i;
+		vm->workers[i].lock = tarot_threading.create_mutex();
+		if (i > 0) {
+			vm->workers[i].context = tarot_fork_context();
+		}
+	}
+	for (i = 1; i < num_workers; i++) {
+		vm->workers[i].os_thread = tarot_threading.start(run_worker, &vm->workers[i]);
+	}
+	run_worker(&vm->workers[0]);
+	for (i = 1; i < num_workers; i++) {
+		tarot_threading.join(vm->workers[i].os_thread);
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		tarot_threading.free_mutex(vm->workers[i].lock);
+		vm->workers[i].lock = NULL;
+		if (i > 0) {
+			tarot_free_context(vm->workers[i].context);
+			vm->workers[i].context = vm->context;
+		}
+	}
+	vm->num_workers = 1;
+	tarot_set_allocation_lock(NULL);
+	tarot_threading.free_mutex(allocation_lock);
+	tarot_threading.free_mutex(vm->lock);
+	vm->lock = NULL;
+	tarot_enter_context(previous);
+}
@@ -12,21 +12,38 @@ struct tarot_thread;
 struct tarot_virtual_machine;
 
 /**
- *
+ * Binds a native function to a foreign function for one virtual machine.
  */
-typedef void (*tarot_foreign_function)(struct tarot_thread *thread);
+extern void tarot_register_foreign_function(
+	struct tarot_virtual_machine *vm,
+	const char *name,
+	tarot_foreign_function func
+);
 
 /**
- *
+ * Binds a native function taking its arguments as an array to a foreign
+ * function for one virtual machine.
  */
-extern void tarot_register_foreign_function(
+extern void tarot_register_native_function(
 	struct tarot_virtual_machine *vm,
 	const char *name,
-	tarot_foreign_function func
+	tarot_native_function native
 );
 
 /**
- *
+ * Binds several native functions at once, see tarot_register_foreign_function.
+ */
+extern void tarot_register_foreign_functions(
+	struct tarot_virtual_machine *vm,
+	const struct tarot_foreign_binding *bindings,
+	size_t num_bindings
+);
+
+/**
+ * Creates a virtual machine that runs the bytecode from the start. Once
+ * native functions were bound to the bytecode with
+ * tarot_bind_foreign_functions, all of its foreign functions must be bound.
+ * Otherwise an error is raised for each unbound one and NULL is returned.
  */
 extern struct tarot_virtual_machine* tarot_create_virtual_machine(struct tarot_bytecode *bytecode);
 
@@ -36,17 +53,128 @@ extern struct tarot_virtual_machine* tarot_create_virtual_machine(struct tarot_b
 extern void tarot_free_virtual_machine(struct tarot_virtual_machine *vm);
 
 /**
- *
+ * Runs the threads of a virtual machine until all of them halted. Threads
+ * are green threads that take turns on the calling OS thread: a thread runs
+ * for a time slice of TAROT_TIME_SLICE instructions, or until it would block
+ * on input while other threads are ready.
  */
 extern void tarot_attach_executor(struct tarot_virtual_machine *vm);
 
 /**
- * Executes tarot bytecode on a virtual machine.
+ * Runs the threads of a virtual machine on num_workers OS threads, including
+ * the calling one. Each worker has a queue of ready threads and steals from
+ * the other workers once its queue is empty. Requires the platform to
+ * provide threading, see tarot_initialize_threading().
+ */
+extern void tarot_attach_workers(
+	struct tarot_virtual_machine *vm,
+	size_t num_workers
+);
+
+#ifndef TAROT_TIME_SLICE
+#define TAROT_TIME_SLICE 4096
+#endif
+
+/**
+ * A parallel for loop splits its range into at most TAROT_PARALLEL_CHUNKS
+ * chunks of consecutive iterations. The split does not depend on the number
+ * of workers, so reductions are combined alike on any number of them.
+ */
+#ifndef TAROT_PARALLEL_CHUNKS
+#define TAROT_PARALLEL_CHUNKS 64
+#endif
+
+/**
+ * Raises an error for each foreign function of the virtual machine that no
+ * function is bound to. Returns true if all of them are bound.
+ */
+extern bool tarot_is_fully_bound(struct tarot_virtual_machine *vm);
+
+/**
+ * Executes tarot bytecode on a virtual machine. Nothing is executed if a
+ * foreign function of the bytecode is not bound.
  */
 extern void tarot_execute_bytecode(struct tarot_bytecode *bytecode);
 
 /**
- * The arguments must be passed as instances of union tarot_value!
+ * A pool of virtual machines that run the same bytecode, for hosts that run
+ * a program over and over again. A released machine keeps its threads and
+ * stacks, so acquiring it again allocates nothing. The foreign functions
+ * are bound once for all machines of the pool.
+ */
+struct tarot_virtual_machine_pool;
+
+/**
+ * Creates an empty pool for the bytecode, which must outlive the pool. The
+ * pool starts out with the native functions bound to the bytecode.
+ */
+extern struct tarot_virtual_machine_pool* tarot_create_virtual_machine_pool(
+	struct tarot_bytecode *bytecode
+);
+
+/**
+ * Frees a pool and its machines. All machines must have been released.
+ */
+extern void tarot_free_virtual_machine_pool(
+	struct tarot_virtual_machine_pool *pool
+);
+
+/**
+ * Binds a foreign function for all machines of the pool.
+ */
+extern void tarot_register_pool_function(
+	struct tarot_virtual_machine_pool *pool,
+	const char *name,
+	tarot_foreign_function func
+);
+
+/**
+ * Binds a native function taking its arguments as an array for all machines
+ * of the pool.
+ */
+extern void tarot_register_pool_native_function(
+	struct tarot_virtual_machine_pool *pool,
+	const char *name,
+	tarot_native_function native
+);
+
+/**
+ * Returns an idle machine of the pool, or a new one if all of them are in
+ * use, ready to run the program from the start in the current context.
+ * Pools can be shared by OS threads if threading is initialized. Returns
+ * NULL if a foreign function of the bytecode is not bound.
+ */
+extern struct tarot_virtual_machine* tarot_acquire_virtual_machine(
+	struct tarot_virtual_machine_pool *pool
+);
+
+/**
+ * Returns a machine to its pool once it was run, or instead of running it.
+ */
+extern void tarot_release_virtual_machine(struct tarot_virtual_machine *vm);
+
+/**
+ * Calls a function of the program with the given arguments. Runs on the
+ * calling OS thread until all threads of the virtual machine halted,
+ * including the threads that were ready before the call. The function is
+ * looked up once with tarot_lookup_function, the arguments are borrowed from
+ * the caller. Returns true once the function returned, its return value is
+ * stored in result and then belongs to the caller. Result may be NULL if the
+ * function returns nothing. Returns false if the function raised an
+ * exception it did not catch, or failed otherwise. Its values are freed
+ * then and result is left untouched.
+ */
+extern bool tarot_invoke_function(
+	struct tarot_virtual_machine *vm,
+	struct tarot_function *function,
+	const union tarot_value *arguments,
+	union tarot_value *result
+);
+
+/**
+ * Looks up a function by its name and calls it with tarot_invoke_function.
+ * The arguments must be passed as instances of union tarot_value! Returns
+ * a zeroed value if the function failed.
  */
 extern union tarot_value tarot_call_function(
 	struct tarot_virtual_machine *vm,
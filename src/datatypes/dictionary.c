@@ -13,13 +13,78 @@ struct tarot_list* tarot_create_dictionary() {
 	return dict;
 }
 
+static union tarot_value copy_item_value(union tarot_value value, enum tarot_datatype type) {
+	switch (type) {
+		default:
+			break;
+		case TYPE_DICT:
+			value.Dict = tarot_copy_dict(value.Dict);
+			break;
+		case TYPE_INTEGER:
+			value.Integer = tarot_copy_integer(value.Integer);
+			break;
+		case TYPE_LIST:
+			value.List = tarot_share_list(value.List);
+			break;
+		case TYPE_RATIONAL:
+			value.Rational = tarot_copy_rational(value.Rational);
+			break;
+		case TYPE_STRING:
+			value.String = tarot_share_string(value.String);
+			break;
+	}
+	return value;
+}
+
+static void free_item_value(union tarot_value value, enum tarot_datatype type) {
+	switch (type) {
+		default:
+			break;
+		case TYPE_DICT:
+			tarot_free_dictionary(value.Dict);
+			break;
+		case TYPE_INTEGER:
+			tarot_free_integer(value.Integer);
+			break;
+		case TYPE_LIST:
+			tarot_free_list(value.List);
+			break;
+		case TYPE_RATIONAL:
+			tarot_free_rational(value.Rational);
+			break;
+		case TYPE_STRING:
+			tarot_free_string(value.String);
+			break;
+	}
+}
+
 struct tarot_list* tarot_copy_dict(struct tarot_list *dict) {
-	return tarot_copy_list(dict);
+	enum tarot_datatype type = tarot_get_list_datatype(dict);
+	struct tarot_list *copy = tarot_create_dictionary();
+	size_t i;
+	tarot_set_list_datatype(copy, type);
+	for (i = 0; i < tarot_list_length(dict); i++) {
+		struct dict_item *item = tarot_list_element(dict, i);
+		union tarot_value key, value;
+		key.String = tarot_share_string(item->key.String);
+		value = copy_item_value(item->value, type);
+		tarot_dict_insert(&copy, key, value);
+	}
+	return copy;
 }
 
+/* The dict owns its keys and values, the list datatype is the value type */
 void tarot_free_dictionary(struct tarot_list *dict) {
-	/* FIXME: since dict list is tagged with subtype, it attempts to free said type and not the struct dict_item */
-	tarot_free_list(dict);
+	if (dict != NULL) {
+		enum tarot_datatype type = tarot_get_list_datatype(dict);
+		size_t i;
+		for (i = 0; i < tarot_list_length(dict); i++) {
+			struct dict_item *item = tarot_list_element(dict, i);
+			tarot_free_string(item->key.String);
+			free_item_value(item->value, type);
+		}
+		tarot_free(dict);
+	}
 }
 
 bool tarot_dict_contains(struct tarot_list *dict, union tarot_value key) {
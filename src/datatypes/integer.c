@@ -83,15 +83,27 @@ TAROT_INLINE
 struct tarot_string* tarot_integer_to_string(
 	tarot_integer *integer
 ) {
-	struct tarot_string *string = NULL;
-	char *strptr;
+	struct tarot_string *string = tarot_create_string(NULL);
+	char *text;
 	assert(integer != NULL);
-	strptr = mpz_get_str(NULL, 10, integer);
-	string = tarot_create_string(strptr);
-	tarot_free(strptr);
+	text = tarot_string_reserve(&string, tarot_integer_text_size(integer));
+	tarot_integer_to_text(integer, text);
+	tarot_string_commit(string, strlen(text));
 	return string;
 }
 
+TAROT_INLINE
+size_t tarot_integer_text_size(tarot_integer *integer) {
+	assert(integer != NULL);
+	return mpz_sizeinbase(integer, 10) + 2; /* sign and terminator */
+}
+
+TAROT_INLINE
+char* tarot_integer_to_text(tarot_integer *integer, char *buffer) {
+	assert(integer != NULL);
+	return mpz_get_str(buffer, 10, integer);
+}
+
 TAROT_INLINE
 double tarot_integer_to_float(tarot_integer *integer) {
 	assert(integer != NULL);
@@ -189,6 +201,56 @@ tarot_integer* tarot_exponentiate_integers(
 	return result;
 }
 
+TAROT_INLINE
+void tarot_add_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpz_add(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_subtract_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpz_sub(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_multiply_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpz_mul(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_divide_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpz_tdiv_q(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_modulo_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpz_mod(a, a, b);
+}
+
 TAROT_INLINE
 int tarot_compare_integers(
 	tarot_integer *a,
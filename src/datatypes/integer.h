@@ -31,6 +31,13 @@ extern struct tarot_string* tarot_integer_to_string(
 	tarot_integer *integer
 );
 
+/**
+ * Writes the decimal digits of the integer as a C-string to the buffer,
+ * which must be at least tarot_integer_text_size(integer) bytes large.
+ */
+extern size_t tarot_integer_text_size(tarot_integer *integer);
+extern char* tarot_integer_to_text(tarot_integer *integer, char *buffer);
+
 extern double tarot_integer_to_float(tarot_integer *integer);
 extern bool tarot_integer_fits_short(tarot_integer *integer);
 extern int32_t tarot_integer_to_short(tarot_integer *integer);
@@ -63,6 +70,28 @@ extern int tarot_compare_integers(
 	tarot_integer *b
 );
 
+/* In-place variants: The result is written to a, no allocation is made */
+extern void tarot_add_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+);
+extern void tarot_subtract_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+);
+extern void tarot_multiply_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+);
+extern void tarot_divide_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+);
+extern void tarot_modulo_integers_in_place(
+	tarot_integer *a,
+	tarot_integer *b
+);
+
 extern tarot_integer* tarot_integer_negate(tarot_integer *integer);
 extern size_t tarot_sizeof_integer(tarot_integer *integer);
 extern tarot_integer* tarot_import_integer(
@@ -56,12 +56,52 @@ struct tarot_list* tarot_copy_list(struct tarot_list *list) {
 				valptr->Integer = tarot_copy_integer(value->Integer);
 			}
 			break;
+		case TYPE_RATIONAL:
+			for (i = 0; i < list->length; i++) {
+				union tarot_value *value = tarot_list_element(list, i);
+				union tarot_value *valptr = tarot_list_element(copy, i);
+				valptr->Rational = tarot_copy_rational(value->Rational);
+			}
+			break;
+		case TYPE_STRING:
+			for (i = 0; i < list->length; i++) {
+				union tarot_value *value = tarot_list_element(list, i);
+				union tarot_value *valptr = tarot_list_element(copy, i);
+				valptr->String = tarot_share_string(value->String);
+			}
+			break;
+		case TYPE_LIST:
+			for (i = 0; i < list->length; i++) {
+				union tarot_value *value = tarot_list_element(list, i);
+				union tarot_value *valptr = tarot_list_element(copy, i);
+				valptr->List = tarot_share_list(value->List);
+			}
+			break;
 	}
 	return copy;
 }
 
+struct tarot_list* tarot_share_list(struct tarot_list *list) {
+#ifdef TAROT_COPY_ON_WRITE
+	return tarot_retain(list);
+#else
+	return tarot_copy_list(list);
+#endif
+}
+
+/* Gives the list pointed to by listptr a representation of its own */
+static struct tarot_list* unshare_list(struct tarot_list **listptr) {
+	struct tarot_list *list = *listptr;
+	if (tarot_is_shared(list)) {
+		list = tarot_copy_list(list);
+		tarot_free_list(*listptr);
+		*listptr = list;
+	}
+	return list;
+}
+
 void tarot_free_list(struct tarot_list *list) {
-	if (list != NULL) {
+	if (list != NULL and tarot_release(list)) {
 		size_t i;
 		for (i = 0; i < list->length; i++) {
 			union tarot_value *value = tarot_list_element(list, i);
@@ -111,7 +151,7 @@ void tarot_clear_list(struct tarot_list *list) {
 }
 
 static void extend_list(struct tarot_list **listptr, size_t n) {
-	struct tarot_list *list = *listptr;
+	struct tarot_list *list = unshare_list(listptr);
 	assert(n > 0);
 	list->capacity += n;
 	list = tarot_realloc(list, sizeof(*list) + list->capacity * list->objsize);
@@ -119,7 +159,7 @@ static void extend_list(struct tarot_list **listptr, size_t n) {
 }
 
 static void shrink_list(struct tarot_list **listptr, size_t n) {
-	struct tarot_list *list = *listptr;
+	struct tarot_list *list = unshare_list(listptr);
 	assert(n < list->capacity);
 	if (n > 0) {
 		list->capacity -= n;
@@ -135,7 +175,8 @@ void tarot_trim_list(struct tarot_list **listptr) {
 	}
 }
 
-void tarot_reverse_list(struct tarot_list *list) {
+void tarot_reverse_list(struct tarot_list **listptr) {
+	struct tarot_list *list = unshare_list(listptr);
 	size_t index;
 	uint8_t *buffer = tarot_malloc(list->objsize);
 	for (index = 0; index < list->length; index++) {
@@ -149,7 +190,7 @@ void tarot_reverse_list(struct tarot_list *list) {
 }
 
 void tarot_list_append(struct tarot_list **listptr, void *object) {
-	struct tarot_list *list = *listptr;
+	struct tarot_list *list = unshare_list(listptr);
 	assert(object != NULL);
 	if (list->length >= list->capacity) {
 		extend_list(listptr, list->length * 2 + 1);
@@ -166,7 +207,7 @@ void tarot_list_append(struct tarot_list **listptr, void *object) {
 }
 
 void tarot_list_pop(struct tarot_list **listptr, void *object) {
-	struct tarot_list *list = *listptr;
+	struct tarot_list *list = unshare_list(listptr);
 	assert(list->length > 0);
 	if (object != NULL) {
 		memcpy(
@@ -183,7 +224,7 @@ void tarot_list_insert(
 	size_t index,
 	void *object
 ) {
-	struct tarot_list *list = *listptr;
+	struct tarot_list *list = unshare_list(listptr);
 	void *destination;
 	void *source;
 	list->length++;
@@ -194,7 +235,7 @@ void tarot_list_insert(
 	if (index < list->length) {
 		memmove(destination, source, (list->length - index) * list->objsize);
 	}
-	tarot_list_replace(list, index, object);
+	tarot_list_replace(listptr, index, object);
 }
 
 bool tarot_list_contains(struct tarot_list *list, void *object) {
@@ -208,7 +249,7 @@ bool tarot_list_contains(struct tarot_list *list, void *object) {
 }
 
 void tarot_list_remove(struct tarot_list **listptr, size_t index) {
-	struct tarot_list *list = *listptr;
+	struct tarot_list *list = unshare_list(listptr);
 	void *destination = tarot_list_element(list, index);
 	void *source = (uint8_t*)destination + list->objsize;
 	assert(list->length > 0);
@@ -224,6 +265,10 @@ void* tarot_list_element(struct tarot_list *list, size_t index) {
 	return (uint8_t*)data_of(list) + list->objsize * index;
 }
 
+void* tarot_list_writable_element(struct tarot_list **listptr, size_t index) {
+	return tarot_list_element(unshare_list(listptr), index);
+}
+
 bool tarot_list_find(
 	struct tarot_list *list,
 	void *object,
@@ -252,10 +297,11 @@ size_t tarot_list_lookup(struct tarot_list *list, void *object) {
 }
 
 void tarot_list_replace(
-	struct tarot_list *list,
+	struct tarot_list **listptr,
 	size_t index,
 	void *object
 ) {
+	struct tarot_list *list = unshare_list(listptr);
 	memcpy(tarot_list_element(list, index), object, list->objsize);
 }
 
@@ -13,13 +13,16 @@ extern struct tarot_list* tarot_create_list(
 	bool (*match)(void *element, void *object)
 );
 extern struct tarot_list* tarot_copy_list(struct tarot_list *list);
+/* Like tarot_copy_list, but shares the elements until either list is modified
+ * through a list pointer when built with TAROT_COPY_ON_WRITE */
+extern struct tarot_list* tarot_share_list(struct tarot_list *list);
 extern void tarot_free_list(struct tarot_list *list);
 extern void tarot_clear_list(struct tarot_list *list);
 extern void* tarot_list_to_array(struct tarot_list *list);
 extern size_t tarot_list_length(struct tarot_list *list);
 extern size_t tarot_list_objsize(struct tarot_list *list);
 extern void tarot_trim_list(struct tarot_list **list);
-extern void tarot_reverse_list(struct tarot_list *list);
+extern void tarot_reverse_list(struct tarot_list **list);
 extern void tarot_list_append(struct tarot_list **list, void *object);
 extern void tarot_list_pop(struct tarot_list **list, void *object);
 extern void tarot_list_insert(
@@ -30,6 +33,9 @@ extern void tarot_list_insert(
 extern bool tarot_list_contains(struct tarot_list *list, void *object);
 extern void tarot_list_remove(struct tarot_list **list, size_t index);
 extern void* tarot_list_element(struct tarot_list *list, size_t index);
+/* Like tarot_list_element, but unshares the list first as the element is
+ * about to be written to */
+extern void* tarot_list_writable_element(struct tarot_list **list, size_t index);
 extern bool tarot_list_find(
 	struct tarot_list *list,
 	void *object,
@@ -37,7 +43,7 @@ extern bool tarot_list_find(
 );
 extern size_t tarot_list_lookup(struct tarot_list *list, void *object);
 extern void tarot_list_replace(
-	struct tarot_list *list,
+	struct tarot_list **list,
 	size_t index,
 	void *object
 );
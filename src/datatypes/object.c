@@ -29,9 +29,18 @@ void tarot_free_object(struct tarot_object *object) {
 			case TYPE_STRING:
 				tarot_free_string(attribute->String);
 				break;
+			case TYPE_RATIONAL:
+				tarot_free_rational(attribute->Rational);
+				break;
 			case TYPE_LIST:
 				tarot_free_list(attribute->List);
 				break;
+			case TYPE_DICT:
+				tarot_free_dictionary(attribute->Dict);
+				break;
+			case TYPE_CHANNEL:
+				tarot_free_channel(attribute->Channel);
+				break;
 			case TYPE_CUSTOM:
 				tarot_free_object(attribute->Object);
 				break;
@@ -40,6 +49,42 @@ void tarot_free_object(struct tarot_object *object) {
 	tarot_free(object);
 }
 
+struct tarot_object* tarot_copy_object(struct tarot_object *object) {
+	struct tarot_object *copy = tarot_create_object(object->num_attributes);
+	unsigned int i;
+	for (i = 0; i < object->num_attributes; i++) {
+		union tarot_value *attribute = &object->attributes[i];
+		union tarot_value *value = &copy->attributes[i];
+		switch (header_of(attribute->Pointer)->type) {
+			default:
+				*value = *attribute;
+				break;
+			case TYPE_INTEGER:
+				value->Integer = tarot_copy_integer(attribute->Integer);
+				break;
+			case TYPE_RATIONAL:
+				value->Rational = tarot_copy_rational(attribute->Rational);
+				break;
+			case TYPE_STRING:
+				value->String = tarot_copy_string(attribute->String);
+				break;
+			case TYPE_LIST:
+				value->List = tarot_copy_list(attribute->List);
+				break;
+			case TYPE_DICT:
+				value->Dict = tarot_copy_dict(attribute->Dict);
+				break;
+			case TYPE_CHANNEL:
+				value->Channel = tarot_share_channel(attribute->Channel);
+				break;
+			case TYPE_CUSTOM:
+				value->Object = tarot_copy_object(attribute->Object);
+				break;
+		}
+	}
+	return copy;
+}
+
 union tarot_value* tarot_object_attribute(
 	struct tarot_object *object,
 	unsigned int index
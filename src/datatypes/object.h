@@ -15,6 +15,11 @@ extern struct tarot_object* tarot_create_object(unsigned int n);
  */
 extern void tarot_free_object(struct tarot_object *object);
 
+/**
+ * Copies an object along with the values of its attributes.
+ */
+extern struct tarot_object* tarot_copy_object(struct tarot_object *object);
+
 /**
  *
  */
@@ -4,6 +4,7 @@
 TAROT_INLINE
 tarot_rational* tarot_create_rational(void) {
 	tarot_rational *rational = tarot_malloc(sizeof(mpq_t));
+	tarot_tag(rational, TYPE_RATIONAL);
 	tarot_initialize_rational(rational);
 	return rational;
 }
@@ -89,11 +90,25 @@ TAROT_INLINE
 struct tarot_string* tarot_rational_to_string(
 	tarot_rational *rational
 ) {
-	struct tarot_string *result;
-	char *str = mpq_get_str(NULL, 10, rational);
-	result = tarot_create_string(str);
-	tarot_free(str);
-	return result;
+	struct tarot_string *string = tarot_create_string(NULL);
+	char *text = tarot_string_reserve(&string, tarot_rational_text_size(rational));
+	tarot_rational_to_text(rational, text);
+	tarot_string_commit(string, strlen(text));
+	return string;
+}
+
+TAROT_INLINE
+size_t tarot_rational_text_size(tarot_rational *rational) {
+	return (
+		mpz_sizeinbase(mpq_numref((mpq_ptr)rational), 10)
+		+ mpz_sizeinbase(mpq_denref((mpq_ptr)rational), 10)
+		+ 3 /* sign, slash and terminator */
+	);
+}
+
+TAROT_INLINE
+char* tarot_rational_to_text(tarot_rational *rational, char *buffer) {
+	return mpq_get_str(buffer, 10, rational);
 }
 
 TAROT_INLINE
@@ -159,6 +174,46 @@ tarot_rational* tarot_exponentiate_rationals(
 	);
 }
 
+TAROT_INLINE
+void tarot_add_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpq_add(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_subtract_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpq_sub(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_multiply_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpq_mul(a, a, b);
+}
+
+TAROT_INLINE
+void tarot_divide_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+) {
+	assert(a != NULL);
+	assert(b != NULL);
+	mpq_div(a, a, b);
+}
+
 TAROT_INLINE
 int tarot_compare_rationals(
 	tarot_rational *a,
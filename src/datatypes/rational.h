@@ -38,6 +38,13 @@ extern struct tarot_string* tarot_rational_to_string(
 	tarot_rational *rational
 );
 
+/**
+ * Writes the rational as a C-string of the form numerator/denominator to the
+ * buffer, which must be at least tarot_rational_text_size(rational) bytes.
+ */
+extern size_t tarot_rational_text_size(tarot_rational *rational);
+extern char* tarot_rational_to_text(tarot_rational *rational, char *buffer);
+
 extern double tarot_rational_to_float(tarot_rational *rational);
 extern int32_t tarot_rational_to_short(tarot_rational *rational);
 extern tarot_rational* tarot_add_rationals(
@@ -70,6 +77,24 @@ extern int tarot_compare_rationals(
 	tarot_rational *b
 );
 
+/* In-place variants: The result is written to a, no allocation is made */
+extern void tarot_add_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+);
+extern void tarot_subtract_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+);
+extern void tarot_multiply_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+);
+extern void tarot_divide_rationals_in_place(
+	tarot_rational *a,
+	tarot_rational *b
+);
+
 extern tarot_rational* tarot_rational_negate(tarot_rational *z);
 extern size_t tarot_sizeof_rational(tarot_rational *z);
 extern tarot_rational* tarot_import_rational(uint8_t *buffer);
@@ -1,51 +1,71 @@
 #define TAROT_SOURCE
 #include "tarot.h"
 
-struct tarot_string {
-	char *text;
-	size_t length;
-	size_t capacity;
-	size_t num_characters;
-};
+TAROT_INLINE
+static char* text_of(const struct tarot_string *string) {
+	if (string->text != NULL) return string->text;
+	return end_of_struct(string);
+}
 
-static struct tarot_string* tarot_allocate_string(size_t capacity) {
-	struct tarot_string *string = tarot_malloc(sizeof(*string) + capacity);
+TAROT_INLINE
+size_t tarot_string_size(size_t capacity) {
+	return sizeof(struct tarot_string) + capacity;
+}
+
+struct tarot_string* tarot_place_string(void *memory, size_t capacity) {
+	struct tarot_string *string = memory;
+	string->text = NULL;
+	string->length = 0;
 	string->capacity = capacity;
+	string->num_characters = 0;
+	if (capacity > 0) {
+		text_of(string)[0] = '\0';
+	}
 	tarot_tag(string, TYPE_STRING);
 	return string;
 }
 
+static struct tarot_string* tarot_allocate_string(size_t capacity) {
+	return tarot_place_string(tarot_malloc(tarot_string_size(capacity)), capacity);
+}
+
 struct tarot_string* tarot_create_string(const char *format, ...) {
-	struct tarot_string *string = tarot_allocate_string(8);
-	if (format != NULL) {
-		struct tarot_iostream *stream = tarot_fstropen(&string, TAROT_OUTPUT);
-		va_list ap;
+	struct tarot_string *string;
+	char buffer[64];
+	size_t length;
+	va_list ap;
+	if (format == NULL) {
+		return tarot_allocate_string(8);
+	}
+
+	/* Short texts are formatted on the stack, so the string is sized once */
+	va_start(ap, format);
+	length = tarot_vformat(buffer, sizeof(buffer), format, &ap);
+	va_end(ap);
 
+	string = tarot_allocate_string(length < 8 ? 8 : length + 1);
+	if (length < sizeof(buffer)) {
+		memcpy(text_of(string), buffer, length);
+	} else {
 		va_start(ap, format);
-		tarot_vfprintf(stream, format, &ap);
+		tarot_vformat(text_of(string), string->capacity, format, &ap);
 		va_end(ap);
-		tarot_fclose(stream);
 	}
+	tarot_string_commit(string, length);
 	return string;
 }
 
 struct tarot_string* tarot_const_string(const char *text) {
-	static struct tarot_string circular_string_buffer[8];
-	static uint8_t length = lengthof(circular_string_buffer);
-	static uint8_t index = 0;
-	struct tarot_string *string = &circular_string_buffer[index++ % length];
+	struct tarot_context *context = tarot_current_context();
+	struct tarot_string *string = &context->const_strings[
+		context->const_string_index++ % lengthof(context->const_strings)
+	];
 	string->text = (char*)text;
 	string->capacity = string->length = strlen(text);
 	string->num_characters = string->length;
 	return string;
 }
 
-TAROT_INLINE
-static char* text_of(const struct tarot_string *string) {
-	if (string->text != NULL) return string->text;
-	return end_of_struct(string);
-}
-
 struct tarot_string* tarot_copy_string(struct tarot_string *string) {
 	struct tarot_string *copy = tarot_allocate_string(string->capacity);
 	copy->length = string->length;
@@ -54,6 +74,107 @@ struct tarot_string* tarot_copy_string(struct tarot_string *string) {
 	return copy;
 }
 
+struct tarot_string* tarot_share_string(struct tarot_string *string) {
+#ifdef TAROT_COPY_ON_WRITE
+	return tarot_retain(string);
+#else
+	return tarot_copy_string(string);
+#endif
+}
+
+/* Hashes the text (FNV-1a) */
+static size_t hash_text(const char *text, size_t length) {
+	size_t hash = 2166136261U;
+	size_t i;
+	for (i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned char)text[i]) * 16777619U;
+	}
+	return hash;
+}
+
+/* Returns the slot of the interned string with that text or an empty one */
+static struct tarot_string** find_interned(
+	struct tarot_interned_strings *interned,
+	const char *text,
+	size_t length
+) {
+	size_t mask = interned->capacity - 1;
+	size_t i = hash_text(text, length) & mask;
+	struct tarot_string *string;
+	while ((string = interned->slots[i]) != NULL) {
+		if (
+			string->length == length and
+			strncmp(text_of(string), text, length) == 0
+		) {
+			break;
+		}
+		i = (i + 1) & mask;
+	}
+	return &interned->slots[i];
+}
+
+static void grow_interned(struct tarot_interned_strings *interned) {
+	struct tarot_string **slots = interned->slots;
+	size_t capacity = interned->capacity;
+	size_t i;
+	interned->capacity = capacity > 0 ? capacity * 2 : 256;
+	interned->slots = tarot_malloc(sizeof(*slots) * interned->capacity);
+	for (i = 0; i < capacity; i++) {
+		if (slots[i] != NULL) {
+			*find_interned(interned, text_of(slots[i]), slots[i]->length) = slots[i];
+		}
+	}
+	tarot_free(slots);
+}
+
+struct tarot_string* tarot_intern_text(const char *text, size_t length) {
+	struct tarot_interned_strings *interned = &tarot_root_context()->interned;
+	struct tarot_string **slot;
+	assert(text != NULL);
+	if ((interned->length + 1) * 2 > interned->capacity) {
+		grow_interned(interned);
+	}
+	slot = find_interned(interned, text, length);
+	if (*slot == NULL) {
+		*slot = tarot_allocate_string(length + 1);
+		memcpy(text_of(*slot), text, length);
+		tarot_string_commit(*slot, length);
+		interned->length++;
+	}
+	return tarot_retain(*slot);
+}
+
+struct tarot_string* tarot_intern_string(struct tarot_string *string) {
+	struct tarot_string *result;
+	assert(string != NULL);
+	result = tarot_intern_text(text_of(string), string->length);
+	tarot_free_string(string);
+	return result;
+}
+
+void tarot_free_interned_strings(void) {
+	struct tarot_interned_strings *interned = &tarot_root_context()->interned;
+	size_t i;
+	for (i = 0; i < interned->capacity; i++) {
+		tarot_free_string(interned->slots[i]);
+	}
+	tarot_free(interned->slots);
+	interned->slots = NULL;
+	interned->capacity = 0;
+	interned->length = 0;
+}
+
+/* Gives the string pointed to by stringptr a representation of its own */
+static struct tarot_string* unshare_string(struct tarot_string **stringptr) {
+	struct tarot_string *string = *stringptr;
+	if (tarot_is_shared(string)) {
+		string = tarot_copy_string(string);
+		tarot_release(*stringptr);
+		*stringptr = string;
+	}
+	return string;
+}
+
 void tarot_clear_string(struct tarot_string *string) {
 	memset(text_of(string), 0, string->length);
 	string->length = 0;
@@ -61,7 +182,9 @@ void tarot_clear_string(struct tarot_string *string) {
 }
 
 void tarot_free_string(struct tarot_string *string) {
-	tarot_free(string);
+	if (string != NULL and tarot_release(string)) {
+		tarot_free(string);
+	}
 }
 
 char* tarot_string_to_cstring(struct tarot_string *string) {
@@ -94,7 +217,7 @@ static struct tarot_string* resize_string(
 	struct tarot_string **stringptr,
 	size_t size
 ) {
-	struct tarot_string *string = *stringptr;
+	struct tarot_string *string = unshare_string(stringptr);
 	if (string->capacity < size or (string->capacity / 2 > size)) {
 		string = tarot_realloc(string, sizeof(*string) + size);
 		string->capacity = size;
@@ -107,7 +230,7 @@ static struct tarot_string* extend_string(
 	struct tarot_string **stringptr,
 	size_t n
 ) {
-	struct tarot_string *string = *stringptr;
+	struct tarot_string *string = unshare_string(stringptr);
 	if ((string->length + n) >= string->capacity) {
 		string->capacity = 2 * (string->length + n);
 		string = tarot_realloc(string, sizeof(*string) + string->capacity);
@@ -116,29 +239,40 @@ static struct tarot_string* extend_string(
 	return string;
 }
 
+/* Formats into the spare capacity of the string, see tarot_vformat */
+static size_t format_spare(
+	struct tarot_string *string,
+	const char *format,
+	va_list *ap
+) {
+	return tarot_vformat(
+		text_of(string) + string->length,
+		string->capacity - string->length,
+		format,
+		ap
+	);
+}
+
 void tarot_string_append(
 	struct tarot_string **stringptr,
 	const char *format, ...
 ) {
-	struct tarot_string *string = *stringptr;
-	struct tarot_iostream *stream;
+	struct tarot_string *string = unshare_string(stringptr);
 	size_t length;
 	va_list ap;
 
 	va_start(ap, format);
-	length = tarot_vfstrlen(format, &ap);
-	va_end(ap);
-
-	string = extend_string(stringptr, length);
-	stream = tarot_fmemopen(text_of(string) + string->length, TAROT_OUTPUT);
-
-	va_start(ap, format);
-	tarot_vfprintf(stream, format, &ap);
+	length = format_spare(string, format, &ap);
 	va_end(ap);
-	tarot_fclose(stream);
 
-	string->num_characters += strlen_utf8(text_of(string) + string->length);
-	string->length += length;
+	/* Formats a second time only if the spare capacity was too small */
+	if (length >= string->capacity - string->length) {
+		string = extend_string(stringptr, length);
+		va_start(ap, format);
+		format_spare(string, format, &ap);
+		va_end(ap);
+	}
+	tarot_string_commit(string, length);
 }
 
 void tarot_string_insert(
@@ -173,7 +307,7 @@ void tarot_string_remove(
 	size_t index,
 	size_t n
 ) {
-	struct tarot_string *string = *stringptr;
+	struct tarot_string *string = unshare_string(stringptr);
 	size_t length;
 	assert(index + n < string->length); /* Out of bounds? */
 	string->length -= n;
@@ -206,6 +340,29 @@ struct tarot_string* tarot_concat_strings(
 	return result;
 }
 
+void tarot_extend_string(
+	struct tarot_string **stringptr,
+	const struct tarot_string *b
+) {
+	struct tarot_string *string = extend_string(stringptr, b->length);
+	memmove(text_of(string) + string->length, text_of(b), b->length);
+	string->length += b->length;
+	string->num_characters += b->num_characters;
+	text_of(string)[string->length] = '\0';
+}
+
+char* tarot_string_reserve(struct tarot_string **stringptr, size_t n) {
+	struct tarot_string *string = extend_string(stringptr, n);
+	return text_of(string) + string->length;
+}
+
+void tarot_string_commit(struct tarot_string *string, size_t n) {
+	char *text = text_of(string) + string->length;
+	text[n] = '\0';
+	string->num_characters += strlen_utf8(text);
+	string->length += n;
+}
+
 void tarot_reverse_string(struct tarot_string *string) {
 	strrev(text_of(string));
 }
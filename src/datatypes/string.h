@@ -27,6 +27,46 @@ extern struct tarot_string* tarot_const_string(const char *text);
  */
 extern struct tarot_string* tarot_copy_string(struct tarot_string *string);
 
+/**
+ * Creates a copy of the given string like tarot_copy_string. Built with
+ * TAROT_COPY_ON_WRITE both strings share their text until either one is
+ * modified through a function taking a string pointer, which then copies.
+ */
+extern struct tarot_string* tarot_share_string(struct tarot_string *string);
+
+/**
+ * Returns the interned string of the given text, creating it on first use.
+ * Interned strings of equal text are the very same object and can thus be
+ * compared by pointer. Every call hands out a reference of its own, which
+ * is dropped with tarot_free_string as usual. Interned strings must not be
+ * modified in place, functions taking a string pointer copy them first.
+ */
+extern struct tarot_string* tarot_intern_text(const char *text, size_t length);
+
+/**
+ * Interns the text of the string and drops the given string.
+ */
+extern struct tarot_string* tarot_intern_string(struct tarot_string *string);
+
+/**
+ * Releases the intern table of the current context. Interned strings still
+ * referenced elsewhere live on as ordinary shared strings.
+ */
+extern void tarot_free_interned_strings(void);
+
+/**
+ * Returns the number of bytes a string of the given capacity occupies.
+ */
+extern size_t tarot_string_size(size_t capacity);
+
+/**
+ * Creates an empty string of the given capacity in the given block of
+ * memory, which must be at least tarot_string_size(capacity) bytes large.
+ * Used for strings living in scratch memory, which may not grow beyond
+ * their capacity and are never freed on their own.
+ */
+extern struct tarot_string* tarot_place_string(void *memory, size_t capacity);
+
 /**
  * Clears the string. Resets length to 0, and erases the text.
  */
@@ -114,6 +154,24 @@ extern struct tarot_string* tarot_concat_strings(
 	const struct tarot_string *b
 );
 
+/**
+ * Appends string b to the string pointed to by stringptr. Unlike
+ * tarot_concat_strings no new string is created, the spare capacity
+ * of the target is reused and it only grows when exhausted.
+ */
+extern void tarot_extend_string(
+	struct tarot_string **stringptr,
+	const struct tarot_string *b
+);
+
+/**
+ * Makes room for at least n more bytes at the end of the string and returns
+ * a pointer to them. Text written there becomes part of the string once
+ * tarot_string_commit is called with the number of bytes written.
+ */
+extern char* tarot_string_reserve(struct tarot_string **stringptr, size_t n);
+extern void tarot_string_commit(struct tarot_string *string, size_t n);
+
 /**
  * Reverses the order of the characters in the string
  */
@@ -185,4 +243,23 @@ extern void tarot_export_string(void *buffer, struct tarot_string *string);
  */
 extern struct tarot_string* tarot_input_string(struct tarot_iostream *stream);
 
+/* Only available to tarot source files */
+#ifdef TAROT_SOURCE
+
+struct tarot_string {
+	char *text;
+	size_t length;
+	size_t capacity;
+	size_t num_characters;
+};
+
+/* Open addressing hash set of all interned strings, grown at half load */
+struct tarot_interned_strings {
+	struct tarot_string **slots;
+	size_t capacity;
+	size_t length;
+};
+
+#endif /* TAROT_SOURCE */
+
 #endif /* TAROT_TYPE_STRING_H */
@@ -8,6 +8,7 @@ struct tarot_dictionary;
 struct tarot_list;
 struct tarot_string;
 struct tarot_object;
+struct tarot_channel;
 
 union tarot_value {
 	bool                     Boolean;
@@ -20,6 +21,7 @@ union tarot_value {
 	struct tarot_list       *List;
 	struct tarot_string     *String;
 	struct tarot_object     *Object;
+	struct tarot_channel    *Channel;
 	union tarot_value       *Value;
 };
 
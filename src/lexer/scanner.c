@@ -14,101 +14,151 @@ void tarot_set_max_indentation(size_t value) {
 	max_indentation = value;
 }
 
-static bool line_is_too_long(struct tarot_iostream *stream) {
-	return tarot_fgetpos(stream)->column == max_line_length;
-}
-
-static bool line_is_overindented(struct tarot_iostream *stream) {
-	return tarot_fcurr(stream) == '\t' and tarot_stream_indentation(stream) > max_indentation;
+TAROT_INLINE
+static int current(const struct tarot_scanner *scanner) {
+	return scanner->source[scanner->offset];
 }
 
-static bool line_has_mixed_indentation(struct tarot_iostream *stream) {
-	return (
-		tarot_fcurr(stream) == '\t' and
-		tarot_fgetpos(stream)->column > (tarot_stream_indentation(stream) + 1)
-	);
+TAROT_INLINE
+static bool at_end(const struct tarot_scanner *scanner) {
+	return current(scanner) == '\0';
+}
+
+/*
+ * Warns about overlong lines and misplaced or excessive tabs in the line
+ * starting at the given position. Runs once per line instead of once per
+ * scanned character.
+ */
+static void lint_line(const char *line, struct tarot_stream_position position) {
+	size_t indentation = 0;
+	for (; *line != '\0' and *line != '\n'; line++) {
+		if (*line != '\t') {
+			position.column++;
+		} else {
+			indentation++;
+		}
+		if (position.column == max_line_length) {
+			tarot_warning_at(&position,
+				"Line exceeds recommended length limit of %d characters.\n"
+				"Consider splitting the line into multiple smaller ones, as\n"
+				"long lines tend to make sourcecode harder to read.\n",
+				max_line_length
+			);
+		}
+		if (*line == '\t' and position.column > (indentation + 1)) {
+			tarot_warning_at(&position,
+				"Tab mixed with regular characters.\n"
+				"Tabs are used to indent lines and therefore should "
+				"only ever appear as the first characters of a line.\n"
+				"Using tabs anywhere else within a line will lead to "
+				"alignment issues."
+			);
+		}
+		if (*line == '\t' and indentation > max_indentation) {
+			tarot_warning_at(&position,
+				"Overindented line - the line is indented %d times!\n"
+				"This exceeds the maximum recommended indentation of %d.\n"
+				"Consider putting the affected section into a new function.",
+				indentation,
+				max_indentation
+			);
+		}
+	}
 }
 
-static void perform_suggestions(struct tarot_iostream *stream) {
-	if (line_is_too_long(stream)) {
-		tarot_warning_at(tarot_fgetpos(stream),
-			"Line exceeds recommended length limit of %d characters.\n"
-			"Consider splitting the line into multiple smaller ones, as\n"
-			"long lines tend to make sourcecode harder to read.\n",
-			max_line_length
-		);
-	}
-	if (line_has_mixed_indentation(stream)) {
-		tarot_warning_at(tarot_fgetpos(stream),
-			"Tab mixed with regular characters.\n"
-			"Tabs are used to indent lines and therefore should "
-			"only ever appear as the first characters of a line.\n"
-			"Using tabs anywhere else within a line will lead to "
-			"alignment issues."
-		);
-	}
-	if (line_is_overindented(stream)) {
-		tarot_warning_at(tarot_fgetpos(stream),
-			"Overindented line - the line is indented %d times!\n"
-			"This exceeds the maximum recommended indentation of %d.\n"
-			"Consider putting the affected section into a new function.",
-			tarot_stream_indentation(stream),
-			max_indentation
-		);
+/* Accounts for the new current character, positions match iostreams */
+static void enter_character(struct tarot_scanner *scanner) {
+	switch (current(scanner)) {
+		default:
+			scanner->position.column++;
+			break;
+		case '\n':
+			scanner->position.line++;
+			scanner->position.column = 1;
+			if (scanner->mode == TAROT_SCAN_LINT) {
+				lint_line(scanner->source + scanner->offset + 1, scanner->position);
+			}
+			break;
+		case '\t':
+			break;
 	}
 }
 
-static int advance(struct tarot_iostream *stream) {
-	perform_suggestions(stream);
-	return tarot_fgetc(stream);
+static int advance(struct tarot_scanner *scanner) {
+	if (not at_end(scanner)) {
+		scanner->offset++;
+		enter_character(scanner);
+	}
+	return current(scanner);
 }
 
-static bool match(struct tarot_iostream *stream, int ch) {
-	bool result = tarot_fcurr(stream) == ch;
+static bool match(struct tarot_scanner *scanner, int ch) {
+	bool result = current(scanner) == ch;
 	if (result) {
-		advance(stream);
+		advance(scanner);
 	}
 	return result;
 }
 
+static bool lookahead(struct tarot_scanner *scanner, const char *text) {
+	return strncmp(scanner->source + scanner->offset, text, strlen(text)) == 0;
+}
+
 static bool is_intchar(int ch) {
 	return isdigit(ch) or (isxdigit(ch) and isupper(ch)) or (ch == '_');
 }
 
 static void raise_seperator_error(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	const char *at
 ) {
-	assert(stream != NULL);
+	assert(scanner != NULL);
 	assert(at != NULL);
 	tarot_error_at(
-		tarot_fgetpos(stream),
+		&scanner->position,
 		"The visual underscore seperator is only permitted between "
 		"digits. It is not allowed at the %s of a series of digits.",
 		at
 	);
 }
 
+/* Appends a slice of digits to the string, leaving out the seperators */
+static void append_digits(
+	struct tarot_string **string,
+	const char *text,
+	size_t length
+) {
+	char *digits = tarot_string_reserve(string, length);
+	size_t i, n = 0;
+	for (i = 0; i < length; i++) {
+		if (text[i] != '_') {
+			digits[n++] = text[i];
+		}
+	}
+	tarot_string_commit(*string, n);
+}
+
 static size_t read_digits(
 	struct tarot_string **string,
-	struct tarot_iostream *stream
+	struct tarot_scanner *scanner
 ) {
+	size_t start = scanner->offset;
 	size_t length = 0;
-	if (isdigit(tarot_fcurr(stream))) {
+	if (isdigit(current(scanner))) {
 		char last_character = 0;
-		while (is_intchar(tarot_fcurr(stream))) {
-			if (tarot_fcurr(stream) != '_') {
-				tarot_string_append(string, "%c", tarot_fcurr(stream));
+		while (is_intchar(current(scanner))) {
+			if (current(scanner) != '_') {
 				length++;
 			}
-			last_character = tarot_fcurr(stream);
-			advance(stream);
+			last_character = current(scanner);
+			advance(scanner);
 		}
 		if (last_character == '_') {
-			raise_seperator_error(stream, "end");
+			raise_seperator_error(scanner, "end");
 		}
-	} else if (tarot_fcurr(stream) == '_') {
-		raise_seperator_error(stream, "start");
+		append_digits(string, scanner->source + start, scanner->offset - start);
+	} else if (current(scanner) == '_') {
+		raise_seperator_error(scanner, "start");
 	}
 	return length;
 }
@@ -125,12 +175,12 @@ static long int ipow10(long int n) {
 }
 
 static void tokenize_number_as_decimal(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_string **string,
 	struct tarot_token *token
 ) {
 	long int length = 0;
-	length = read_digits(string, stream);
+	length = read_digits(string, scanner);
 	if (length != 0)  {
 		tarot_integer *numerator;
 		tarot_integer *denominator;
@@ -140,7 +190,7 @@ static void tokenize_number_as_decimal(
 		token->value.Rational = tarot_create_rational_from_integers(
 			numerator, denominator
 		);
-		if (match(stream, 'f')) {
+		if (match(scanner, 'f')) {
 			double value = tarot_rational_to_float(token->value.Rational);
 			tarot_free_rational(token->value.Rational);
 			token->value.Float = value;
@@ -156,13 +206,13 @@ static void tokenize_number_as_decimal(
 }
 
 static void tokenize_number_as_rational(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_string **string,
 	struct tarot_token *token
 ) {
 	tarot_integer *numerator = tarot_create_integer_from_string(*string, 10);
 	tarot_clear_string(*string);
-	if (read_digits(string, stream) == 0) {
+	if (read_digits(string, scanner) == 0) {
 		tarot_error_at(&token->position, "Invalid denominator");
 	} else {
 		tarot_integer *denominator;
@@ -176,17 +226,17 @@ static void tokenize_number_as_rational(
 	tarot_free_integer(numerator);
 }
 
-static int read_numbase(struct tarot_iostream *stream) {
+static int read_numbase(struct tarot_scanner *scanner) {
 	int base = 10;
-	if (match(stream, ':')) {
+	if (match(scanner, ':')) {
 		char buffer[3] = {0};
 		unsigned int i;
 		for (i = 0; i < 2; i++) {
-			if (not isdigit(tarot_fcurr(stream))) {
+			if (not isdigit(current(scanner))) {
 				break;
 			}
-			buffer[i] = tarot_fcurr(stream);
-			advance(stream);
+			buffer[i] = current(scanner);
+			advance(scanner);
 		}
 		if (i > 0) {
 			buffer[2] = '\0';
@@ -197,230 +247,224 @@ static int read_numbase(struct tarot_iostream *stream) {
 }
 
 static void tokenize_number(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
 	struct tarot_string *string = tarot_create_string(NULL);
-	read_digits(&string, stream);
-	if (match(stream, '.')) {
-		tokenize_number_as_decimal(stream, &string, token);
-	} else if (match(stream, '|')) {
-		tokenize_number_as_rational(stream, &string, token);
+	read_digits(&string, scanner);
+	if (match(scanner, '.')) {
+		tokenize_number_as_decimal(scanner, &string, token);
+	} else if (match(scanner, '|')) {
+		tokenize_number_as_rational(scanner, &string, token);
 	} else {
 		int base = 10;
 		token->kind = TAROT_TOK_INTEGER;
-		base = read_numbase(stream);
+		base = read_numbase(scanner);
 		token->value.Integer = tarot_create_integer_from_string(string, base);
 	}
 	tarot_free(string);
 }
 
-static bool tarot_match_keyword(
-	struct tarot_string *string,
-	enum tarot_token_kind *type
+/*
+ * Keywords are looked up through a perfect hash of the first two and the
+ * last character and the length of an identifier. The table was generated
+ * by a brute force search for multipliers that give every keyword a slot
+ * of its own, it has to be regenerated whenever a keyword is added.
+ */
+static const enum tarot_token_kind keywords[128] = {
+	0, 0, 0, TAROT_TOK_ALIAS,
+	0, 0, TAROT_TOK_RETURN, TAROT_TOK_CLASS,
+	0, 0, 0, 0,
+	TAROT_TOK_AS, TAROT_TOK_NAMESPACE, 0, TAROT_TOK_LET,
+	TAROT_TOK_OR, TAROT_TOK_RAISE, TAROT_TOK_LAUNCH, TAROT_TOK_MATCH,
+	TAROT_TOK_ASSERT, 0, TAROT_TOK_PUBLIC, 0,
+	0, TAROT_TOK_MOD, 0, 0,
+	TAROT_TOK_IS, 0, 0, 0,
+	0, 0, 0, 0,
+	TAROT_TOK_IN, TAROT_TOK_ENUMERATION, 0, TAROT_TOK_WHILE,
+	0, 0, 0, 0,
+	TAROT_TOK_IMPORT, 0, TAROT_TOK_INIT, 0,
+	TAROT_TOK_FUNCTION, 0, 0, 0,
+	TAROT_TOK_BREAKPOINT, 0, 0, TAROT_TOK_TRY,
+	0, 0, 0, 0,
+	0, 0, 0, TAROT_TOK_UNION,
+	TAROT_TOK_FOREIGN_FUNCTION, 0, 0, TAROT_TOK_FOR,
+	0, 0, 0, 0,
+	0, 0, TAROT_TOK_CONSTANT, TAROT_TOK_DEFINE_TYPE,
+	0, 0, 0, 0,
+	0, 0, TAROT_TOK_ELSE, 0,
+	0, 0, 0, 0,
+	TAROT_TOK_SWITCH, 0, 0, TAROT_TOK_NOT,
+	0, TAROT_TOK_BREAK, 0, 0,
+	0, 0, 0, TAROT_TOK_PRIVATE,
+	TAROT_TOK_IF, 0, TAROT_TOK_SELF, TAROT_TOK_XOR,
+	TAROT_TOK_TRUE, 0, 0, 0,
+	TAROT_TOK_FROM, TAROT_TOK_AND, TAROT_TOK_OPERATOR, 0,
+	0, 0, 0, 0,
+	0, 0, 0, 0,
+	0, TAROT_TOK_FALSE, 0, 0,
+	0, 0, 0, TAROT_TOK_CATCH,
+};
+
+static bool match_keyword(
+	const char *text,
+	size_t length,
+	enum tarot_token_kind *kind
 ) {
-	bool result = false;
+	const unsigned char *bytes = (const unsigned char*)text;
+	const char *keyword;
 	enum tarot_token_kind it;
-	for (it = TAROT_KEYWORD_START+1; it < TAROT_KEYWORD_END; it++) {
-		if (tarot_match_string(string, tarot_token_string(it))) {
-			result = true;
-			if (type != NULL) {
-				*type = it;
-			}
-			break;
-		}
+	if (length < 2) {
+		return false;
 	}
-	return result;
+	it = keywords[
+		(2 * bytes[0] + 20 * bytes[1] + 4 * bytes[length - 1] + length)
+		% lengthof(keywords)
+	];
+	if (it == TAROT_TOK_EOF) {
+		return false;
+	}
+	keyword = tarot_token_string(it);
+	if (strlen(keyword) != length or strncmp(keyword, text, length) != 0) {
+		return false;
+	}
+	*kind = it;
+	return true;
 }
 
 static void tokenize_identifier(
-	struct tarot_iostream *stream,
-	struct tarot_token *token,
-	int first_character
+	struct tarot_scanner *scanner,
+	struct tarot_token *token
 ) {
-	struct tarot_string *string = tarot_create_string(NULL);
-	enum tarot_token_kind keyword;
-	tarot_string_append(&string, "%c", first_character);
-	while (isalnum(tarot_fcurr(stream)) or (tarot_fcurr(stream) == '_')) {
-		/* If tarot_feof(stream), the while condition evaluates to false */
-		tarot_string_append(&string, "%c", tarot_fcurr(stream));
-		advance(stream);
-	}
-	if (tarot_match_keyword(string, &keyword)) {
-		token->kind = keyword;
-		tarot_free(string);
-	} else {
+	size_t length;
+	while (isalnum(current(scanner)) or (current(scanner) == '_')) {
+		advance(scanner);
+	}
+	length = scanner->offset - token->offset;
+	if (not match_keyword(scanner->source + token->offset, length, &token->kind)) {
 		token->kind = TAROT_TOK_IDENTIFIER;
-		token->value.String = string;
 	}
 }
 
-static void handle_escape_sequence(
-	struct tarot_string **stringptr,
-	struct tarot_iostream *stream
-) {
-	switch(tarot_fcurr(stream)) {
-		default:
-			break;
-		case '"':
-		case '\\':
-			tarot_string_append(stringptr, "%c", tarot_fcurr(stream));
-			advance(stream);
-			break;
-		case 'b':
-			tarot_string_append(stringptr, "\b");
-			advance(stream);
-			break;
-		case 'f':
-			tarot_string_append(stringptr, "\f");
-			advance(stream);
-			break;
-		case 'n':
-			tarot_string_append(stringptr, "\n");
-			advance(stream);
-			break;
-		case 'r':
-			tarot_string_append(stringptr, "\r");
-			advance(stream);
-			break;
-		case 't':
-			tarot_string_append(stringptr, "\t");
-			advance(stream);
-			break;
-		case '{':
-			tarot_string_append(stringptr, "{");
-			advance(stream);
-			break;
-		case '}':
-			tarot_string_append(stringptr, "}");
-			advance(stream);
-			break;
-	}
+static bool is_escape_character(int ch) {
+	return ch != '\0' and strchr("\"\\bfnrt{}", ch) != NULL;
 }
 
-static void add_character(
-	struct tarot_string **stringptr,
-	struct tarot_iostream *stream
-) {
-	if (tarot_fcurr(stream) == '\\') {
-		advance(stream);
-		handle_escape_sequence(stringptr, stream);
+/* Steps over a character of a string literal, see resolve_escapes */
+static void skip_character(struct tarot_scanner *scanner) {
+	if (current(scanner) == '\\') {
+		advance(scanner);
+		if (is_escape_character(current(scanner))) {
+			advance(scanner);
+		}
 	} else {
-		tarot_string_append(stringptr, "%c", tarot_fcurr(stream));
-		advance(stream);
+		advance(scanner);
 	}
 }
 
 static void tokenize_string(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	struct tarot_string *string = tarot_create_string(NULL);
-	while (not tarot_feof(stream) and tarot_fcurr(stream) != '"') {
-		add_character(&string, stream);
+	token->offset = scanner->offset;
+	while (not at_end(scanner) and current(scanner) != '"') {
+		skip_character(scanner);
 	}
-	if (match(stream, '"')) {
+	token->length = scanner->offset - token->offset;
+	if (match(scanner, '"')) {
 		token->kind = TAROT_TOK_STRING;
-		token->value.String = string;
 	} else {
-		tarot_free(string);
 		tarot_error_at(&token->position, "Unterminated string");
 	}
 }
 
 static void tokenize_fstring(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	struct tarot_string *string = tarot_create_string(NULL);
 	unsigned int brackets = 0;
-	assert(tarot_fcurr(stream) == '"');
-	advance(stream);
-	while (not tarot_feof(stream)) {
-		if (tarot_fcurr(stream) == '{') {
+	assert(current(scanner) == '"');
+	advance(scanner);
+	token->offset = scanner->offset;
+	while (not at_end(scanner)) {
+		if (current(scanner) == '{') {
 			brackets++;
-		} else if (tarot_fcurr(stream) == '}') {
+		} else if (current(scanner) == '}') {
 			if (brackets > 0) {
 				brackets--;
 			} else {
 				tarot_error_at(&token->position, "Too many closing }");
 			}
-		} else if (tarot_fcurr(stream) == '"' and brackets == 0) {
+		} else if (current(scanner) == '"' and brackets == 0) {
 			break;
 		}
-		add_character(&string, stream);
+		skip_character(scanner);
 	}
-	if (match(stream, '"')) {
+	token->length = scanner->offset - token->offset;
+	if (match(scanner, '"')) {
 		token->kind = TAROT_TOK_FSTRING;
-		token->value.String = string;
 	} else {
-		tarot_free(string);
 		tarot_error_at(&token->position, "Unterminated fstring");
 	}
 }
 
 static void tokenize_rstring(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	struct tarot_string *string = tarot_create_string(NULL);
-	assert(tarot_fcurr(stream) == '"');
-	advance(stream);
-	while (not tarot_feof(stream) and tarot_fcurr(stream) != '"') {
-		tarot_string_append(&string, "%c", tarot_fcurr(stream));
-		advance(stream);
+	assert(current(scanner) == '"');
+	advance(scanner);
+	token->offset = scanner->offset;
+	while (not at_end(scanner) and current(scanner) != '"') {
+		advance(scanner);
 	}
-	if (match(stream, '"')) {
+	token->length = scanner->offset - token->offset;
+	if (match(scanner, '"')) {
 		token->kind = TAROT_TOK_RSTRING;
-		token->value.String = string;
 	} else {
-		tarot_free(string);
 		tarot_error_at(&token->position, "Unterminated rstring");
 	}
 }
 
-static bool match_textblock(struct tarot_iostream *stream) {
-	return match(stream, '`') and match(stream, '`') and match(stream, '`');
+static bool match_textblock(struct tarot_scanner *scanner) {
+	return match(scanner, '`') and match(scanner, '`') and match(scanner, '`');
 }
 
 static void tokenize_textblock(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	struct tarot_string *string;
-	string = tarot_create_string(NULL);
-	while (not match_textblock(stream) and not tarot_feof(stream)) {
-		tarot_string_append(&string, "%c", tarot_fcurr(stream));
-		advance(stream);
+	token->offset = scanner->offset;
+	while (not at_end(scanner) and not lookahead(scanner, "```")) {
+		advance(scanner);
 	}
-	if (match(stream, '`')) {
+	token->length = scanner->offset - token->offset;
+	if (match_textblock(scanner)) {
 		token->kind = TAROT_TOK_TEXTBLOCK;
-		token->value.String = string;
 	} else {
-		tarot_free(string);
 		tarot_error_at(&token->position, "Unterminated textblock");
 	}
 }
 
 static void tokenize_comment(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
 	unsigned int nesting = 1;
 	token->kind = TAROT_TOK_COMMENT;
-	while ((nesting > 0) and not tarot_feof(stream)) {
-		switch (tarot_fcurr(stream)) {
+	while ((nesting > 0) and not at_end(scanner)) {
+		switch (current(scanner)) {
 			default:
-				advance(stream);
+				advance(scanner);
 				break;
 			case '/':
-				if (advance(stream) == '*') {
-					advance(stream);
+				if (advance(scanner) == '*') {
+					advance(scanner);
 					nesting++;
 				} break;
 			case '*':
-				if (advance(stream) == '/') {
-					advance(stream);
+				if (advance(scanner) == '/') {
+					advance(scanner);
 					nesting--;
 				} break;
 		}
@@ -428,67 +472,67 @@ static void tokenize_comment(
 }
 
 static void tokenize(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	int current = tarot_fcurr(stream);
-	int next = advance(stream);
+	int first = current(scanner);
+	int next = advance(scanner);
 	assert(token != NULL);
-	switch (current) {
+	switch (first) {
 		default:
-			tarot_error_at(&token->position, "Invalid token '%c'!", current);
+			tarot_error_at(&token->position, "Invalid token '%c'!", first);
 			break;
 		case '+':
-			if (match(stream, '=')) {
+			if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_ASSIGN_ADD;
 			} else {
 				token->kind = TAROT_TOK_PLUS;
 			}
 			break;
 		case '-':
-			if (match(stream, '>')) {
+			if (match(scanner, '>')) {
 				token->kind = TAROT_TOK_ARROW;
-			} else if (match(stream, '=')) {
+			} else if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_ASSIGN_SUB;
 			} else {
 				token->kind = TAROT_TOK_MINUS;
 			} break;
 		case '*':
-			if (match(stream, '*')) {
+			if (match(scanner, '*')) {
 				token->kind = TAROT_TOK_POWER;
-			} else if (match(stream, '=')) {
+			} else if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_ASSIGN_MUL;
 			} else {
 				token->kind = TAROT_TOK_MULTIPLY;
 			} break;
 		case '/':
 			if (next == '*') {
-				tokenize_comment(stream, token);
-			} else if (match(stream, '=')) {
+				tokenize_comment(scanner, token);
+			} else if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_ASSIGN_DIV;
 			} else {
 				token->kind = TAROT_TOK_DIVIDE;
 			} break;
 		case '=':
-			if (match(stream, '=')) {
+			if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_EQUAL;
 			} else {
 				token->kind = TAROT_TOK_ASSIGN;
 			} break;
 		case '!':
-			if (match(stream, '=')) {
+			if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_NOT_EQUAL;
 			} else {
-				tarot_error_at(&token->position, "Invalid token '%c'!", current);
+				tarot_error_at(&token->position, "Invalid token '%c'!", first);
 			} break;
 		case '<':
-			if (match(stream, '=')) {
+			if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_LESS_EQUAL;
 			} else {
 				token->kind = TAROT_TOK_LESS_THAN;
 			} break;
 		case '>':
-			if (match(stream, '=')) {
+			if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_GREATER_EQUAL;
 			} else {
 				token->kind = TAROT_TOK_GREATER_THAN;
@@ -518,7 +562,7 @@ static void tokenize(
 			token->kind = TAROT_TOK_SEMICOLON;
 			break;
 		case ':':
-			if (match(stream, '=')) {
+			if (match(scanner, '=')) {
 				token->kind = TAROT_TOK_ASSIGN;
 			} else {
 				token->kind = TAROT_TOK_COLON;
@@ -528,94 +572,241 @@ static void tokenize(
 			token->kind = TAROT_TOK_DOT;
 			break;
 		case '"':
-			tokenize_string(stream, token);
+			tokenize_string(scanner, token);
 			break;
 		case '#':
-			while (not match(stream, '\n')) {
-				if (tarot_feof(stream)) {
+			while (not match(scanner, '\n')) {
+				if (at_end(scanner)) {
 					break;
 				}
-				advance(stream);
+				advance(scanner);
 			}
 			token->kind = TAROT_TOK_COMMENT;
 			break;
 	}
 }
 
-static void skip_whitespace(struct tarot_iostream *stream) {
-	while (isspace(tarot_fcurr(stream))) {
-		advance(stream);
+static void skip_whitespace(struct tarot_scanner *scanner) {
+	while (isspace(current(scanner))) {
+		advance(scanner);
 	}
 }
 
 static void reset_token(
 	struct tarot_token *token,
-	struct tarot_iostream *stream
+	struct tarot_scanner *scanner
 ) {
 	token->kind = TAROT_TOK_EOF;
 	memset(&token->value, 0, sizeof(token->value));
-	memcpy(&token->position, tarot_fgetpos(stream), sizeof(token->position));
+	memcpy(&token->position, &scanner->position, sizeof(token->position));
+	token->offset = scanner->offset;
+	token->length = 0;
 }
 
 static void tokenize_string_or_identifier(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	int ch = tarot_fcurr(stream);
-	advance(stream);
-	if (ch == 'f' and tarot_fcurr(stream) == '"') {
-		tokenize_fstring(stream, token);
-	} else if (ch == 'r' and tarot_fcurr(stream) == '"') {
-		tokenize_rstring(stream, token);
+	int ch = current(scanner);
+	advance(scanner);
+	if (ch == 'f' and current(scanner) == '"') {
+		tokenize_fstring(scanner, token);
+	} else if (ch == 'r' and current(scanner) == '"') {
+		tokenize_rstring(scanner, token);
 	} else {
-		tokenize_identifier(stream, token, ch);
+		tokenize_identifier(scanner, token);
 	}
 }
 
-void tarot_read_token(
-	struct tarot_iostream *stream,
+static bool is_string_literal(enum tarot_token_kind kind) {
+	switch (kind) {
+		default:
+			return false;
+		case TAROT_TOK_STRING:
+		case TAROT_TOK_FSTRING:
+		case TAROT_TOK_RSTRING:
+		case TAROT_TOK_TEXTBLOCK:
+			return true;
+	}
+}
+
+void tarot_open_scanner(
+	struct tarot_scanner *scanner,
+	const char *source,
+	const struct tarot_stream_position *position,
+	enum tarot_scan_mode mode
+) {
+	assert(scanner != NULL);
+	assert(source != NULL);
+	assert(position != NULL);
+	scanner->source = source;
+	scanner->offset = 0;
+	scanner->position = *position;
+	scanner->mode = mode;
+	if (mode == TAROT_SCAN_LINT) {
+		lint_line(source, scanner->position);
+	}
+	enter_character(scanner);
+}
+
+void tarot_scan_token(
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
-	assert(stream != NULL);
+	assert(scanner != NULL);
 	assert(token != NULL);
-	skip_whitespace(stream);
-	reset_token(token, stream);
-	if (tarot_feof(stream)) {
+	skip_whitespace(scanner);
+	reset_token(token, scanner);
+	if (at_end(scanner)) {
 		token->kind = TAROT_TOK_EOF;
-	} else if (isalpha(tarot_fcurr(stream)) or tarot_fcurr(stream) == '_') {
-		tokenize_string_or_identifier(stream, token);
-	} else if (isdigit(tarot_fcurr(stream))) {
-		tokenize_number(stream, token);
-	} else if (match_textblock(stream)) {
-		tokenize_textblock(stream, token);
+	} else if (isalpha(current(scanner)) or current(scanner) == '_') {
+		tokenize_string_or_identifier(scanner, token);
+	} else if (isdigit(current(scanner))) {
+		tokenize_number(scanner, token);
+	} else if (lookahead(scanner, "```")) {
+		match_textblock(scanner);
+		tokenize_textblock(scanner, token);
 	} else {
-		tokenize(stream, token);
+		tokenize(scanner, token);
+	}
+	if (not is_string_literal(token->kind)) {
+		token->length = scanner->offset - token->offset;
 	}
 }
 
-void tarot_read_tokens_from_stream(
-	struct tarot_iostream *stream,
+/* Copies the text of a string literal, resolving its escape sequences */
+static size_t resolve_escapes(char *buffer, const char *text, size_t length) {
+	size_t i = 0, n = 0;
+	while (i < length) {
+		if (text[i] != '\\') {
+			buffer[n++] = text[i++];
+			continue;
+		}
+		if (++i == length) {
+			break;
+		}
+		switch (text[i]) {
+			default:
+				continue; /* the backslash is dropped */
+			case '"':
+			case '\\':
+			case '{':
+			case '}':
+				buffer[n++] = text[i];
+				break;
+			case 'b':
+				buffer[n++] = '\b';
+				break;
+			case 'f':
+				buffer[n++] = '\f';
+				break;
+			case 'n':
+				buffer[n++] = '\n';
+				break;
+			case 'r':
+				buffer[n++] = '\r';
+				break;
+			case 't':
+				buffer[n++] = '\t';
+				break;
+		}
+		i++;
+	}
+	return n;
+}
+
+struct tarot_string* tarot_token_text(
+	const struct tarot_scanner *scanner,
+	const struct tarot_token *token
+) {
+	const char *text = scanner->source + token->offset;
+	struct tarot_string *string;
+	char *buffer;
+	size_t length = token->length;
+	if (token->kind == TAROT_TOK_IDENTIFIER or token->kind == TAROT_TOK_RSTRING) {
+		return tarot_intern_text(text, length);
+	}
+	string = tarot_create_string(NULL);
+	buffer = tarot_string_reserve(&string, token->length);
+	if (token->kind == TAROT_TOK_STRING or token->kind == TAROT_TOK_FSTRING) {
+		length = resolve_escapes(buffer, text, token->length);
+	} else {
+		memcpy(buffer, text, length);
+	}
+	tarot_string_commit(string, length);
+	if (token->kind == TAROT_TOK_STRING) {
+		string = tarot_intern_string(string);
+	}
+	return string;
+}
+
+bool tarot_token_matches(
+	const struct tarot_scanner *scanner,
+	const struct tarot_token *token,
+	const char *text
+) {
+	return (
+		strlen(text) == token->length and
+		strncmp(scanner->source + token->offset, text, token->length) == 0
+	);
+}
+
+static void read_tokens(
+	const char *source,
+	const char *path,
 	void (*process)(struct tarot_token *token, void *data),
 	void *data
 ) {
+	struct tarot_scanner scanner;
+	struct tarot_stream_position position;
 	struct tarot_token token;
-	assert(stream != NULL);
 	assert(process != NULL);
+	position.path = path;
+	position.line = 1;
+	position.column = 1;
+	tarot_open_scanner(&scanner, source, &position, TAROT_SCAN_FAST);
 	do {
-		tarot_read_token(stream, &token);
+		tarot_scan_token(&scanner, &token);
+		if (token.kind == TAROT_TOK_IDENTIFIER or is_string_literal(token.kind)) {
+			token.value.String = tarot_token_text(&scanner, &token);
+		}
 		process(&token, data);
 	} while (token.kind != TAROT_TOK_EOF);
 }
 
+void tarot_read_tokens_from_stream(
+	struct tarot_iostream *stream,
+	void (*process)(struct tarot_token *token, void *data),
+	void *data
+) {
+	struct tarot_string *source = tarot_create_string(NULL);
+	int ch;
+	assert(stream != NULL);
+	while ((ch = tarot_fgetc(stream)), not tarot_feof(stream)) {
+		*tarot_string_reserve(&source, 1) = ch;
+		tarot_string_commit(source, 1);
+	}
+	read_tokens(tarot_string_text(source), tarot_fgetpos(stream)->path, process, data);
+	tarot_free_string(source);
+}
+
 void tarot_read_tokens_from_file(
 	const char *path,
 	void (*process)(struct tarot_token *token, void *data),
 	void *data
 ) {
-	struct tarot_iostream *stream = tarot_fopen(path, TAROT_INPUT);
-	assert(process != NULL);
-	if (stream != NULL) {
-		tarot_read_tokens_from_stream(stream, process, data);
-		tarot_fclose(stream);
+	char *source = tarot_read_file(path, NULL);
+	if (source != NULL) {
+		read_tokens(source, path, process, data);
+		tarot_free(source);
 	}
 }
+
+void tarot_read_tokens_from_memory(
+	const char *buffer,
+	void (*process)(struct tarot_token *token, void *data),
+	void *data
+) {
+	assert(buffer != NULL);
+	read_tokens(buffer, "memory", process, data);
+}
@@ -9,11 +9,66 @@ struct tarot_token;
 extern void tarot_set_max_line_length(size_t value);
 extern void tarot_set_max_indentation(size_t value);
 
-extern void tarot_read_token(
-	struct tarot_iostream *stream,
+/**
+ * Whether the scanner checks the source for style issues as it goes.
+ * Linting warns about overlong lines and bad indentation, the fast mode
+ * skips these checks entirely and suits sources known to be fine.
+ */
+enum tarot_scan_mode {
+	TAROT_SCAN_LINT,
+	TAROT_SCAN_FAST
+};
+
+/**
+ * Scans a contiguous, null-terminated source buffer. Tokens refer to their
+ * text as a slice of the buffer (see tarot_token.offset and .length), so
+ * scanning builds no strings. Identifiers and string literals are only
+ * turned into strings by tarot_token_text once somebody needs them.
+ */
+struct tarot_scanner {
+	const char *source;                    /**< The scanned source text     */
+	size_t offset;                         /**< Offset of current character */
+	struct tarot_stream_position position; /**< Position of current character */
+	enum tarot_scan_mode mode;             /**< Whether lines are linted     */
+};
+
+/**
+ * Prepares the scanner for the given source. The position is that of the
+ * start of the source, e.g. line 1, column 1 of the file it was read from.
+ * The source must outlive the scanner and all tokens it produces.
+ * In lint mode each line is checked for style issues once it is entered.
+ */
+extern void tarot_open_scanner(
+	struct tarot_scanner *scanner,
+	const char *source,
+	const struct tarot_stream_position *position,
+	enum tarot_scan_mode mode
+);
+
+extern void tarot_scan_token(
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 );
 
+/**
+ * Creates the string value of an identifier or string literal token from
+ * its slice. Escape sequences of strings and fstrings are resolved.
+ * Identifiers and string literals other than fstrings are interned.
+ */
+extern struct tarot_string* tarot_token_text(
+	const struct tarot_scanner *scanner,
+	const struct tarot_token *token
+);
+
+/**
+ * Compares the slice of the token with a c-string.
+ */
+extern bool tarot_token_matches(
+	const struct tarot_scanner *scanner,
+	const struct tarot_token *token,
+	const char *text
+);
+
 void tarot_read_tokens_from_stream(
 	struct tarot_iostream *stream,
 	void (*process_token)(struct tarot_token *token, void *userdata),
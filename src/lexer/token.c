@@ -136,7 +136,7 @@ void tarot_clear_token(struct tarot_token *token) {
 		case TAROT_TOK_FSTRING:
 		case TAROT_TOK_RSTRING:
 		case TAROT_TOK_TEXTBLOCK:
-			tarot_free(token->value.String);
+			tarot_free_string(token->value.String);
 			break;
 		case TAROT_TOK_INTEGER:
 			tarot_free_integer(token->value.Integer);
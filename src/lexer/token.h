@@ -115,6 +115,8 @@ struct tarot_token {
 	union tarot_value value;
 	struct tarot_stream_position position;
 	enum tarot_token_kind kind;
+	size_t offset; /**< Start of the token text within the scanned source */
+	size_t length; /**< Length of the token text, quotes are excluded */
 };
 
 /**
@@ -1,7 +1,90 @@
+#ifdef TAROT_THREADS
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include "tarot.h"
 
+#ifdef TAROT_THREADS
+struct posix_thread {
+	pthread_t handle;
+	tarot_thread_routine routine;
+	void *argument;
+};
+
+static void* run_posix_thread(void *argument) {
+	struct posix_thread *thread = argument;
+	thread->routine(thread->argument);
+	return NULL;
+}
+
+static void* start_thread(tarot_thread_routine routine, void *argument) {
+	struct posix_thread *thread = malloc(sizeof(*thread));
+	if (thread == NULL) {
+		abort();
+	}
+	thread->routine = routine;
+	thread->argument = argument;
+	if (pthread_create(&thread->handle, NULL, run_posix_thread, thread)) {
+		abort();
+	}
+	return thread;
+}
+
+static void join_thread(void *thread) {
+	pthread_join(((struct posix_thread*)thread)->handle, NULL);
+	free(thread);
+}
+
+static void yield_thread(void) {
+	sched_yield();
+}
+
+static void* create_mutex(void) {
+	pthread_mutex_t *mutex = malloc(sizeof(*mutex));
+	if (mutex == NULL) {
+		abort();
+	}
+	if (pthread_mutex_init(mutex, NULL)) {
+		abort();
+	}
+	return mutex;
+}
+
+static void free_mutex(void *mutex) {
+	pthread_mutex_destroy(mutex);
+	free(mutex);
+}
+
+static void lock_mutex(void *mutex) {
+	pthread_mutex_lock(mutex);
+}
+
+static void unlock_mutex(void *mutex) {
+	pthread_mutex_unlock(mutex);
+}
+
+static pthread_key_t context_key;
+
+static void* get_context(void) {
+	return pthread_getspecific(context_key);
+}
+
+static void set_context(void *context) {
+	pthread_setspecific(context_key, context);
+}
+
+#ifdef __GNUC__
+static unsigned int atomic_add(unsigned int *value, int amount) {
+	return __sync_add_and_fetch(value, amount);
+}
+#else
+#define atomic_add NULL
+#endif
+#endif
+
 #undef TAROT_VMAIN
 
 int main(int argc, char *argv[]) {
@@ -17,8 +100,28 @@ int main(int argc, char *argv[]) {
 		(tarot_fputc_function)   fputc,
 		stdin, stdout, stderr
 	};
+#ifdef TAROT_THREADS
+	const struct tarot_threading_config threading = {
+		start_thread,
+		join_thread,
+		yield_thread,
+		create_mutex,
+		free_mutex,
+		lock_mutex,
+		unlock_mutex,
+		get_context,
+		set_context,
+		atomic_add
+	};
+#endif
 	tarot_initialize(&config);
 	if (tarot_is_initialized()) {
+#ifdef TAROT_THREADS
+		if (pthread_key_create(&context_key, NULL)) {
+			abort();
+		}
+		tarot_initialize_threading(&threading);
+#endif
 #ifdef TAROT_VMAIN
 		tarot_vmain(argv[1]);
 #else
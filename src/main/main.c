@@ -4,13 +4,16 @@
 static const struct tarot_option command_line_options[] = {
 	{"ast",      'a', 0},
 	{"bytecode", 'b', 0},
+	{"cache",    'k', 1},
 	{"colored",  'c', 0},
 	{"debug",    'd', 0},
 	{"export",   'e', 0},
 	{"format",   'f', 0},
 	{"help",     'h', 0},
 	{"input",    'i', 1},
+	{"jobs",     'j', 1},
 	{"verbose",  'l', 0},
+	{"nolint",   'n', 0},
 	{"output",   'o', 1},
 	{"path",     'p', 1},
 	{"run",      'r', 0},
@@ -22,13 +25,16 @@ static const struct tarot_option command_line_options[] = {
 enum option_name {
 	OPTION_PRINT_AST,
 	OPTION_PRINT_BYTECODE,
+	OPTION_SET_CACHE,
 	OPTION_ENABLE_COLORED_OUTPUT,
 	OPTION_DEBUG_BUILD,
 	OPTION_EXPORT,
 	OPTION_FORMAT_AST,
 	OPTION_PRINT_HELP,
 	OPTION_SET_INPUT,
+	OPTION_SET_JOBS,
 	OPTION_ENABLE_LOGGING,
+	OPTION_SKIP_LINTING,
 	OPTION_SET_OUTPUT,
 	OPTION_SET_PATH,
 	OPTION_RUN_FILE,
@@ -46,6 +52,9 @@ static struct {
 	const char *input;
 	const char *output;
 	const char *path;
+	const char *cache;
+	size_t num_jobs;
+	enum tarot_scan_mode scan_mode;
 	bool print_help;
 	bool print_version;
 	bool format_sourcecode;
@@ -75,8 +84,17 @@ static const char* help_text[] = {
 	"      Displays this help message.\n",
 	"  -i, --input\n"
 	"      Reads the input file at <path>.\n",
+	"  -j, --jobs <n>\n"
+	"      Runs the launched threads of the program on n OS threads.\n"
+	"      Requires a build with threading support.\n",
+	"  -k, --cache <path>\n"
+	"      Keeps compiled programs in the directory at <path> and reuses\n"
+	"      them as long as the program and its imports are unchanged.\n",
 	"  -l, --verbose\n"
 	"      Enables verbose output aka logging.\n",
+	"  -n, --nolint\n"
+	"      Skips the style checks for long lines and indentation while\n"
+	"      scanning, which speeds up compiling large sources.\n",
 	"  -o, --output\n"
 	"      Writes the output to the file at <path>.\n",
 	"  -p, --path  <value>\n"
@@ -135,6 +153,9 @@ static void parse_command_line_arguments(int argc, char *argv[]) {
 		case OPTION_PRINT_BYTECODE:
 			program_state.print_bytecode = true;
 			break;
+		case OPTION_SET_CACHE:
+			program_state.cache = tarot_optarg;
+			break;
 		case OPTION_FORMAT_AST:
 			program_state.format_sourcecode = true;
 			break;
@@ -154,9 +175,19 @@ static void parse_command_line_arguments(int argc, char *argv[]) {
 		case OPTION_SET_INPUT:
 			program_state.input = tarot_optarg;
 			break;
+		case OPTION_SET_JOBS:
+			if (strtol(tarot_optarg, NULL, 10) < 1) {
+				tarot_error("Invalid number of jobs: \"%s\"", tarot_optarg);
+				break;
+			}
+			program_state.num_jobs = strtol(tarot_optarg, NULL, 10);
+			break;
 		case OPTION_ENABLE_LOGGING:
 			tarot_enable_logging(true);
 			break;
+		case OPTION_SKIP_LINTING:
+			program_state.scan_mode = TAROT_SCAN_FAST;
+			break;
 		case OPTION_SET_OUTPUT:
 			program_state.output = tarot_optarg;
 			break;
@@ -212,13 +243,29 @@ static void run_program(void) {
 		return;
 	} else if (program_state.run_test) {
 		tarot_run_tests();
+		tarot_free_interned_strings();
 		print_runtime_information();
 		return;
 	}
 
 	if (match_filetype(program_state.input, ".rot")) {
-		program_state.ast = tarot_import(program_state.input);
-		program_state.bytecode = tarot_create_bytecode(program_state.ast);
+		/* Printing or formatting the tree requires compiling the sources */
+		if (
+			program_state.cache != NULL and
+			not program_state.print_ast and
+			not program_state.format_sourcecode
+		) {
+			program_state.bytecode = tarot_load_cached_bytecode(
+				program_state.cache, program_state.input
+			);
+		}
+		if (program_state.bytecode == NULL) {
+			program_state.ast = tarot_import(program_state.input, program_state.scan_mode);
+			program_state.bytecode = tarot_create_bytecode(program_state.ast);
+			if (program_state.cache != NULL and program_state.bytecode != NULL) {
+				tarot_cache_bytecode(program_state.cache, program_state.ast, program_state.bytecode);
+			}
+		}
 	} else if (match_filetype(program_state.input, ".bin")) {
 		program_state.bytecode = tarot_import_bytecode(program_state.input);
 	} else {
@@ -247,7 +294,15 @@ static void run_program(void) {
 	}
 
 	if (program_state.run_file) {
-		if (program_state.bytecode) {
+		if (program_state.bytecode and program_state.num_jobs > 1) {
+			struct tarot_virtual_machine *vm = tarot_create_virtual_machine(program_state.bytecode);
+			if (vm != NULL) {
+				if (tarot_is_fully_bound(vm)) {
+					tarot_attach_workers(vm, program_state.num_jobs);
+				}
+				tarot_free_virtual_machine(vm);
+			}
+		} else if (program_state.bytecode) {
 			tarot_execute_bytecode(program_state.bytecode);
 		} else {
 			tarot_error("Cannot execute bytecode!");
@@ -255,11 +310,16 @@ static void run_program(void) {
 	}
 
 	if (program_state.output) {
-		tarot_export_bytecode(program_state.output, program_state.bytecode);
+		if (program_state.bytecode) {
+			tarot_export_bytecode(program_state.output, program_state.bytecode);
+		} else {
+			tarot_error("Cannot export bytecode!");
+		}
 	}
 
 	tarot_free_node(program_state.ast);
 	tarot_free_bytecode(program_state.bytecode);
+	tarot_free_interned_strings();
 
 	print_runtime_information();
 }
@@ -0,0 +1,95 @@
+#define TAROT_SOURCE
+#include "tarot.h"
+
+static struct tarot_context default_context;
+
+/* The current context of the only OS thread, unless threading is available */
+static struct tarot_context *current_context = NULL;
+
+TAROT_INLINE
+struct tarot_context* tarot_default_context(void) {
+	return &default_context;
+}
+
+TAROT_INLINE
+struct tarot_context* tarot_current_context(void) {
+	struct tarot_context *context = current_context;
+	if (tarot_threading.get_context != NULL) {
+		context = tarot_threading.get_context();
+	}
+	return context != NULL ? context : &default_context;
+}
+
+TAROT_INLINE
+struct tarot_context* tarot_root_context(void) {
+	return tarot_current_context()->root;
+}
+
+struct tarot_context* tarot_enter_context(struct tarot_context *context) {
+	struct tarot_context *previous = tarot_current_context();
+	if (tarot_threading.set_context != NULL) {
+		tarot_threading.set_context(context);
+	} else {
+		current_context = context;
+	}
+	return previous;
+}
+
+void tarot_initialize_context(
+	struct tarot_context *context,
+	const struct tarot_platform_config *cfg
+) {
+	struct tarot_context *previous;
+	memset(context, 0, sizeof(*context));
+	context->root = context;
+	memcpy(&context->platform, cfg, sizeof(context->platform));
+	previous = tarot_enter_context(context);
+	tarot_open_stdout(cfg->cout);
+	tarot_open_stderr(cfg->cerr);
+	tarot_open_stdin(cfg->cin);
+	tarot_enter_context(previous);
+}
+
+/* Contexts are allocated from the platform directly, as tarot_malloc counts
+ * the allocation towards the current context */
+static struct tarot_context* allocate_context(
+	const struct tarot_platform_config *cfg
+) {
+	struct tarot_context *context = cfg->malloc(sizeof(*context));
+	assert(context != NULL);
+	return context;
+}
+
+struct tarot_context* tarot_create_context(
+	const struct tarot_platform_config *cfg
+) {
+	struct tarot_context *context;
+	if (cfg == NULL) {
+		cfg = &tarot_current_context()->platform;
+	}
+	context = allocate_context(cfg);
+	tarot_initialize_context(context, cfg);
+	return context;
+}
+
+struct tarot_context* tarot_fork_context(void) {
+	struct tarot_context *root = tarot_root_context();
+	struct tarot_context *context = allocate_context(&root->platform);
+	memset(context, 0, sizeof(*context));
+	context->root = root;
+	memcpy(&context->platform, &root->platform, sizeof(context->platform));
+	return context;
+}
+
+void tarot_free_context(struct tarot_context *context) {
+	if (context != NULL) {
+		assert(context != &default_context);
+		assert(context != tarot_current_context());
+		assert(context->stream_index == 0);
+		tarot_release_allocation_cache(context);
+		if (context->temp_nodes != NULL) {
+			context->platform.free(context->temp_nodes);
+		}
+		context->platform.free(context);
+	}
+}
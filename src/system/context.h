@@ -0,0 +1,127 @@
+#ifndef TAROT_CONTEXT_H
+#define TAROT_CONTEXT_H
+
+/**
+ * A context holds the state the compiler and the virtual machine would
+ * otherwise share across the whole process: the platform interface, the
+ * allocation and error statistics, the standard iostreams and the scratch
+ * buffers. Each OS thread runs in a context of its own choosing, so that
+ * several programs can be compiled and run at once on different threads.
+ * Threads that have not entered a context run in the default context set
+ * up by tarot_initialize().
+ */
+
+#include "defines.h"
+#include "datatypes/string.h"
+#include "system/iostream.h"
+#include "system/platform.h"
+
+struct tarot_allocation_cache;
+struct tarot_context;
+struct tarot_node;
+struct tarot_node_arena;
+
+/**
+ * Creates a context for the given platform interface. Passing NULL copies
+ * the platform interface of the current context.
+ */
+extern struct tarot_context* tarot_create_context(
+	const struct tarot_platform_config *cfg
+);
+
+/**
+ * Frees a context. It must not be the current context of any thread and
+ * all of its iostreams must have been closed.
+ */
+extern void tarot_free_context(struct tarot_context *context);
+
+/**
+ * Makes the given context the current context of the calling OS thread and
+ * returns the previous one. Passing NULL returns to the default context.
+ * Running contexts on several OS threads requires tarot_initialize_threading.
+ */
+extern struct tarot_context* tarot_enter_context(struct tarot_context *context);
+
+/**
+ * Returns the context of the calling OS thread.
+ */
+extern struct tarot_context* tarot_current_context(void);
+
+/* Only available to tarot source files */
+#ifdef TAROT_SOURCE
+
+struct tarot_context {
+	/**
+	 * The context the statistics and the standard iostreams belong to. A
+	 * worker context forked off for an OS thread of a virtual machine has
+	 * scratch buffers of its own, but shares everything else with its root.
+	 * Contexts created by tarot_create_context are their own root.
+	 */
+	struct tarot_context *root;
+	struct tarot_platform_config platform;
+
+	/* Allocation statistics, guarded by the allocation lock if set */
+	struct tarot_allocation_cache *cache; /**< acquired on first use */
+	void *allocation_lock;
+	size_t num_allocations;
+	size_t num_reallocations;
+	size_t num_frees;
+	size_t allocated_memory;
+	size_t total_memory;
+
+	/* Error statistics */
+	size_t num_errors;
+	size_t num_warnings;
+	void (*error_handler)(void *data);
+	void *error_data;
+
+	/* Standard iostreams */
+	struct tarot_iostream cin;
+	struct tarot_iostream cout;
+	struct tarot_iostream cerr;
+
+	/* Scratch buffers */
+	struct tarot_iostream streams[TAROT_MAX_STREAMS]; /**< open iostreams */
+	size_t stream_index;
+	struct tarot_iostream dummy;
+	char path[TAROT_MAX_PATH];
+	char line[TAROT_MAX_LINE];
+	struct tarot_string const_strings[8];
+	uint8_t const_string_index;
+	struct tarot_node *temp_nodes; /**< allocated on first use */
+	uint8_t temp_node_index;
+
+	/* Compiler state */
+	struct tarot_node_arena *node_arena;
+	size_t num_nodes;
+	struct tarot_interned_strings interned;
+};
+
+/**
+ * Returns the context of threads that have not entered one.
+ */
+extern struct tarot_context* tarot_default_context(void);
+
+/**
+ * Resets a context and opens its standard iostreams on the handles of the
+ * given platform interface.
+ */
+extern void tarot_initialize_context(
+	struct tarot_context *context,
+	const struct tarot_platform_config *cfg
+);
+
+/**
+ * Returns the root of the current context.
+ */
+extern struct tarot_context* tarot_root_context(void);
+
+/**
+ * Creates a worker context sharing the root of the current context. It is
+ * freed with tarot_free_context.
+ */
+extern struct tarot_context* tarot_fork_context(void);
+
+#endif /* TAROT_SOURCE */
+
+#endif /* TAROT_CONTEXT_H */
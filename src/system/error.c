@@ -2,8 +2,6 @@
 #include "tarot.h"
 
 static bool warnings_enabled = true;
-static size_t num_errors = 0;
-static size_t num_warnings = 0;
 
 TAROT_INLINE
 void tarot_enable_warnings(bool enable) {
@@ -12,25 +10,24 @@ void tarot_enable_warnings(bool enable) {
 
 TAROT_INLINE
 size_t tarot_num_errors(void) {
-	return num_errors;
+	return tarot_root_context()->num_errors;
 }
 
 TAROT_INLINE
 size_t tarot_num_warnings(void) {
-	return num_warnings;
+	return tarot_root_context()->num_warnings;
 }
 
-static void (*error_handler)(void *data) = NULL;
-static void *error_data = NULL;
-
 void tarot_register_error_handler(void (*f)(void *data), void *data) {
-	error_handler = f;
-	error_data = data;
+	struct tarot_context *context = tarot_current_context();
+	context->error_handler = f;
+	context->error_data = data;
 }
 
 static void invoke_error_handler(void) {
-	if (error_handler != NULL) {
-		error_handler(error_data);
+	struct tarot_context *context = tarot_current_context();
+	if (context->error_handler != NULL) {
+		context->error_handler(context->error_data);
 	}
 }
 
@@ -47,7 +44,7 @@ static void print_position(struct tarot_stream_position *pos) {
 }
 
 void tarot_begin_error(struct tarot_stream_position *position) {
-	num_errors++;
+	size_t num_errors = ++tarot_root_context()->num_errors;
 	tarot_fprintf(tarot_stderr,
 		"[%s%sERROR%s : %d] ",
 		tarot_color_string(TAROT_COLOR_RED),
@@ -94,9 +91,9 @@ void tarot_error_at(
 
 void tarot_warning(const char *format, ...) {
 	if (warnings_enabled) {
+		size_t num_warnings = ++tarot_root_context()->num_warnings;
 		va_list ap;
 		assert(format != NULL);
-		num_warnings++;
 		tarot_fprintf(
 			tarot_stderr,
 			"[%s%sWARNING%s : %d] ",
@@ -119,10 +116,10 @@ void tarot_warning_at(
 	const char *format, ...
 ) {
 	if (warnings_enabled) {
+		size_t num_warnings = ++tarot_root_context()->num_warnings;
 		va_list ap;
 		assert(position != NULL);
 		assert(format != NULL);
-		num_warnings++;
 		tarot_fprintf(
 			tarot_stderr,
 			"[%s%sWARNING%s : %d] ",
@@ -0,0 +1,194 @@
+#define TAROT_SOURCE
+#include "tarot.h"
+
+#define digits_in(type) ((sizeof(type)*CHAR_BIT-1)*28/93+1)
+
+/* The buffer being formatted into, bytes beyond its size are only counted */
+struct output {
+	char *buffer;
+	size_t size;
+	size_t length;
+};
+
+static void write_to_buffer(void *sink, const char *bytes, size_t n) {
+	struct output *output = sink;
+	if (output->length < output->size) {
+		size_t room = output->size - output->length;
+		memcpy(output->buffer + output->length, bytes, n < room ? n : room);
+	}
+	output->length += n;
+}
+
+size_t tarot_format_unsigned(
+	char *buffer,
+	size_t number,
+	unsigned int base,
+	unsigned int width
+) {
+	static const char hex[] = "0123456789ABCDEF";
+	char digits[TAROT_NUMBER_TEXT_SIZE];
+	size_t index = lengthof(digits);
+	size_t length;
+	assert(buffer != NULL);
+	do {
+		digits[--index] = hex[number % base];
+		number /= base;
+	} while (number > 0);
+	while ((width > lengthof(digits) - index) and (index > 1)) {
+		digits[--index] = '0';
+	}
+	length = lengthof(digits) - index;
+	memcpy(buffer, digits + index, length);
+	buffer[length] = '\0';
+	return length;
+}
+
+size_t tarot_format_signed(char *buffer, long int number) {
+	assert(buffer != NULL);
+	if (number < 0) {
+		buffer[0] = '-';
+		return 1 + tarot_format_unsigned(buffer + 1, -(size_t)number, 10, 0);
+	}
+	return tarot_format_unsigned(buffer, number, 10, 0);
+}
+
+/* Calculates 10^n */
+static long int ipow10(long int n) {
+	long int result = 1;
+	if (n > 0) {
+		for (result = 10; n > 1; n--) {
+			result *= 10;
+		}
+	}
+	return result;
+}
+
+size_t tarot_format_float(char *buffer, double number) {
+	double factor;
+	long int lead;
+	long int fraction;
+	int n;
+	unsigned int num_zeros;
+	size_t length;
+	assert(buffer != NULL);
+	factor = (double)ipow10(digits_in(int) - 1);
+	lead = (long)number;
+	fraction = (size_t)fabs((number - (double)lead) * factor);
+	num_zeros = digits_in(int) - 1;
+	if (fraction == 0) {
+		num_zeros = 1;
+	}
+	for (n = fraction; n > 0; n /= 10) {
+		num_zeros--;
+	}
+	while ((fraction > 0) and (fraction % 10 == 0)) {
+		fraction /= 10;
+	}
+	length = tarot_format_signed(buffer, lead);
+	buffer[length++] = '.';
+	while (num_zeros-- > 0) {
+		buffer[length++] = '0';
+	}
+	return length + tarot_format_unsigned(buffer + length, fraction, 10, 0);
+}
+
+size_t tarot_vformat_to(
+	tarot_format_writer write,
+	void *sink,
+	const char *format,
+	va_list *ap
+) {
+	char number[TAROT_NUMBER_TEXT_SIZE];
+	const char *text;
+	unsigned int width;
+	size_t length = 0;
+	size_t n;
+	char ch;
+	assert(write != NULL);
+	assert(format != NULL);
+	assert(ap != NULL);
+	while ((ch = *format++)) {
+		if (ch != '%') {
+			/* Plain text up to the next conversion is written at once */
+			text = format - 1;
+			while (*format and *format != '%') {
+				format++;
+			}
+			n = format - text;
+			write(sink, text, n);
+			length += n;
+			continue;
+		}
+		width = 0;
+		if (*format == '*') {
+			width = va_arg(*ap, unsigned int);
+			format++;
+		}
+		text = number;
+		switch ((ch = *format++)) {
+			default:
+				number[0] = ch;
+				n = 1;
+				break;
+			case '\0':
+				format--;
+				n = 0;
+				break;
+			case 's':
+				text = va_arg(*ap, const char*);
+				n = strlen(text);
+				break;
+			case 'c':
+				number[0] = (char)va_arg(*ap, int);
+				n = 1;
+				break;
+			case 'd':
+				n = tarot_format_signed(number, va_arg(*ap, int));
+				break;
+			case 'f':
+				n = tarot_format_float(number, va_arg(*ap, double));
+				break;
+			case 'b':
+				n = tarot_format_unsigned(number, va_arg(*ap, int), 2, 0);
+				break;
+			case 'p':
+				n = tarot_format_unsigned(number, (size_t)va_arg(*ap, void*), 16, 0);
+				break;
+			case 'u':
+				n = tarot_format_unsigned(number, va_arg(*ap, unsigned int), 10, width);
+				break;
+			case 'x':
+				n = tarot_format_unsigned(number, va_arg(*ap, int), 16, width);
+				break;
+			case 'z':
+				if (*format == 'u') {
+					format++;
+					n = tarot_format_unsigned(number, va_arg(*ap, size_t), 10, width);
+				} else {
+					n = tarot_format_signed(number, va_arg(*ap, long));
+				}
+				break;
+		}
+		write(sink, text, n);
+		length += n;
+	}
+	return length;
+}
+
+size_t tarot_vformat(
+	char *buffer,
+	size_t size,
+	const char *format,
+	va_list *ap
+) {
+	struct output output;
+	assert(buffer != NULL or size == 0);
+	output.buffer = buffer;
+	output.size = size;
+	output.length = 0;
+	tarot_vformat_to(write_to_buffer, &output, format, ap);
+	if (output.length < output.size) {
+		output.buffer[output.length] = '\0';
+	}
+	return output.length;
+}
@@ -0,0 +1,52 @@
+#ifndef TAROT_FORMAT_H
+#define TAROT_FORMAT_H
+
+#include "defines.h"
+
+/* Size of a buffer large enough for any number formatted below */
+#define TAROT_NUMBER_TEXT_SIZE (sizeof(size_t) * CHAR_BIT + 2)
+
+/**
+ * Formats the printf format string straight into the buffer, without
+ * going through an iostream. At most size bytes are written, followed by
+ * a terminating null character if it still fits. Returns the length of
+ * the complete formatted text, so a return value of size or more means
+ * the text was cut short. With a size of 0 the text is merely measured
+ * and the buffer may be NULL.
+ * Understands %b %c %d %f %p %s %u %x %zd %zu and a * width for %u %x %zu.
+ */
+extern size_t tarot_vformat(
+	char *buffer,
+	size_t size,
+	const char *format,
+	va_list *ap
+);
+
+/* Receives the formatted text piece by piece */
+typedef void (*tarot_format_writer)(void *sink, const char *bytes, size_t n);
+
+/**
+ * Formats the printf format string like tarot_vformat, but hands the text
+ * to write instead of storing it in a buffer. Returns its length.
+ */
+extern size_t tarot_vformat_to(
+	tarot_format_writer write,
+	void *sink,
+	const char *format,
+	va_list *ap
+);
+
+/**
+ * Writes the number into the buffer of TAROT_NUMBER_TEXT_SIZE bytes and
+ * returns its length. Unsigned numbers are padded with zeros to width.
+ */
+extern size_t tarot_format_unsigned(
+	char *buffer,
+	size_t number,
+	unsigned int base,
+	unsigned int width
+);
+extern size_t tarot_format_signed(char *buffer, long int number);
+extern size_t tarot_format_float(char *buffer, double number);
+
+#endif /* TAROT_FORMAT_H */
@@ -1,41 +1,21 @@
 #define TAROT_SOURCE
 #include "tarot.h"
 
-#define digits_in(type) ((sizeof(type)*CHAR_BIT-1)*28/93+1)
-
-struct tarot_iostream {
-	union {
-		void *file;
-		char *memory;
-		struct tarot_string **string;
-	} as;
-	struct tarot_stream_position position;
-	size_t offset;
-	enum {
-		TAROT_DUMBSTREAM,  /**< operates on nothing  */
-		TAROT_FILESTREAM,  /**< operates on a file   */
-		TAROT_MEMSTREAM,   /**< operates on a buffer */
-		TAROT_STRINGSTREAM /**< operates on a string */
-	} kind;
-	enum tarot_stream_mode mode;
-	int ch;               /**< current character */
-	bool eof;             /**< end of file indicator */
-	uint8_t indentation;  /**< indentation level */
-	uint8_t indent_width; /**< number of characters to indent with */
-	uint8_t tabsize;      /**< size of a tab in spaces */
-};
-
-static struct tarot_iostream streams[8];
-static size_t stream_index;
+/* Each context has a stack of its own, so that OS threads running in
+ * contexts of their own can open and close iostreams independently */
 static struct tarot_iostream* push_stream(void) {
-	assert(stream_index < lengthof(streams));
-	memset(&streams[stream_index], 0, sizeof(streams[stream_index]));
-	return &streams[stream_index++];
+	struct tarot_context *context = tarot_current_context();
+	struct tarot_iostream *stream;
+	assert(context->stream_index < lengthof(context->streams));
+	stream = &context->streams[context->stream_index++];
+	memset(stream, 0, sizeof(*stream));
+	return stream;
 }
 static void pop_stream(struct tarot_iostream *stream) {
-	assert(stream_index > 0);
-	--stream_index;
-	assert(&streams[stream_index] == stream);
+	struct tarot_context *context = tarot_current_context();
+	assert(context->stream_index > 0);
+	--context->stream_index;
+	assert(&context->streams[context->stream_index] == stream);
 	/* Assert fails if iostreams closed out of order */
 }
 
@@ -71,16 +51,20 @@ const char* tarot_stream_mode_string(enum tarot_stream_mode mode) {
 }
 
 
-static struct tarot_iostream tarot__stdout;
-struct tarot_iostream* const tarot_stdout = &tarot__stdout;
-
-
-static struct tarot_iostream tarot__stdin;
-struct tarot_iostream* const tarot_stdin = &tarot__stdin;
+TAROT_INLINE
+struct tarot_iostream* tarot_get_stdout(void) {
+	return &tarot_root_context()->cout;
+}
 
+TAROT_INLINE
+struct tarot_iostream* tarot_get_stdin(void) {
+	return &tarot_root_context()->cin;
+}
 
-static struct tarot_iostream tarot__stderr;
-struct tarot_iostream* const tarot_stderr = &tarot__stderr;
+TAROT_INLINE
+struct tarot_iostream* tarot_get_stderr(void) {
+	return &tarot_root_context()->cerr;
+}
 
 
 void tarot_open_stdout(void *fileptr) {
@@ -118,9 +102,9 @@ static const char* default_path_prefix = NULL;
 
 
 static char* fullpath(const char *path) {
-	static char buffer[TAROT_MAX_PATH];
+	char *buffer = tarot_current_context()->path;
 	assert(path != NULL);
-	memset(buffer, 0, sizeof(buffer));
+	memset(buffer, 0, TAROT_MAX_PATH);
 	if (default_path_prefix != NULL) {
 		strcpy(buffer, default_path_prefix);
 	}
@@ -202,14 +186,14 @@ struct tarot_iostream* tarot_fstropen(
 
 
 struct tarot_iostream* tarot_fdumbopen(enum tarot_stream_mode mode) {
-	static struct tarot_iostream stream;
-	memset(&stream, 0, sizeof(stream));
-	stream.kind = TAROT_DUMBSTREAM;
-	stream.mode = mode;
-	stream.position.path = "<dummy>";
-	stream.position.line = 1;
-	stream.position.column = 1;
-	return &stream;
+	struct tarot_iostream *stream = &tarot_current_context()->dummy;
+	memset(stream, 0, sizeof(*stream));
+	stream->kind = TAROT_DUMBSTREAM;
+	stream->mode = mode;
+	stream->position.path = "<dummy>";
+	stream->position.line = 1;
+	stream->position.column = 1;
+	return stream;
 }
 
 
@@ -289,7 +273,8 @@ static void print_char(struct tarot_iostream *stream, int ch) {
 	} else if (stream->kind == TAROT_MEMSTREAM) {
 		stream->ch = *stream->as.memory++ = ch;
 	} else if (stream->kind == TAROT_STRINGSTREAM) {
-		tarot_string_append(stream->as.string, "%c", ch);
+		*tarot_string_reserve(stream->as.string, 1) = ch;
+		tarot_string_commit(*stream->as.string, 1);
 		stream->ch = ch;
 	}
 
@@ -400,6 +385,24 @@ static void append_byte(struct buffer *buffer, uint8_t byte) {
 	buffer->data[buffer->index++] = byte;
 }
 
+bool tarot_file_exists(const char *path) {
+	void *fileptr = tarot_platform.fopen(fullpath(path), "r");
+	if (fileptr != NULL) {
+		tarot_platform.fclose(fileptr);
+		return true;
+	}
+	return false;
+}
+
+bool tarot_file_writable(const char *path) {
+	void *fileptr = tarot_platform.fopen(fullpath(path), "w");
+	if (fileptr != NULL) {
+		tarot_platform.fclose(fileptr);
+		return true;
+	}
+	return false;
+}
+
 void* tarot_read_file(const char *path, size_t *size) {
 	void *contents = NULL;
 	struct tarot_iostream *stream = tarot_fopen(path, TAROT_INPUT);
@@ -407,8 +410,7 @@ void* tarot_read_file(const char *path, size_t *size) {
 		char ch;
 		struct buffer buffer;
 		memset(&buffer, 0, sizeof(buffer));
-		while (not tarot_feof(stream)) {
-			ch = tarot_fgetc(stream);
+		while ((ch = tarot_fgetc(stream)), not tarot_feof(stream)) {
 			append_byte(&buffer, ch);
 		}
 		ch = '\0';
@@ -486,154 +488,28 @@ size_t tarot_vprintf(const char *format, va_list *ap) {
 	return bytes_written;
 }
 
-static void print_unsigned_integer(
-	struct tarot_iostream *stream,
-	size_t number,
-	unsigned int base,
-	unsigned int width
-) {
-	static const char hex[] = "0123456789ABCDEF";
-	char buffer[digits_in(size_t) + 1];
-	unsigned int index = lengthof(buffer);
-	unsigned int count = 0;
-	assert(stream != NULL);
-	buffer[--index] = '\0';
-	do {
-		buffer[--index] = hex[number % base];
-		number /= base;
-		count++;
-	} while ((number > 0) and (index > 0));
-	while ((width > count) and (index > 0)) {
-		buffer[--index] = '0';
-		width--;
-	}
-	tarot_fputs(stream, buffer + index);
-}
-
-static void print_integer(
-	struct tarot_iostream *stream,
-	long int number,
-	unsigned int base
-) {
-	size_t unsigned_number;
-	assert(stream != NULL);
-	if (number < 0) {
-		unsigned_number = -number;
-		tarot_fputc(stream, '-');
-	} else {
-		unsigned_number = number;
-	}
-	print_unsigned_integer(stream, unsigned_number, base, 0);
-}
-
-/* Calculates 10^n */
-static long int ipow10(long int n) {
-	long int result = 1;
-	if (n > 0) {
-		for (result = 10; n > 1; n--) {
-			result *= 10;
-		}
-	}
-	return result;
-}
-
-static void print_float(
-	struct tarot_iostream *stream,
-	double number
-) {
-	double factor;
-	long int lead;
-	long int fraction;
-	int n;
-	unsigned int num_zeros;
-	assert(stream != NULL);
-	factor = (double)ipow10(digits_in(int) - 1);
-	lead = (long)number;
-	fraction = (size_t)fabs((number - (double)lead) * factor);
-	num_zeros = digits_in(int) - 1;
-	if (fraction == 0) {
-		num_zeros = 1;
-	}
-	for (n = fraction; n > 0; n /= 10) {
-		num_zeros--;
-	}
-	while ((fraction > 0) and (fraction % 10 == 0)) {
-		fraction /= 10;
-	}
-	print_integer(stream, lead, 10);
-	tarot_fputc(stream, '.');
-	while (num_zeros-- > 0) {
-		tarot_fputc(stream, '0');
-	}
-	print_unsigned_integer(stream, fraction, 10, 0);
-}
-
 void tarot_print_float(
 	struct tarot_iostream *stream,
 	double value
 ) {
-	print_float(stream, value);
+	char buffer[TAROT_NUMBER_TEXT_SIZE];
+	assert(stream != NULL);
+	tarot_format_float(buffer, value);
+	tarot_fputs(stream, buffer);
 }
 
 void tarot_print_short(
 	struct tarot_iostream *stream,
 	int32_t value
 ) {
-	print_integer(stream, value, 10);
+	char buffer[TAROT_NUMBER_TEXT_SIZE];
+	assert(stream != NULL);
+	tarot_format_signed(buffer, value);
+	tarot_fputs(stream, buffer);
 }
 
-static const char* print_formatted(
-	struct tarot_iostream *stream,
-	const char *format,
-	va_list *ap,
-	unsigned int width
-) {
-	int ch;
-	assert(stream != NULL);
-	assert(format != NULL);
-	assert(ap != NULL);
-	switch((ch = *format++)) {
-		default:
-			tarot_fputc(stream, ch);
-			break;
-		case '*':
-			width = va_arg(*ap, unsigned int);
-			format = print_formatted(stream, format, ap, width);
-			break;
-		case 'b':
-			print_unsigned_integer(stream, va_arg(*ap, int), 2, 0);
-			break;
-		case 'c':
-			tarot_fputc(stream, va_arg(*ap, int));
-			break;
-		case 'd':
-			print_integer(stream, va_arg(*ap, int), 10);
-			break;
-		case 'f':
-			print_float(stream, va_arg(*ap, double));
-			break;
-		case 's':
-			tarot_fputs(stream, va_arg(*ap, void*));
-			break;
-		case 'p':
-			print_unsigned_integer(stream, (size_t)va_arg(*ap, void*), 16, 0);
-			break;
-		case 'u':
-			print_unsigned_integer(stream, va_arg(*ap, unsigned int), 10, width);
-			break;
-		case 'x':
-			print_unsigned_integer(stream, va_arg(*ap, int), 16, width);
-			break;
-		case 'z':
-			if (*format == 'u') {
-				format++;
-				print_unsigned_integer(stream, va_arg(*ap, size_t), 10, width);
-			} else {
-				print_integer(stream, va_arg(*ap, long), 10);
-			}
-			break;
-	}
-	return format;
+static void write_to_stream(void *sink, const char *bytes, size_t n) {
+	tarot_fwrite(sink, bytes, n);
 }
 
 size_t tarot_vfprintf(
@@ -641,20 +517,8 @@ size_t tarot_vfprintf(
 	const char *format,
 	va_list *ap
 ) {
-	size_t bytes_written;
-	int ch;
 	assert(stream != NULL);
-	assert(format != NULL);
-	bytes_written = stream->offset;
-	while ((ch = *format++)) {
-		if (ch == '%') {
-			format = print_formatted(stream, format, ap, 0);
-		} else {
-			tarot_fputc(stream, ch);
-		}
-	}
-	bytes_written = stream->offset - bytes_written;
-	return bytes_written;
+	return tarot_vformat_to(write_to_stream, stream, format, ap);
 }
 
 size_t tarot_fstrlen(const char *format, ...) {
@@ -668,10 +532,7 @@ size_t tarot_fstrlen(const char *format, ...) {
 }
 
 size_t tarot_vfstrlen(const char *format, va_list *ap) {
-	struct tarot_iostream *stream = tarot_fdumbopen(TAROT_OUTPUT);
-	size_t bytes_required = tarot_vfprintf(stream, format, ap);
-	tarot_fclose(stream);
-	return bytes_required;
+	return tarot_vformat(NULL, 0, format, ap);
 }
 
 static bool colored_output_enabled = false;
@@ -726,13 +587,9 @@ void tarot_set_indent_width(
 }
 
 const char* tarot_getline(struct tarot_iostream *stream) {
-	static char buffer[128];
-	static size_t buffersize = 0;
+	char *buffer = tarot_current_context()->line;
 	size_t i;
-	if (buffersize == 0) {
-		buffersize = lengthof(buffer);
-	}
-	for (i = 0; i < buffersize; i++) {
+	for (i = 0; i < TAROT_MAX_LINE - 1; i++) {
 		int ch = tarot_fgetc(stream);
 		if (ch == '\n') {
 			break;
@@ -35,14 +35,15 @@ enum tarot_stream_mode {
 
 extern const char* tarot_stream_mode_string(enum tarot_stream_mode mode);
 
-/* An iostream pointer initialized with the platforms stdout handle */
-extern struct tarot_iostream* const tarot_stdout;
+/* The iostreams of the current context, initialized with its platforms
+ * stdout, stdin and stderr handles */
+extern struct tarot_iostream* tarot_get_stdout(void);
+extern struct tarot_iostream* tarot_get_stdin(void);
+extern struct tarot_iostream* tarot_get_stderr(void);
 
-/* An iostream pointer initialized with the platforms stdin handle */
-extern struct tarot_iostream* const tarot_stdin;
-
-/* An iostream pointer initialized with the platforms stderr handle */
-extern struct tarot_iostream* const tarot_stderr;
+#define tarot_stdout tarot_get_stdout()
+#define tarot_stdin  tarot_get_stdin()
+#define tarot_stderr tarot_get_stderr()
 
 extern void tarot_open_stdout(void *fileptr);
 extern void tarot_open_stdin (void *fileptr);
@@ -92,6 +93,11 @@ extern void tarot_hexdump(
 	size_t length
 );
 
+/* Checks whether the file can be opened for reading, without raising an error */
+extern bool tarot_file_exists(const char *path);
+/* Checks whether the file can be opened for writing, without raising an
+ * error. An existing file is truncated */
+extern bool tarot_file_writable(const char *path);
 extern void* tarot_read_file(const char *path, size_t *size);
 extern int tarot_write_to_file(
 	const char *path,
@@ -160,4 +166,39 @@ extern void tarot_set_indent_width(
 
 extern const char* tarot_getline(struct tarot_iostream *stream);
 
+/* Only available to tarot source files */
+#ifdef TAROT_SOURCE
+
+#ifndef TAROT_MAX_LINE
+/** Maximum length of a line read by tarot_getline */
+#define TAROT_MAX_LINE 128
+#endif
+
+/** Number of iostreams that can be open at once */
+#define TAROT_MAX_STREAMS 8
+
+struct tarot_iostream {
+	union {
+		void *file;
+		char *memory;
+		struct tarot_string **string;
+	} as;
+	struct tarot_stream_position position;
+	size_t offset;
+	enum {
+		TAROT_DUMBSTREAM,  /**< operates on nothing  */
+		TAROT_FILESTREAM,  /**< operates on a file   */
+		TAROT_MEMSTREAM,   /**< operates on a buffer */
+		TAROT_STRINGSTREAM /**< operates on a string */
+	} kind;
+	enum tarot_stream_mode mode;
+	int ch;               /**< current character */
+	bool eof;             /**< end of file indicator */
+	uint8_t indentation;  /**< indentation level */
+	uint8_t indent_width; /**< number of characters to indent with */
+	uint8_t tabsize;      /**< size of a tab in spaces */
+};
+
+#endif /* TAROT_SOURCE */
+
 #endif /* TAROT_IOSTREAM_H */
@@ -1,32 +1,328 @@
 #define TAROT_SOURCE
 #include "tarot.h"
 
-/* DIAGNOSTICS */
+/* CACHES */
+
+/* Blocks of up to CACHED_SIZE bytes are rounded up to a multiple of
+ * CLASS_SIZE and kept in the free list of their size class once freed */
+#define CLASS_SIZE 16
+#define NUM_CLASSES 16
+#define CACHED_SIZE (CLASS_SIZE * NUM_CLASSES)
+
+/* Number of free blocks a cache keeps per size class */
+#define CACHED_BLOCKS 128
+
+/* Number of operations after which a cache flushes its statistics */
+#define FLUSH_INTERVAL 256
 
-static size_t num_allocations = 0;
-static size_t num_reallocations = 0;
-static size_t num_frees = 0;
-static size_t allocated_memory = 0;
-static size_t total_memory = 0;
+/**
+ * Each context allocates through a cache of its own, so that the OS threads
+ * of a virtual machine neither share free lists nor statistics. A block
+ * freed by another thread is handed back to the remote list of the cache
+ * that allocated it. Blocks often outlive the context that allocated them,
+ * so the caches are shared by the whole process and only freed on exit. A
+ * cache released by its context is handed out to the next context.
+ */
+struct tarot_allocation_cache {
+	struct block_header *free_blocks[NUM_CLASSES];
+	size_t num_free_blocks[NUM_CLASSES];
+	struct block_header *remote_blocks; /* guarded by the cache lock */
+	struct tarot_allocation_cache *next;
+	bool is_used; /* by a context, blocks freed while unused are adopted */
+	/* Statistics not yet flushed to the root context. The amount of
+	 * allocated memory wraps around if the cache freed more than it
+	 * allocated. */
+	size_t num_allocations;
+	size_t num_reallocations;
+	size_t num_frees;
+	size_t allocated_memory;
+	size_t peak_memory; /* highest amount of allocated memory */
+	size_t num_operations;
+};
 
+/* Free blocks are linked through their first bytes */
 TAROT_INLINE
-size_t tarot_num_allocations(void) {
-	return num_allocations;
+static struct block_header** next_block(struct block_header *header) {
+	return end_of_struct(header);
 }
 
 TAROT_INLINE
-size_t tarot_num_reallocations(void) {
-	return num_reallocations;
+static size_t size_class(size_t size) {
+	return size > 0 ? (size - 1) / CLASS_SIZE : 0;
 }
 
+/* Returns the size of the memory backing a block of the given size */
 TAROT_INLINE
-size_t tarot_num_frees(void) {
-	return num_frees;
+static size_t capacity_of(size_t size) {
+	return size > CACHED_SIZE ? size : (size_class(size) + 1) * CLASS_SIZE;
+}
+
+static struct tarot_allocation_cache *caches = NULL;
+
+/* Guards the list of caches and their remote lists, NULL without threading */
+static void *cache_lock = NULL;
+
+TAROT_INLINE
+static void lock_caches(void) {
+	if (cache_lock != NULL) {
+		tarot_threading.lock(cache_lock);
+	}
+}
+
+TAROT_INLINE
+static void unlock_caches(void) {
+	if (cache_lock != NULL) {
+		tarot_threading.unlock(cache_lock);
+	}
+}
+
+void tarot_initialize_allocation_caches(void) {
+	assert(cache_lock == NULL);
+	cache_lock = tarot_threading.create_mutex();
+}
+
+TAROT_INLINE
+static void lock_statistics(struct tarot_context *context) {
+	if (context->allocation_lock != NULL) {
+		tarot_threading.lock(context->allocation_lock);
+	}
+}
+
+TAROT_INLINE
+static void unlock_statistics(struct tarot_context *context) {
+	if (context->allocation_lock != NULL) {
+		tarot_threading.unlock(context->allocation_lock);
+	}
+}
+
+/* Hands out an unused cache, creating one if there is none */
+static struct tarot_allocation_cache* acquire_cache(struct tarot_context *context) {
+	struct tarot_allocation_cache *cache;
+	lock_caches();
+	cache = caches;
+	while (cache != NULL and cache->is_used) {
+		cache = cache->next;
+	}
+	if (cache == NULL) {
+		cache = context->platform.malloc(sizeof(*cache));
+		assert(cache != NULL);
+		memset(cache, 0, sizeof(*cache));
+		cache->next = caches;
+		caches = cache;
+	}
+	cache->is_used = true;
+	unlock_caches();
+	return cache;
+}
+
+static void flush_statistics(
+	struct tarot_context *root,
+	struct tarot_allocation_cache *cache
+) {
+	size_t peak_memory;
+	lock_statistics(root);
+	root->num_allocations += cache->num_allocations;
+	root->num_reallocations += cache->num_reallocations;
+	root->num_frees += cache->num_frees;
+	/* The peak of the cache on top of what was allocated before. Frees
+	 * flushed ahead of their allocations wrap the amount around. */
+	peak_memory = root->allocated_memory + cache->peak_memory;
+	if (peak_memory <= (size_t)-1 / 2 and peak_memory > root->total_memory) {
+		root->total_memory = peak_memory;
+	}
+	root->allocated_memory += cache->allocated_memory;
+	unlock_statistics(root);
+	cache->num_allocations = 0;
+	cache->num_reallocations = 0;
+	cache->num_frees = 0;
+	cache->allocated_memory = 0;
+	cache->peak_memory = 0;
+	cache->num_operations = 0;
+}
+
+void tarot_release_allocation_cache(struct tarot_context *context) {
+	struct tarot_allocation_cache *cache = context->cache;
+	if (cache != NULL) {
+		flush_statistics(context->root, cache);
+		lock_caches();
+		cache->is_used = false;
+		unlock_caches();
+		context->cache = NULL;
+	}
 }
 
+static void free_block_list(
+	struct tarot_context *context,
+	struct block_header *header
+) {
+	while (header != NULL) {
+		struct block_header *next = *next_block(header);
+		context->platform.free(header);
+		header = next;
+	}
+}
+
+void tarot_free_allocation_caches(void) {
+	struct tarot_context *context = tarot_default_context();
+	struct tarot_allocation_cache *cache;
+	size_t i;
+	tarot_release_allocation_cache(context);
+	while ((cache = caches) != NULL) {
+		caches = cache->next;
+		for (i = 0; i < NUM_CLASSES; i++) {
+			free_block_list(context, cache->free_blocks[i]);
+		}
+		free_block_list(context, cache->remote_blocks);
+		context->platform.free(cache);
+	}
+	if (cache_lock != NULL) {
+		tarot_threading.free_mutex(cache_lock);
+		cache_lock = NULL;
+	}
+}
+
+/* Returns the cache of the current context, acquiring one on first use */
 TAROT_INLINE
+static struct tarot_allocation_cache* local_cache(struct tarot_context *context) {
+	if (context->cache == NULL) {
+		context->cache = acquire_cache(context);
+	}
+	return context->cache;
+}
+
+/* Raises the peak once the cache allocated more than it freed */
+TAROT_INLINE
+static void count_memory(struct tarot_allocation_cache *cache) {
+	if (
+		cache->allocated_memory <= (size_t)-1 / 2 and
+		cache->allocated_memory > cache->peak_memory
+	) {
+		cache->peak_memory = cache->allocated_memory;
+	}
+}
+
+static void count_operation(
+	struct tarot_context *context,
+	struct tarot_allocation_cache *cache
+) {
+	if (++cache->num_operations >= FLUSH_INTERVAL) {
+		flush_statistics(context->root, cache);
+	}
+}
+
+/* Moves the blocks other threads handed back into the free lists */
+static void collect_remote_blocks(
+	struct tarot_context *context,
+	struct tarot_allocation_cache *cache
+) {
+	struct block_header *header;
+	lock_caches();
+	header = cache->remote_blocks;
+	cache->remote_blocks = NULL;
+	unlock_caches();
+	while (header != NULL) {
+		struct block_header *next = *next_block(header);
+		size_t index = size_class(header->size);
+		if (cache->num_free_blocks[index] < CACHED_BLOCKS) {
+			*next_block(header) = cache->free_blocks[index];
+			cache->free_blocks[index] = header;
+			cache->num_free_blocks[index]++;
+		} else {
+			context->platform.free(header);
+		}
+		header = next;
+	}
+}
+
+static struct block_header* take_block(
+	struct tarot_context *context,
+	struct tarot_allocation_cache *cache,
+	size_t size
+) {
+	struct block_header *header;
+	size_t index;
+	if (size > CACHED_SIZE) {
+		return context->platform.malloc(sizeof(*header) + size);
+	}
+	index = size_class(size);
+	if (cache->free_blocks[index] == NULL) {
+		collect_remote_blocks(context, cache);
+	}
+	header = cache->free_blocks[index];
+	if (header == NULL) {
+		return context->platform.malloc(sizeof(*header) + capacity_of(size));
+	}
+	cache->free_blocks[index] = *next_block(header);
+	cache->num_free_blocks[index]--;
+	return header;
+}
+
+static void put_block(
+	struct tarot_context *context,
+	struct tarot_allocation_cache *cache,
+	struct block_header *header
+) {
+	size_t index = size_class(header->size);
+	if (header->size > CACHED_SIZE) {
+		context->platform.free(header);
+		return;
+	}
+	if (header->cache != cache) {
+		/* Blocks go back to the cache of the thread that allocated them */
+		bool is_remote;
+		lock_caches();
+		is_remote = header->cache->is_used;
+		if (is_remote) {
+			*next_block(header) = header->cache->remote_blocks;
+			header->cache->remote_blocks = header;
+		}
+		unlock_caches();
+		if (is_remote) {
+			return;
+		}
+	}
+	if (cache->num_free_blocks[index] < CACHED_BLOCKS) {
+		*next_block(header) = cache->free_blocks[index];
+		cache->free_blocks[index] = header;
+		cache->num_free_blocks[index]++;
+	} else {
+		context->platform.free(header);
+	}
+}
+
+/* DIAGNOSTICS */
+
+/* The statistics belong to the root context, so that the workers of a
+ * virtual machine count towards the context the machine was created in.
+ * Caches flush their share periodically, and once they are released. */
+
+void tarot_set_allocation_lock(void *mutex) {
+	tarot_root_context()->allocation_lock = mutex;
+}
+
+/* Returns the root context, including the statistics of the current cache */
+static struct tarot_context* flushed_root_context(void) {
+	struct tarot_context *context = tarot_current_context();
+	if (context->cache != NULL) {
+		flush_statistics(context->root, context->cache);
+	}
+	return context->root;
+}
+
+size_t tarot_num_allocations(void) {
+	return flushed_root_context()->num_allocations;
+}
+
+size_t tarot_num_reallocations(void) {
+	return flushed_root_context()->num_reallocations;
+}
+
+size_t tarot_num_frees(void) {
+	return flushed_root_context()->num_frees;
+}
+
 size_t tarot_total_memory(void) {
-	return total_memory;
+	return flushed_root_context()->total_memory;
 }
 
 /* Metadata */
@@ -43,25 +339,79 @@ void tarot_tag(void *ptr, int type) {
 	header_of(ptr)->type = type;
 }
 
+/* Reference counting */
+
+/* The reference count of immortal blocks, well above the count of any
+ * block that is shared by its owners */
+#define IMMORTAL ((unsigned int)-1 / 2)
+
+/* The workers of a virtual machine share values, e.g. across the chunks of
+ * a parallel for loop. While several of them run, the allocation lock is
+ * set and reference counts are updated atomically, if the platform can, or
+ * else under the lock. Returns the new number of references. */
+TAROT_INLINE
+static unsigned int add_references(struct block_header *header, int amount) {
+	struct tarot_context *context;
+	unsigned int references;
+	if (header->references == IMMORTAL) {
+		return IMMORTAL;
+	}
+	context = tarot_root_context();
+	if (context->allocation_lock == NULL) {
+		return header->references += amount;
+	}
+	if (tarot_threading.atomic_add != NULL) {
+		return tarot_threading.atomic_add(&header->references, amount);
+	}
+	lock_statistics(context);
+	references = header->references += amount;
+	unlock_statistics(context);
+	return references;
+}
+
+void* tarot_retain(void *ptr) {
+	add_references(header_of(ptr), 1);
+	return ptr;
+}
+
+bool tarot_release(void *ptr) {
+	unsigned int references = add_references(header_of(ptr), -1);
+	assert(references != (unsigned int)-1);
+	return references == 0;
+}
+
+TAROT_INLINE
+bool tarot_is_shared(void *ptr) {
+	return add_references(header_of(ptr), 0) > 1;
+}
+
+void tarot_make_immortal(void *ptr) {
+	header_of(ptr)->references = IMMORTAL;
+}
+
 static size_t even(size_t n) {
 	return n + (n % 2);
 }
 
 void* tarot_malloc(size_t size) {
 	void *ptr = NULL;
-	struct block_header *header;
 	if (size > 0) {
+		struct tarot_context *context = tarot_current_context();
+		struct tarot_allocation_cache *cache = local_cache(context);
+		struct block_header *header;
 		size = even(size);
-		header = tarot_platform.malloc(sizeof(*header) + size);
+		header = take_block(context, cache, size);
 		assert(header != NULL);
 		header->size = size;
+		header->type = 0;
+		header->references = 1;
+		header->cache = cache;
 		ptr = end_of_struct(header);
 		memset(ptr, 0, size);
-		num_allocations++;
-		allocated_memory += size;
-		if (allocated_memory > total_memory) {
-			total_memory = allocated_memory;
-		}
+		cache->num_allocations++;
+		cache->allocated_memory += size;
+		count_memory(cache);
+		count_operation(context, cache);
 	}
 	return ptr;
 }
@@ -71,33 +421,37 @@ void* tarot_realloc(void *ptr, size_t size) {
 	if (ptr == NULL) {
 		new_ptr = tarot_malloc(size);
 	} else {
-		struct block_header *header;
-		struct block_header *old_header = header_of(ptr);
-		size_t old_size = old_header->size;
-		allocated_memory -= old_size;
+		struct tarot_context *context = tarot_current_context();
+		struct tarot_allocation_cache *cache = local_cache(context);
+		struct block_header *header = header_of(ptr);
+		size_t old_size = header->size;
 		size = even(size);
-		header = tarot_platform.realloc(old_header, size + sizeof(*header));
+		if (capacity_of(size) != capacity_of(old_size)) {
+			header = context->platform.realloc(header, sizeof(*header) + capacity_of(size));
+			assert(header != NULL);
+		}
 		header->size = size;
 		new_ptr = end_of_struct(header);
 		if (size > old_size) {
 			memset((char*)new_ptr + old_size, 0, size - old_size);
 		}
-		allocated_memory += size;
-		if (allocated_memory > total_memory) {
-			total_memory = allocated_memory;
-		}
-		num_reallocations++;
+		cache->allocated_memory -= old_size;
+		cache->allocated_memory += size;
+		cache->num_reallocations++;
+		count_memory(cache);
+		count_operation(context, cache);
 	}
 	return new_ptr;
 }
 
 void tarot_free(void *ptr) {
 	if (ptr != NULL) {
-		struct block_header *header;
-		assert(num_frees < num_allocations);
-		header = header_of(ptr);
-		allocated_memory -= header->size;
-		tarot_platform.free(header);
-		num_frees++;
+		struct tarot_context *context = tarot_current_context();
+		struct tarot_allocation_cache *cache = local_cache(context);
+		struct block_header *header = header_of(ptr);
+		cache->allocated_memory -= header->size;
+		cache->num_frees++;
+		put_block(context, cache, header);
+		count_operation(context, cache);
 	}
 }
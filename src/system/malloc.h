@@ -8,6 +8,26 @@ extern void* tarot_realloc(void *ptr, size_t size);
 extern void  tarot_free(void *ptr);
 extern void tarot_tag(void *ptr, int type);
 
+/* Reference counting: A block with more than one reference is shared and
+ * must be copied before it is modified. tarot_release returns true once the
+ * last reference is dropped, the caller then frees the block. */
+extern void* tarot_retain(void *ptr);
+extern bool tarot_release(void *ptr);
+extern bool tarot_is_shared(void *ptr);
+
+/* An immortal block is shared by everyone: retaining and releasing it has
+ * no effect, so it is copied before each modification, and OS threads may
+ * share it without synchronization. It is freed with tarot_free. */
+extern void tarot_make_immortal(void *ptr);
+
+/**
+ * Guards the allocation statistics of the current context and the reference
+ * counts with a mutex while several OS threads allocate at once. Pass NULL
+ * once a single thread is left.
+ */
+extern void tarot_set_allocation_lock(void *mutex);
+
+/* Allocation statistics of the current context */
 extern size_t tarot_num_allocations(void);
 extern size_t tarot_num_reallocations(void);
 extern size_t tarot_num_frees(void);
@@ -16,13 +36,31 @@ extern size_t tarot_num_active_regions(void);
 
 #ifdef TAROT_SOURCE
 
+struct tarot_allocation_cache;
+struct tarot_context;
+
 struct block_header {
 	size_t size;  /**< The size in bytes of the block of memory */
 	int type;
+	unsigned int references; /**< Number of owners, 1 after allocation */
+	struct tarot_allocation_cache *cache; /**< Allocated the block */
 };
 
 extern struct block_header* header_of(void *ptr);
 
+/**
+ * Creates the lock that lets several OS threads share the allocation caches.
+ */
+extern void tarot_initialize_allocation_caches(void);
+
+/**
+ * Flushes the statistics of the cache of a context to its root and hands
+ * the cache over to the next context that allocates. Its free blocks are
+ * kept until tarot_free_allocation_caches.
+ */
+extern void tarot_release_allocation_cache(struct tarot_context *context);
+extern void tarot_free_allocation_caches(void);
+
 #endif /* TAROT_SOURCE */
 
 #endif /* TAROT_MALLOC_H */
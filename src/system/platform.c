@@ -2,7 +2,7 @@
 #include "tarot.h"
 
 static bool is_initialized = false;
-struct tarot_platform_config tarot_platform;
+struct tarot_threading_config tarot_threading;
 
 static enum tarot_byteorder {
 	TAROT_LITTLE_ENDIAN=1,
@@ -33,11 +33,8 @@ void tarot_initialize(const struct tarot_platform_config *cfg) {
 	assert(sizeof(uint16_t) * CHAR_BIT == 16);
 	assert(sizeof(int32_t)  * CHAR_BIT == 32);
 	assert(sizeof(uint32_t) * CHAR_BIT == 32);
-	memcpy(&tarot_platform, cfg, sizeof(tarot_platform));
+	tarot_initialize_context(tarot_default_context(), cfg);
 	determine_byteorder();
-	tarot_open_stdout(tarot_platform.cout);
-	tarot_open_stderr(tarot_platform.cerr);
-	tarot_open_stdin(tarot_platform.cin);
 	mp_set_memory_functions(tarot_malloc, gmp_realloc, gmp_free);
 	is_initialized = true;
 	tarot_log("Initialized platform interface");
@@ -48,6 +45,22 @@ bool tarot_is_initialized(void) {
 	return is_initialized;
 }
 
+void tarot_initialize_threading(const struct tarot_threading_config *cfg) {
+	assert(is_initialized);
+	assert(cfg->start != NULL and cfg->join != NULL and cfg->yield != NULL);
+	assert(cfg->create_mutex != NULL and cfg->free_mutex != NULL);
+	assert(cfg->lock != NULL and cfg->unlock != NULL);
+	assert(cfg->get_context != NULL and cfg->set_context != NULL);
+	memcpy(&tarot_threading, cfg, sizeof(tarot_threading));
+	tarot_initialize_allocation_caches();
+	tarot_log("Initialized threading interface");
+}
+
+TAROT_INLINE
+bool tarot_has_threading(void) {
+	return tarot_threading.start != NULL;
+}
+
 int tarot_exit(void) {
 	if (is_initialized) {
 		/*tarot_clear_regions();*/
@@ -62,7 +75,9 @@ int tarot_exit(void) {
 		tarot_fclose(tarot_stdout);
 		tarot_fclose(tarot_stderr);
 		tarot_fclose(tarot_stdin);
+		tarot_free_allocation_caches();
 		memset(&tarot_platform, 0, sizeof(tarot_platform));
+		memset(&tarot_threading, 0, sizeof(tarot_threading));
 		is_initialized = false;
 	}
 	/* TODO: Reset error/memory statistics */
@@ -30,9 +30,46 @@ extern void tarot_initialize(const struct tarot_platform_config *cfg);
 extern int  tarot_exit(void);
 extern bool tarot_is_initialized(void);
 
+/**
+ * Optional OS threads. A virtual machine can run on several workers only if
+ * the platform provides them through tarot_initialize_threading().
+ */
+typedef void  (*tarot_thread_routine)          (void *argument);
+typedef void* (*tarot_thread_start_function)   (tarot_thread_routine, void*);
+typedef void  (*tarot_thread_join_function)    (void *thread);
+typedef void  (*tarot_thread_yield_function)   (void);
+typedef void* (*tarot_mutex_create_function)   (void);
+typedef void  (*tarot_mutex_free_function)     (void *mutex);
+typedef void  (*tarot_mutex_lock_function)     (void *mutex);
+typedef void  (*tarot_mutex_unlock_function)   (void *mutex);
+typedef void* (*tarot_context_get_function)    (void);
+typedef void  (*tarot_context_set_function)    (void *context);
+typedef unsigned int (*tarot_atomic_add_function)(unsigned int *value, int amount);
+
+struct tarot_threading_config {
+	tarot_thread_start_function start;
+	tarot_thread_join_function  join;
+	tarot_thread_yield_function yield;
+	tarot_mutex_create_function create_mutex;
+	tarot_mutex_free_function   free_mutex;
+	tarot_mutex_lock_function   lock;
+	tarot_mutex_unlock_function unlock;
+	/* A thread-local slot holding the context of the calling OS thread */
+	tarot_context_get_function  get_context;
+	tarot_context_set_function  set_context;
+	/* Optional, adds to a value atomically and returns the result. Without
+	 * it reference counts shared by several workers are guarded by a mutex */
+	tarot_atomic_add_function   atomic_add;
+};
+
+extern void tarot_initialize_threading(const struct tarot_threading_config *cfg);
+extern bool tarot_has_threading(void);
+
 /* Only available to tarot source files */
 #ifdef TAROT_SOURCE
-extern struct tarot_platform_config tarot_platform;
+/* The platform interface of the current context */
+#define tarot_platform (tarot_current_context()->platform)
+extern struct tarot_threading_config tarot_threading;
 #endif
 
 /* Endian-sensitive functions */
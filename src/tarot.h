@@ -2,6 +2,8 @@
 #define TAROT_H
 
 #include "bytecode/bytecode.h"
+#include "bytecode/cache.h"
+#include "bytecode/channel.h"
 #include "bytecode/thread.h"
 #include "bytecode/region.h"
 #include "bytecode/vm.h"
@@ -34,8 +36,10 @@
 #include "main/main.h"
 
 #include "system/assert.h"
+#include "system/context.h"
 #include "system/ctype.h"
 #include "system/error.h"
+#include "system/format.h"
 #include "system/iostream.h"
 #include "system/iso646.h"
 #include "system/logging.h"
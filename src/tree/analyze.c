@@ -51,6 +51,24 @@ static void resolve_builtin_string_relation(struct tarot_node *node) {
 	}
 }
 
+static void resolve_builtin_channel_relation(struct tarot_node *node) {
+	struct tarot_node *owner = Relation(node)->parent;
+	struct tarot_string *child = Relation(node)->child;
+	if (tarot_match_string(child, "send")) {
+		struct tarot_node *link = tarot_create_node(NODE_Builtin, position_of(node));
+		Builtin(link)->return_type = tarot_create_node(NODE_Type, position_of(node));
+		Type(Builtin(link)->return_type)->type = TYPE_VOID;
+		Builtin(link)->builtin_type = TYPE_CHANNEL;
+		Relation(node)->link = link;
+	} else if (tarot_match_string(child, "receive")) {
+		struct tarot_node *link = tarot_create_node(NODE_Builtin, position_of(node));
+		/* Builtin links are not freed, so the type is shared with the channel */
+		Builtin(link)->return_type = Type(type_of(owner))->subtype;
+		Builtin(link)->builtin_type = TYPE_CHANNEL;
+		Relation(node)->link = link;
+	}
+}
+
 static void resolve_builtin_relation(struct tarot_node *node) {
 	struct tarot_node *owner = Relation(node)->parent;
 	struct tarot_string *child = Relation(node)->child;
@@ -65,6 +83,9 @@ static void resolve_builtin_relation(struct tarot_node *node) {
 			break;
 		case TYPE_DICT:
 			break;
+		case TYPE_CHANNEL:
+			resolve_builtin_channel_relation(node);
+			break;
 	}
 }
 
@@ -186,6 +207,437 @@ static void infer_types(struct tarot_node *node, struct scope_stack *stack) {
 	}
 }
 
+/******************************************************************************
+ * MARK: Ownership
+ *
+ * Local variables exclusively own their value: Whenever an aliasing
+ * expression (identifier, subscript, relation) is stored, a copy is made.
+ * An assignment of the form [x = x op y] can therefore update the value
+ * of x in place instead of allocating a result and freeing the old value.
+ *****************************************************************************/
+
+static bool refers_to(struct tarot_node *node, struct tarot_node *variable) {
+	return kind_of(node) == NODE_Identifier and link_of(node) == variable;
+}
+
+static bool has_in_place_operator(struct tarot_node *node) {
+	switch (Type(type_of(node))->type) {
+		default:
+			return false;
+		case TYPE_INTEGER:
+			switch (ArithmeticExpression(node)->operator) {
+				default:
+					return false;
+				case EXPR_ADD:
+				case EXPR_SUBTRACT:
+				case EXPR_MULTIPLY:
+				case EXPR_DIVIDE:
+				case EXPR_MODULO:
+					return true;
+			}
+		case TYPE_RATIONAL:
+			switch (ArithmeticExpression(node)->operator) {
+				default:
+					return false;
+				case EXPR_ADD:
+				case EXPR_SUBTRACT:
+				case EXPR_MULTIPLY:
+				case EXPR_DIVIDE:
+					return true;
+			}
+	}
+}
+
+/* [s = f"{s}..."] where s does not appear again in the rest of the f-string */
+static bool is_string_extension(struct tarot_node *node, struct tarot_node *variable) {
+	size_t i;
+	struct tarot_node *first;
+	if (FString(node)->num_elements < 2) {
+		return false;
+	}
+	first = FString(node)->elements[0];
+	if (kind_of(first) != NODE_FStringExpression) {
+		return false;
+	}
+	if (not refers_to(FStringExpression(first)->expression, variable)) {
+		return false;
+	}
+	for (i = 1; i < FString(node)->num_elements; i++) {
+		struct tarot_node *element = FString(node)->elements[i];
+		if (kind_of(element) == NODE_FStringExpression and
+			refers_to(FStringExpression(element)->expression, variable)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void mark_in_place_assignment(struct tarot_node *node) {
+	struct tarot_node *target = Assignment(node)->identifier;
+	struct tarot_node *value = Assignment(node)->value;
+	struct tarot_node *variable;
+	if (kind_of(target) != NODE_Identifier) {
+		return;
+	}
+	variable = link_of(target);
+	if (variable == NULL or kind_of(variable) != NODE_Variable) {
+		return; /* parameters are borrowed from the caller */
+	}
+	switch (kind_of(value)) {
+		default:
+			break;
+		case NODE_ArithmeticExpression:
+			Assignment(node)->in_place = (
+				refers_to(ArithmeticExpression(value)->left_operand, variable)
+				and has_in_place_operator(value)
+			);
+			break;
+		case NODE_FString:
+			Assignment(node)->in_place = is_string_extension(value, variable);
+			break;
+	}
+}
+
+/******************************************************************************
+ * MARK: Escape
+ *
+ * The pieces of an f-string only live until they are concatenated, so the
+ * generator places them in scratch memory instead of the region. The result
+ * of the f-string is temporary as well if it is merely printed, compared or
+ * appended in place, otherwise it escapes its statement.
+ *****************************************************************************/
+
+/* Pieces whose string the generator can place in scratch memory */
+static bool is_scratch_piece(struct tarot_node *piece) {
+	if (kind_of(piece) == NODE_FStringString) {
+		return true;
+	}
+	switch (Type(type_of(piece))->type) {
+		default:
+			return false;
+		case TYPE_BOOLEAN:
+		case TYPE_FLOAT:
+		case TYPE_INTEGER:
+		case TYPE_RATIONAL:
+		case TYPE_STRING:
+			return true;
+	}
+}
+
+static void mark_temporary(struct tarot_node *node) {
+	if (kind_of(node) == NODE_FString) {
+		FString(node)->is_temporary = true;
+	}
+}
+
+static void mark_escapes(struct tarot_node *node) {
+	switch (kind_of(node)) {
+		default:
+			break;
+		case NODE_Print:
+			mark_temporary(PrintStatement(node)->arguments);
+			break;
+		case NODE_RelationalExpression:
+			mark_temporary(RelationalExpression(node)->left_operand);
+			mark_temporary(RelationalExpression(node)->right_operand);
+			break;
+		case NODE_Assignment:
+			if (Assignment(node)->in_place) {
+				mark_temporary(Assignment(node)->value);
+			}
+			break;
+	}
+}
+
+/******************************************************************************
+ * MARK: Allocation
+ *
+ * Determines whether evaluating a node may leave objects in the region of
+ * the current stackframe. Loops only push and pop regions around the parts
+ * that do, which spares purely numeric loops the region bookkeeping.
+ * Anything not known to be free of allocations is assumed to allocate.
+ *****************************************************************************/
+
+static bool may_allocate(struct tarot_node *node);
+
+static bool is_unboxed(struct tarot_node *node) {
+	switch (Type(type_of(node))->type) {
+		default:
+			return false;
+		case TYPE_VOID:
+		case TYPE_BOOLEAN:
+		case TYPE_FLOAT:
+			return true;
+	}
+}
+
+/* Values of these types are taken out of the region when stored */
+static bool is_stored_out_of_region(struct tarot_node *type) {
+	switch (Type(type)->type) {
+		default:
+			return false;
+		case TYPE_VOID:
+		case TYPE_BOOLEAN:
+		case TYPE_FLOAT:
+		case TYPE_INTEGER:
+		case TYPE_RATIONAL:
+		case TYPE_STRING:
+		case TYPE_LIST:
+		case TYPE_CHANNEL:
+		case TYPE_CUSTOM:
+			return true;
+	}
+}
+
+/* Like may_allocate, but disregards the result of the expression itself */
+static bool allocates_temporaries(struct tarot_node *node) {
+	switch (kind_of(node)) {
+		default:
+			return may_allocate(node);
+		case NODE_Literal:
+		case NODE_Identifier:
+			return false;
+		case NODE_ArithmeticExpression:
+			return (
+				may_allocate(ArithmeticExpression(node)->left_operand)
+				or may_allocate(ArithmeticExpression(node)->right_operand)
+			);
+		case NODE_InfixExpression:
+			return allocates_temporaries(InfixExpression(node)->expression);
+		case NODE_Neg:
+			return may_allocate(NegExpression(node)->expression);
+		case NODE_Abs:
+			return may_allocate(AbsExpression(node)->expression);
+		case NODE_Typecast:
+			return may_allocate(CastExpression(node)->operand);
+		case NODE_FunctionCall:
+			if (kind_of(definition_of(node)) != NODE_Function) {
+				return true;
+			}
+			return may_allocate(FunctionCall(node)->arguments);
+	}
+}
+
+static bool may_allocate_store(struct tarot_node *type, struct tarot_node *value) {
+	if (is_stored_out_of_region(type)) {
+		return allocates_temporaries(value);
+	}
+	return may_allocate(value);
+}
+
+static bool may_allocate_assignment(struct tarot_node *node) {
+	struct tarot_node *value = Assignment(node)->value;
+	if (kind_of(Assignment(node)->identifier) != NODE_Identifier) {
+		return true;
+	}
+	if (not Assignment(node)->in_place) {
+		return may_allocate_store(type_of(value), value);
+	}
+	if (kind_of(value) == NODE_FString) {
+		size_t i;
+		for (i = 1; i < FString(value)->num_elements; i++) {
+			struct tarot_node *piece = FString(value)->elements[i];
+			if (not is_scratch_piece(piece)) {
+				return true;
+			}
+			if (kind_of(piece) == NODE_FStringExpression and may_allocate(FStringExpression(piece)->expression)) {
+				return true;
+			}
+		}
+		return false; /* the appended pieces live in scratch memory */
+	}
+	return may_allocate(ArithmeticExpression(value)->right_operand);
+}
+
+static bool may_allocate(struct tarot_node *node) {
+	switch (kind_of(node)) {
+		default:
+			return true;
+		case NODE_NULL:
+		case NODE_Break:
+		case NODE_Enumerator:
+		case NODE_Identifier:
+			return false;
+		case NODE_While:
+		case NODE_For:
+			return false; /* loops contain their own allocations */
+		case NODE_Block:
+			return Block(node)->allocates;
+		case NODE_Literal:
+		case NODE_ArithmeticExpression:
+		case NODE_InfixExpression:
+		case NODE_Neg:
+		case NODE_Abs:
+		case NODE_Typecast:
+		case NODE_FunctionCall:
+			return not is_unboxed(node) or allocates_temporaries(node);
+		case NODE_LogicalExpression:
+			return (
+				may_allocate(LogicalExpression(node)->left_operand)
+				or may_allocate(LogicalExpression(node)->right_operand)
+			);
+		case NODE_RelationalExpression:
+			return (
+				may_allocate(RelationalExpression(node)->left_operand)
+				or may_allocate(RelationalExpression(node)->right_operand)
+			);
+		case NODE_Not:
+			return may_allocate(NotExpression(node)->expression);
+		case NODE_If:
+			return (
+				may_allocate(IfStatement(node)->condition)
+				or may_allocate(IfStatement(node)->block)
+				or may_allocate(IfStatement(node)->elseif)
+			);
+		case NODE_ExpressionStatement:
+			return may_allocate(ExprStatement(node)->expression);
+		case NODE_Print:
+			return may_allocate(PrintStatement(node)->arguments);
+		case NODE_Assert:
+			return may_allocate(AssertStatement(node)->condition);
+		case NODE_Variable:
+			return may_allocate_store(Variable(node)->type, Variable(node)->value);
+		case NODE_Constant:
+			return may_allocate_store(Constant(node)->type, Constant(node)->value);
+		case NODE_Assignment:
+			return may_allocate_assignment(node);
+	}
+}
+
+static void mark_allocations(struct tarot_node *node) {
+	size_t i;
+	struct tarot_node *range;
+	switch (kind_of(node)) {
+		default:
+			break;
+		case NODE_Block:
+			Block(node)->allocates = false;
+			for (i = 0; i < Block(node)->num_elements; i++) {
+				if (may_allocate(Block(node)->elements[i])) {
+					Block(node)->allocates = true;
+					break;
+				}
+			}
+			break;
+		case NODE_While:
+			WhileLoop(node)->condition_allocates = may_allocate(WhileLoop(node)->condition);
+			break;
+		case NODE_For:
+			range = ForLoop(node)->expression;
+			ForLoop(node)->condition_allocates = may_allocate(RangeExpression(range)->end);
+			ForLoop(node)->block_allocates = (
+				may_allocate(ForLoop(node)->block)
+				or may_allocate(RangeExpression(range)->stepsize)
+			);
+			break;
+	}
+}
+
+/******************************************************************************
+ * MARK: Last use
+ *
+ * Finds the last reference to each local variable of a function. A variable
+ * is dead after its last reference unless that reference sits in a loop the
+ * variable was declared outside of, as the loop may read it again. Storing
+ * or returning a dead variable moves its value instead of copying it.
+ *****************************************************************************/
+
+struct last_use_state {
+	struct tarot_list *variables;
+	struct tarot_node *iterator;
+	uint8_t loop_depth;
+};
+
+static void enter_last_use(struct tarot_node **nodeptr, struct scope_stack *stack, void *data) {
+	struct tarot_node *node = *nodeptr;
+	struct last_use_state *state = data;
+	struct tarot_node *variable;
+	unused(stack);
+	switch (kind_of(node)) {
+		default:
+			break;
+		case NODE_For:
+			/* The iterator is read by every iteration, so it lives outside */
+			state->iterator = ForLoop(node)->identifier;
+			Variable(state->iterator)->loop_depth = state->loop_depth;
+			Variable(state->iterator)->last_use = NULL;
+			tarot_list_append(&state->variables, &state->iterator);
+			state->loop_depth++;
+			break;
+		case NODE_While:
+			state->loop_depth++;
+			break;
+		case NODE_Variable:
+			if (node != state->iterator) {
+				Variable(node)->loop_depth = state->loop_depth;
+				Variable(node)->last_use = NULL;
+				tarot_list_append(&state->variables, &node);
+			}
+			break;
+		case NODE_Identifier:
+			variable = link_of(node);
+			Identifier(node)->is_last_use = false;
+			if (kind_of(variable) == NODE_Variable) {
+				if (Variable(variable)->loop_depth == state->loop_depth) {
+					Variable(variable)->last_use = node;
+				} else {
+					Variable(variable)->last_use = NULL;
+				}
+			}
+			break;
+	}
+}
+
+static void leave_last_use(struct tarot_node **nodeptr, struct scope_stack *stack, void *data) {
+	struct last_use_state *state = data;
+	unused(stack);
+	switch (kind_of(*nodeptr)) {
+		default:
+			break;
+		case NODE_For:
+		case NODE_While:
+			state->loop_depth--;
+			break;
+	}
+}
+
+static void mark_last_uses(struct tarot_node **nodeptr) {
+	size_t i;
+	struct last_use_state state;
+	memset(&state, 0, sizeof(state));
+	state.variables = tarot_create_list(sizeof(struct tarot_node*), 10, NULL);
+	tarot_traverse(nodeptr, enter_last_use, leave_last_use, &state);
+	for (i = 0; i < tarot_list_length(state.variables); i++) {
+		struct tarot_node *variable = *(struct tarot_node**)tarot_list_element(state.variables, i);
+		if (Variable(variable)->last_use != NULL) {
+			Identifier(Variable(variable)->last_use)->is_last_use = true;
+		}
+	}
+	tarot_free_list(state.variables);
+}
+
+/******************************************************************************
+ * MARK: Annotations
+ *****************************************************************************/
+
+/* Annotates a valid and simplified node with hints for the generator */
+static void annotate_node(struct tarot_node **nodeptr) {
+	switch (kind_of(*nodeptr)) {
+		default:
+			break;
+		case NODE_Assignment:
+			mark_in_place_assignment(*nodeptr);
+			break;
+		case NODE_Function:
+		case NODE_Method:
+		case NODE_Constructor:
+			mark_last_uses(nodeptr);
+			break;
+	}
+	mark_escapes(*nodeptr);
+	mark_allocations(*nodeptr);
+}
+
 /******************************************************************************
  * MARK: Analyzer
  *****************************************************************************/
@@ -311,6 +763,7 @@ static void leave2(struct tarot_node **nodeptr, struct scope_stack *stack, void
 			analyzer->panic = true;
 		} else {
 			simplify_nodeptr(nodeptr);
+			annotate_node(nodeptr);
 			index_node(*nodeptr, analyzer);
 		}
 	} else if (class_of(node) == CLASS_STATEMENT) {
@@ -30,15 +30,22 @@ static void append_module(
 	}
 }
 
+/* The state shared by the traversal resolving the imports */
+struct import_context {
+	struct tarot_node *modules;
+	enum tarot_scan_mode mode;
+};
+
 static void import_module(
-	struct tarot_node *modules,
+	struct import_context *context,
 	struct tarot_node *statement
 ) {
+	struct tarot_node *modules = context->modules;
 	struct tarot_node *module;
 	struct tarot_string *path = ImportStatement(statement)->path;
 	if ((module = lookup_module(modules, path))) {
 		ImportStatement(statement)->module_link = module;
-	} else if ((module = tarot_parse_file(tarot_string_text(path)))) {
+	} else if ((module = tarot_parse_file(tarot_string_text(path), context->mode))) {
 		append_module(modules, module);
 		ImportStatement(statement)->module_link = module;
 	} else {
@@ -59,29 +66,37 @@ static void resolve_import(
 	void *data
 ) {
 	struct tarot_node *node = *nodeptr;
-	struct tarot_node *modules = data;
+	struct import_context *context = data;
 	unused(stack);
 	if (kind_of(node) == NODE_Import) {
-		import_module(modules, node);
+		import_module(context, node);
 	}
 }
 
-void tarot_resolve_imports(struct tarot_node *modules) {
+void tarot_resolve_imports(
+	struct tarot_node *modules,
+	enum tarot_scan_mode mode
+) {
+	struct import_context context;
 	struct tarot_node *module;
+	context.modules = modules;
+	context.mode = mode;
 	for (
 		module = modules;
 		module != NULL;
 		module = Module(module)->next_module
 	) {
-		tarot_traverse_postorder(Module(module)->block, resolve_import, modules);
+		tarot_traverse_postorder(Module(module)->block, resolve_import, &context);
 	}
 }
 
-struct tarot_node* tarot_import(const char *path) {
-	struct tarot_node *ast = tarot_parse_file(path);
+struct tarot_node* tarot_import(const char *path, enum tarot_scan_mode mode) {
+	struct tarot_node *ast = tarot_parse_file(path, mode);
 	if (ast != NULL) {
+		/* Nodes created from here on belong to the root module */
+		tarot_use_node_arena(Module(ast)->arena);
 		Module(ast)->is_root = true;
-		tarot_resolve_imports(ast);
+		tarot_resolve_imports(ast, mode);
 		if (Module(ast)->num_errors == 0) {
 			tarot_analyze_ast(ast);
 		}
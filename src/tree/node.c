@@ -5,8 +5,12 @@
  * MARK: Node
  *****************************************************************************/
 
-/* Implementation of the general node type */
+/* Implementation of the general node type. The variant comes last, so that
+ * nodes can be allocated with just enough room for the variant of their kind
+ * (see node_size). */
 struct tarot_node {
+	enum tarot_node_kind kind;
+	struct tarot_stream_position position;
 	union {
 		struct Module Module;
 		struct Block Block;
@@ -20,6 +24,7 @@ struct tarot_node {
 		struct Subscript Subscript;
 		struct Pair Pair;
 		struct CastExpression CastExpression;
+		struct ChannelExpression ChannelExpression;
 		struct Literal Literal;
 		struct FString FString;
 		struct FStringString FStringString;
@@ -40,6 +45,7 @@ struct tarot_node {
 		struct TryStatement TryStatement;
 		struct CatchStatement CatchStatement;
 		struct RaiseStatement RaiseStatement;
+		struct LaunchStatement LaunchStatement;
 		struct ReturnStatement ReturnStatement;
 		struct AssertStatement AssertStatement;
 		struct ClassDefinition ClassDefinition;
@@ -55,8 +61,6 @@ struct tarot_node {
 		struct Builtin Builtin;
 		struct Break Break;
 	} as;
-	struct tarot_stream_position position;
-	enum tarot_node_kind kind;
 };
 
 /******************************************************************************
@@ -102,6 +106,8 @@ const char* datatype_string(enum tarot_datatype kind) {
 			return "List";
 		case TYPE_DICT:
 			return "Dict";
+		case TYPE_CHANNEL:
+			return "Channel";
 		case TYPE_CUSTOM:
 			return "";
 	}
@@ -153,6 +159,7 @@ enum tarot_node_class class_of(struct tarot_node *node) {
 		case NODE_Literal:
 		case NODE_List:
 		case NODE_Dict:
+		case NODE_Channel:
 		case NODE_FString:
 		case NODE_FStringString:
 		case NODE_FStringExpression:
@@ -172,6 +179,7 @@ enum tarot_node_class class_of(struct tarot_node *node) {
 		case NODE_Try:
 		case NODE_Catch:
 		case NODE_Raise:
+		case NODE_Launch:
 		case NODE_Assert:
 		case NODE_Break:
 		case NODE_Breakpoint:
@@ -217,6 +225,7 @@ const char* node_string(enum tarot_node_kind kind) {
 		"Literal",
 		"List",
 		"Dict",
+		"Channel",
 		"FString",
 		"FStringString",
 		"FStringExpression",
@@ -236,6 +245,7 @@ const char* node_string(enum tarot_node_kind kind) {
 		"Try",
 		"Catch",
 		"Raise",
+		"Launch",
 		"Return",
 		"Assert",
 		"Class",
@@ -405,6 +415,11 @@ struct CastExpression* CastExpression(struct tarot_node *node) {
 	return &node->as.CastExpression;
 }
 
+struct ChannelExpression* ChannelExpression(struct tarot_node *node) {
+	assert(kind_of(node) == NODE_Channel);
+	return &node->as.ChannelExpression;
+}
+
 struct Literal* Literal(struct tarot_node *node) {
 	assert(kind_of(node) == NODE_Literal);
 	return &node->as.Literal;
@@ -515,6 +530,11 @@ struct RaiseStatement* RaiseStatement(struct tarot_node *node) {
 	return &node->as.RaiseStatement;
 }
 
+struct LaunchStatement* LaunchStatement(struct tarot_node *node) {
+	assert(kind_of(node) == NODE_Launch);
+	return &node->as.LaunchStatement;
+}
+
 struct ReturnStatement* ReturnStatement(struct tarot_node *node) {
 	assert(kind_of(node) == NODE_Return);
 	return &node->as.ReturnStatement;
@@ -609,34 +629,227 @@ struct UnaryExpression* Breakpoint(struct tarot_node *node) {
  * MARK: Create
  *****************************************************************************/
 
+/* Number of temporary nodes in use at once. Smaller values (8) result in
+ * errors for List[List[Integer]] already */
+#define TEMP_NODES 16
+
 struct tarot_node* tarot_temp_node(
 	enum tarot_node_kind kind,
 	struct tarot_stream_position *position
 ) {
-	static struct tarot_node circular_node_buffer[16]; /* smaller values (8) result in error for List[List[Integer]] already */
-	static const uint8_t length = lengthof(circular_node_buffer);
-	static uint8_t index = 0;
-	struct tarot_node *node = &circular_node_buffer[index++ % length];
+	struct tarot_context *context = tarot_current_context();
+	struct tarot_node *node;
+	if (context->temp_nodes == NULL) {
+		/* Freed along with the context, hence not counted as an allocation */
+		context->temp_nodes = tarot_platform.malloc(sizeof(*node) * TEMP_NODES);
+		assert(context->temp_nodes != NULL);
+	}
+	node = &context->temp_nodes[context->temp_node_index++ % TEMP_NODES];
 	memset(node, 0, sizeof(*node));
 	node->kind = kind;
 	memcpy(&node->position, position, sizeof(*position));
 	return node;
 }
 
-static size_t num_nodes = 0;
+/* Returns the size of the variant of nodes of the given kind */
+static size_t variant_size(enum tarot_node_kind kind) {
+	switch (kind) {
+		default:
+			tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase: %d", kind);
+			return 0;
+		case NODE_NULL:
+		case NODE_ERROR:
+			return 0;
+		case NODE_Module:
+			return sizeof(struct Module);
+		case NODE_Block:
+		case NODE_List:
+		case NODE_Dict:
+			return sizeof(struct Block);
+		case NODE_LogicalExpression:
+			return sizeof(struct LogicalExpression);
+		case NODE_RelationalExpression:
+			return sizeof(struct RelationalExpression);
+		case NODE_ArithmeticExpression:
+			return sizeof(struct ArithmeticExpression);
+		case NODE_InfixExpression:
+		case NODE_Not:
+		case NODE_Neg:
+		case NODE_Abs:
+		case NODE_Breakpoint:
+			return sizeof(struct UnaryExpression);
+		case NODE_Range:
+			return sizeof(struct RangeExpression);
+		case NODE_FunctionCall:
+			return sizeof(struct FunctionCall);
+		case NODE_Relation:
+			return sizeof(struct Relation);
+		case NODE_Subscript:
+			return sizeof(struct Subscript);
+		case NODE_Pair:
+			return sizeof(struct Pair);
+		case NODE_Typecast:
+			return sizeof(struct CastExpression);
+		case NODE_Channel:
+			return sizeof(struct ChannelExpression);
+		case NODE_Literal:
+			return sizeof(struct Literal);
+		case NODE_FString:
+			return sizeof(struct FString);
+		case NODE_FStringString:
+			return sizeof(struct FStringString);
+		case NODE_FStringExpression:
+			return sizeof(struct FStringExpression);
+		case NODE_Identifier:
+			return sizeof(struct Identifier);
+		case NODE_Enumerator:
+			return sizeof(struct Enumerator);
+		case NODE_Type:
+			return sizeof(struct Type);
+		case NODE_Import:
+			return sizeof(struct ImportStatement);
+		case NODE_If:
+			return sizeof(struct IfStatement);
+		case NODE_While:
+			return sizeof(struct WhileLoop);
+		case NODE_For:
+			return sizeof(struct ForLoop);
+		case NODE_Match:
+			return sizeof(struct MatchStatement);
+		case NODE_Case:
+			return sizeof(struct CaseStatement);
+		case NODE_Assignment:
+			return sizeof(struct Assignment);
+		case NODE_ExpressionStatement:
+			return sizeof(struct ExprStatement);
+		case NODE_Print:
+			return sizeof(struct PrintStatement);
+		case NODE_Input:
+			return sizeof(struct InputExpression);
+		case NODE_Try:
+			return sizeof(struct TryStatement);
+		case NODE_Catch:
+			return sizeof(struct CatchStatement);
+		case NODE_Raise:
+			return sizeof(struct RaiseStatement);
+		case NODE_Launch:
+			return sizeof(struct LaunchStatement);
+		case NODE_Return:
+			return sizeof(struct ReturnStatement);
+		case NODE_Assert:
+			return sizeof(struct AssertStatement);
+		case NODE_Class:
+			return sizeof(struct ClassDefinition);
+		case NODE_Enum:
+			return sizeof(struct EnumDefinition);
+		case NODE_Constructor:
+			return sizeof(struct ClassConstructor);
+		case NODE_Function:
+		case NODE_Method:
+			return sizeof(struct FunctionDefinition);
+		case NODE_ForeignFunction:
+			return sizeof(struct ForeignFunction);
+		case NODE_Namespace:
+			return sizeof(struct Namespace);
+		case NODE_TypeDefinition:
+			return sizeof(struct TypeDefinition);
+		case NODE_Union:
+			return sizeof(struct UnionDefinition);
+		case NODE_Variable:
+		case NODE_Attribute:
+		case NODE_Constant:
+			return sizeof(struct Variable);
+		case NODE_Parameter:
+			return sizeof(struct Parameter);
+		case NODE_Builtin:
+			return sizeof(struct Builtin);
+		case NODE_Break:
+			return sizeof(struct Break);
+	}
+}
+
+/* Returns the number of bytes a node of the given kind occupies */
+static size_t node_size(enum tarot_node_kind kind) {
+	return offsetof(struct tarot_node, as) + variant_size(kind);
+}
+
+/* Chunks of an arena are filled front to back and link to the older ones */
+struct arena_chunk {
+	struct arena_chunk *previous;
+	size_t size;
+	size_t top;
+};
+
+struct tarot_node_arena {
+	struct arena_chunk *chunk;
+};
+
+#define ARENA_CHUNK_SIZE 8192
+
+struct tarot_node_arena* tarot_create_node_arena(void) {
+	struct tarot_node_arena *arena = tarot_malloc(sizeof(*arena));
+	arena->chunk = NULL;
+	return arena;
+}
+
+void tarot_free_node_arena(struct tarot_node_arena *arena) {
+	struct arena_chunk *chunk;
+	if (arena != NULL) {
+		while ((chunk = arena->chunk) != NULL) {
+			arena->chunk = chunk->previous;
+			tarot_free(chunk);
+		}
+		if (tarot_current_context()->node_arena == arena) {
+			tarot_current_context()->node_arena = NULL;
+		}
+		tarot_free(arena);
+	}
+}
+
+struct tarot_node_arena* tarot_use_node_arena(struct tarot_node_arena *arena) {
+	struct tarot_context *context = tarot_current_context();
+	struct tarot_node_arena *previous = context->node_arena;
+	context->node_arena = arena;
+	return previous;
+}
+
+struct tarot_node_arena* tarot_current_node_arena(void) {
+	return tarot_current_context()->node_arena;
+}
+
+static void* arena_alloc(struct tarot_node_arena *arena, size_t size) {
+	struct arena_chunk *chunk = arena->chunk;
+	void *memory;
+	size = tarot_align(size);
+	if (chunk == NULL or chunk->top + size > chunk->size) {
+		size_t capacity = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+		chunk = tarot_malloc(tarot_align(sizeof(*chunk)) + capacity);
+		chunk->previous = arena->chunk;
+		chunk->size = capacity;
+		chunk->top = 0;
+		arena->chunk = chunk;
+	}
+	memory = (char*)chunk + tarot_align(sizeof(*chunk)) + chunk->top;
+	chunk->top += size;
+	return memory;
+}
 
 size_t tarot_num_nodes(void) {
-	return num_nodes;
+	return tarot_root_context()->num_nodes;
 }
 
 struct tarot_node* tarot_create_node(
 	enum tarot_node_kind kind,
 	struct tarot_stream_position *position
 ) {
-	struct tarot_node *node = tarot_malloc(sizeof(*node));
+	struct tarot_context *context = tarot_current_context();
+	struct tarot_node *node;
+	assert(context->node_arena != NULL); /* No module to allocate the node for */
+	node = arena_alloc(context->node_arena, node_size(kind));
+	memset(node, 0, node_size(kind));
 	node->kind = kind;
 	memcpy(&node->position, position, sizeof(*position));
-	num_nodes++;
+	tarot_root_context()->num_nodes++;
 	return node;
 }
 
@@ -840,7 +1053,7 @@ struct tarot_node* definition_of(struct tarot_node *node) {
 	}
 }
 
-struct tarot_list* scope_of(struct tarot_node *node) {
+struct scope* scope_of(struct tarot_node *node) {
 	switch (kind_of(node)) {
 		default:
 			tarot_sourcecode_error(__FILE__, __LINE__, "Unexpected switchcase: %d", kind_of(node));
@@ -962,6 +1175,8 @@ struct tarot_node* type_of(struct tarot_node *node) {
 			return type_of(AbsExpression(node)->expression);
 		case NODE_Typecast:
 			return builtin_type(CastExpression(node)->kind, position_of(node));
+		case NODE_Channel:
+			return ChannelExpression(node)->type;
 		case NODE_Subscript:
 			return Type(type_of(Subscript(node)->identifier))->subtype;
 		case NODE_Builtin:
@@ -990,7 +1205,7 @@ static union tarot_value copy_literal_value(
 			break;
 		case VALUE_RAW_STRING:
 		case VALUE_STRING:
-			result.String = tarot_copy_string(value.String);
+			result.String = tarot_retain(value.String);
 			break;
 	}
 	return result;
@@ -1002,7 +1217,7 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 		return node;
 	}
 	node = tarot_create_node(kind_of(original), position_of(original));
-	memcpy(node, original, sizeof(*node));
+	memcpy(node, original, node_size(kind_of(original)));
 	switch (kind_of(original)) {
 		size_t i;
 		default:
@@ -1012,7 +1227,7 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 			break;
 		case NODE_Module:
 			Module(node)->block = tarot_copy_node(Module(original)->block);
-			Module(node)->scope = tarot_copy_list(Module(original)->scope);
+			Module(node)->scope = copy_scope(Module(original)->scope);
 			break;
 		case NODE_Block:
 			Block(node)->elements = tarot_malloc(sizeof(node) * Block(node)->num_elements);
@@ -1050,7 +1265,7 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 			break;
 		case NODE_Relation:
 			Relation(node)->parent = tarot_copy_node(Relation(original)->parent);
-			Relation(node)->child = tarot_copy_string(Relation(original)->child);
+			Relation(node)->child = tarot_retain(Relation(original)->child);
 			break;
 		case NODE_Subscript:
 			Subscript(node)->identifier = tarot_copy_node(Subscript(original)->identifier);
@@ -1063,6 +1278,10 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 		case NODE_Typecast:
 			CastExpression(node)->operand = tarot_copy_node(CastExpression(original)->operand);
 			break;
+		case NODE_Channel:
+			ChannelExpression(node)->type = tarot_copy_node(ChannelExpression(original)->type);
+			ChannelExpression(node)->capacity = tarot_copy_node(ChannelExpression(original)->capacity);
+			break;
 		case NODE_Literal:
 			Literal(node)->value = copy_literal_value(Literal(original)->kind, Literal(original)->value);
 			break;
@@ -1083,27 +1302,28 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 			for (i = 0; i < FString(node)->num_elements; i++) {
 				FString(node)->elements[i] = tarot_copy_node(FString(original)->elements[i]);
 			}
+			FString(node)->is_temporary = FString(original)->is_temporary;
 			break;
 		case NODE_FStringString:
-			FStringString(node)->value = tarot_copy_string(FStringString(original)->value);
+			FStringString(node)->value = tarot_retain(FStringString(original)->value);
 			break;
 		case NODE_FStringExpression:
 			FStringExpression(node)->expression = tarot_copy_node(FStringExpression(original)->expression);
 			break;
 		case NODE_Identifier:
-			Identifier(node)->name = tarot_copy_string(Identifier(original)->name);
+			Identifier(node)->name = tarot_retain(Identifier(original)->name);
 			break;
 		case NODE_Enumerator:
-			Enumerator(node)->name = tarot_copy_string(Identifier(original)->name);
+			Enumerator(node)->name = tarot_retain(Identifier(original)->name);
 			break;
 		case NODE_Type:
 			Type(node)->identifier = tarot_copy_node(Type(original)->identifier);
 			Type(node)->subtype = tarot_copy_node(Type(original)->subtype);
 			break;
 		case NODE_Import:
-			ImportStatement(node)->path = tarot_copy_string(ImportStatement(original)->path);
+			ImportStatement(node)->path = tarot_retain(ImportStatement(original)->path);
 			ImportStatement(node)->identifier = tarot_copy_node(ImportStatement(original)->identifier);
-			ImportStatement(node)->alias = tarot_copy_string(ImportStatement(original)->alias);
+			ImportStatement(node)->alias = tarot_retain(ImportStatement(original)->alias);
 			break;
 		case NODE_If:
 			IfStatement(node)->condition = tarot_copy_node(IfStatement(original)->condition);
@@ -1118,6 +1338,7 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 			ForLoop(node)->identifier = tarot_copy_node(ForLoop(original)->identifier);
 			ForLoop(node)->expression = tarot_copy_node(ForLoop(original)->expression);
 			ForLoop(node)->block = tarot_copy_node(ForLoop(original)->block);
+			ForLoop(node)->reduction = tarot_copy_node(ForLoop(original)->reduction);
 			break;
 		case NODE_Match:
 			MatchStatement(node)->pattern = tarot_copy_node(MatchStatement(original)->pattern);
@@ -1130,6 +1351,7 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 		case NODE_Assignment:
 			Assignment(node)->identifier = tarot_copy_node(Assignment(original)->identifier);
 			Assignment(node)->value = tarot_copy_node(Assignment(original)->value);
+			Assignment(node)->in_place = Assignment(original)->in_place;
 			break;
 		case NODE_ExpressionStatement:
 			ExprStatement(node)->expression = tarot_copy_node(ExprStatement(original)->expression);
@@ -1151,6 +1373,9 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 		case NODE_Raise:
 			RaiseStatement(node)->identififer = tarot_copy_node(RaiseStatement(original)->identififer);
 			break;
+		case NODE_Launch:
+			LaunchStatement(node)->call = tarot_copy_node(LaunchStatement(original)->call);
+			break;
 		case NODE_Return:
 			ReturnStatement(node)->expression = tarot_copy_node(ReturnStatement(original)->expression);
 			break;
@@ -1158,68 +1383,68 @@ struct tarot_node* tarot_copy_node(struct tarot_node *original) {
 			AssertStatement(node)->condition = tarot_copy_node(AssertStatement(original)->condition);
 			break;
 		case NODE_Class:
-			ClassDefinition(node)->name = tarot_copy_string(ClassDefinition(original)->name);
+			ClassDefinition(node)->name = tarot_retain(ClassDefinition(original)->name);
 			ClassDefinition(node)->extends = tarot_copy_node(ClassDefinition(original)->extends);
 			ClassDefinition(node)->block = tarot_copy_node(ClassDefinition(original)->block);
 			break;
 		case NODE_Enum:
-			EnumDefinition(node)->name = tarot_copy_string(EnumDefinition(original)->name);
+			EnumDefinition(node)->name = tarot_retain(EnumDefinition(original)->name);
 			EnumDefinition(node)->block = tarot_copy_node(EnumDefinition(original)->block);
 			break;
 		case NODE_Constructor:
 			ClassConstructor(node)->parameters = tarot_copy_node(ClassConstructor(original)->parameters);
 			ClassConstructor(node)->block = tarot_copy_node(ClassConstructor(original)->block);
-			ClassConstructor(node)->scope = tarot_copy_list(ClassConstructor(original)->scope);
+			ClassConstructor(node)->scope = copy_scope(ClassConstructor(original)->scope);
 			break;
 		case NODE_Function:
-			FunctionDefinition(node)->name = tarot_copy_string(FunctionDefinition(original)->name);
+			FunctionDefinition(node)->name = tarot_retain(FunctionDefinition(original)->name);
 			FunctionDefinition(node)->parameters = tarot_copy_node(FunctionDefinition(original)->parameters);
 			FunctionDefinition(node)->return_value = tarot_copy_node(FunctionDefinition(original)->return_value);
 			FunctionDefinition(node)->block = tarot_copy_node(FunctionDefinition(original)->block);
-			FunctionDefinition(node)->scope = tarot_copy_list(FunctionDefinition(original)->scope);
+			FunctionDefinition(node)->scope = copy_scope(FunctionDefinition(original)->scope);
 			break;
 		case NODE_Method:
-			MethodDefinition(node)->name = tarot_copy_string(MethodDefinition(original)->name);
+			MethodDefinition(node)->name = tarot_retain(MethodDefinition(original)->name);
 			MethodDefinition(node)->parameters = tarot_copy_node(MethodDefinition(original)->parameters);
 			MethodDefinition(node)->return_value = tarot_copy_node(MethodDefinition(original)->return_value);
 			MethodDefinition(node)->block = tarot_copy_node(MethodDefinition(original)->block);
-			MethodDefinition(node)->scope = tarot_copy_list(MethodDefinition(original)->scope);
+			MethodDefinition(node)->scope = copy_scope(MethodDefinition(original)->scope);
 			break;
 		case NODE_ForeignFunction:
-			ForeignFunction(node)->name = tarot_copy_string(ForeignFunction(original)->name);
+			ForeignFunction(node)->name = tarot_retain(ForeignFunction(original)->name);
 			ForeignFunction(node)->parameters = tarot_copy_node(ForeignFunction(original)->parameters);
 			ForeignFunction(node)->return_value = tarot_copy_node(ForeignFunction(original)->return_value);
 			break;
 		case NODE_Namespace:
-			Namespace(node)->name = tarot_copy_string(Namespace(original)->name);
+			Namespace(node)->name = tarot_retain(Namespace(original)->name);
 			Namespace(node)->block = tarot_copy_node(Namespace(original)->block);
-			Namespace(node)->scope = tarot_copy_list(Namespace(original)->scope);
+			Namespace(node)->scope = copy_scope(Namespace(original)->scope);
 			break;
 		case NODE_TypeDefinition:
-			TypeDefinition(node)->name = tarot_copy_string(TypeDefinition(original)->name);
+			TypeDefinition(node)->name = tarot_retain(TypeDefinition(original)->name);
 			TypeDefinition(node)->original = tarot_copy_node(TypeDefinition(original)->original);
 			break;
 		case NODE_Union:
-			UnionDefinition(node)->name = tarot_copy_string(UnionDefinition(original)->name);
+			UnionDefinition(node)->name = tarot_retain(UnionDefinition(original)->name);
 			UnionDefinition(node)->block = tarot_copy_node(UnionDefinition(original)->block);
 			break;
 		case NODE_Variable:
-			Variable(node)->name = tarot_copy_string(Variable(original)->name);
+			Variable(node)->name = tarot_retain(Variable(original)->name);
 			Variable(node)->type = tarot_copy_node(Variable(original)->type);
 			Variable(node)->value = tarot_copy_node(Variable(original)->value);
 			break;
 		case NODE_Attribute:
-			Attribute(node)->name = tarot_copy_string(Attribute(original)->name);
+			Attribute(node)->name = tarot_retain(Attribute(original)->name);
 			Attribute(node)->type = tarot_copy_node(Attribute(original)->type);
 			Attribute(node)->value = tarot_copy_node(Attribute(original)->value);
 			break;
 		case NODE_Constant:
-			Constant(node)->name = tarot_copy_string(Constant(original)->name);
+			Constant(node)->name = tarot_retain(Constant(original)->name);
 			Constant(node)->type = tarot_copy_node(Constant(original)->type);
 			Constant(node)->value = tarot_copy_node(Constant(original)->value);
 			break;
 		case NODE_Parameter:
-			Parameter(node)->name = tarot_copy_string(Parameter(original)->name);
+			Parameter(node)->name = tarot_retain(Parameter(original)->name);
 			Parameter(node)->type = tarot_copy_node(Parameter(original)->type);
 			Parameter(node)->value = tarot_copy_node(Parameter(original)->value);
 			break;
@@ -1337,12 +1562,20 @@ static void free_node(
 			tarot_free_string(Parameter(node)->name);
 			break;
 	}
-	tarot_free(node);
 	*nodeptr = NULL;
 }
 
 void tarot_free_node(struct tarot_node *node) {
+	struct tarot_node *next_module;
 	tarot_traverse_postorder(node, free_node, NULL);
+	/* The traversal covered all modules, their nodes are freed only now, as
+	 * nodes created during analysis may hang off a module of another arena */
+	if (kind_of(node) == NODE_Module) {
+		for (; node != NULL; node = next_module) {
+			next_module = Module(node)->next_module;
+			tarot_free_node_arena(Module(node)->arena);
+		}
+	}
 }
 
 /******************************************************************************
@@ -1434,6 +1667,10 @@ static void traverse_node(
 		case NODE_Typecast:
 			traverse_node(&CastExpression(node)->operand, state);
 			break;
+		case NODE_Channel:
+			traverse_node(&ChannelExpression(node)->type, state);
+			traverse_node(&ChannelExpression(node)->capacity, state);
+			break;
 		case NODE_List:
 			for (i = 0; i < List(node)->num_elements; i++) {
 				traverse_node(&List(node)->elements[i], state);
@@ -1468,6 +1705,7 @@ static void traverse_node(
 		case NODE_For:
 			traverse_node(&ForLoop(node)->identifier, state);
 			traverse_node(&ForLoop(node)->expression, state);
+			traverse_node(&ForLoop(node)->reduction, state);
 			traverse_node(&ForLoop(node)->block, state);
 			break;
 		case NODE_Match:
@@ -1505,6 +1743,9 @@ static void traverse_node(
 		case NODE_Raise:
 			traverse_node(&RaiseStatement(node)->identififer, state);
 			break;
+		case NODE_Launch:
+			traverse_node(&LaunchStatement(node)->call, state);
+			break;
 		case NODE_Return:
 			traverse_node(&ReturnStatement(node)->expression, state);
 			break;
@@ -6,6 +6,10 @@
 #include "datatypes/value.h"
 #include "system/iostream.h"
 
+/* Forward declaration */
+struct scope;
+struct tarot_node_arena;
+
 /******************************************************************************
  * MARK: Visibility
  *****************************************************************************/
@@ -40,6 +44,7 @@ enum tarot_datatype {
 	TYPE_STRING,
 	TYPE_LIST,
 	TYPE_DICT,
+	TYPE_CHANNEL,
 	TYPE_CUSTOM
 };
 
@@ -102,6 +107,7 @@ enum tarot_node_kind {
 	NODE_Literal,
 	NODE_List,
 	NODE_Dict,
+	NODE_Channel,
 	NODE_FString,
 	NODE_FStringString,
 	NODE_FStringExpression,
@@ -121,6 +127,7 @@ enum tarot_node_kind {
 	NODE_Try,
 	NODE_Catch,
 	NODE_Raise,
+	NODE_Launch,
 	NODE_Return,
 	NODE_Assert,
 	NODE_Class,
@@ -162,7 +169,8 @@ struct Module {
 	char *path;
 	struct tarot_node *next_module;
 	struct tarot_node *block;
-	struct tarot_list *scope;
+	struct scope *scope;
+	struct tarot_node_arena *arena; /**< Holds the nodes of the module */
 	size_t num_nodes;
 	size_t num_errors;
 	bool is_root;
@@ -188,6 +196,7 @@ struct Block {
 		BLOCK_SCOPED,
 		BLOCK_LIST
 	} kind;
+	bool allocates; /* may leave objects in the current region */
 };
 
 /**
@@ -440,6 +449,24 @@ struct CastExpression {
  */
 extern struct CastExpression* CastExpression(struct tarot_node *node);
 
+/******************************************************************************
+ * MARK: Channel
+ *****************************************************************************/
+
+/**
+ * Creates a channel that passes values of the element type between threads.
+ * Without a capacity the channel is unbounded.
+ */
+struct ChannelExpression {
+	struct tarot_node *type;
+	struct tarot_node *capacity;
+};
+
+/**
+ *
+ */
+extern struct ChannelExpression* ChannelExpression(struct tarot_node *node);
+
 /******************************************************************************
  * MARK: Literal
  *****************************************************************************/
@@ -488,6 +515,7 @@ extern struct tarot_string* String(struct tarot_node *node);
 struct FString {
 	struct tarot_node **elements;
 	size_t num_elements;
+	bool is_temporary; /* the result dies within its statement */
 };
 
 /**
@@ -537,6 +565,7 @@ extern struct FStringExpression* FStringExpression(struct tarot_node *node);
 struct Identifier {
 	struct tarot_string *name;
 	struct tarot_node *link;
+	bool is_last_use; /* the linked variable is dead afterwards */
 };
 
 /**
@@ -610,8 +639,6 @@ struct IfStatement {
 	struct tarot_node *condition;
 	struct tarot_node *block;
 	struct tarot_node *elseif;
-	uint16_t middle;
-	uint16_t end;
 };
 
 /**
@@ -630,7 +657,7 @@ struct WhileLoop {
 	struct tarot_node *condition;
 	struct tarot_node *block;
 	size_t start;
-	size_t end;
+	bool condition_allocates;
 };
 
 /**
@@ -649,8 +676,13 @@ struct ForLoop {
 	struct tarot_node *identifier;
 	struct tarot_node *expression;
 	struct tarot_node *block;
+	struct tarot_node *reduction; /* variable the chunks of a parallel loop add up to */
+	enum ArithmeticExpressionOperator operator; /* combines the chunks of a reduction */
 	size_t start;
-	size_t end;
+	bool condition_allocates;
+	bool block_allocates; /* body and increment */
+	bool is_parallel; /* chunks of the range run on threads of their own */
+	bool is_ordered; /* output of the chunks is printed in the order of the range */
 };
 
 /**
@@ -702,6 +734,7 @@ extern struct CaseStatement* CaseStatement(struct tarot_node *node);
 struct Assignment {
 	struct tarot_node *identifier;
 	struct tarot_node *value;
+	bool in_place; /* target is updated in place, see mark_in_place_assignment */
 };
 
 /**
@@ -769,8 +802,6 @@ struct TryStatement {
 	struct tarot_node *block;
 	struct tarot_node *handlers;
 	size_t end;
-	size_t handlers_start;
-	size_t handlers_end;
 };
 
 /**
@@ -813,6 +844,23 @@ struct RaiseStatement {
  */
 extern struct RaiseStatement* RaiseStatement(struct tarot_node *node);
 
+/******************************************************************************
+ * MARK: Launch
+ *****************************************************************************/
+
+/**
+ * Runs a function call on a new green thread. The arguments are copies
+ * owned by the new thread, the return value is discarded.
+ */
+struct LaunchStatement {
+	struct tarot_node *call;
+};
+
+/**
+ *
+ */
+extern struct LaunchStatement* LaunchStatement(struct tarot_node *node);
+
 /******************************************************************************
  * MARK: Return
  *****************************************************************************/
@@ -859,7 +907,7 @@ struct ClassDefinition {
 	struct tarot_string *name;
 	struct tarot_node *extends;
 	struct tarot_node *block;
-	struct tarot_list *scope;
+	struct scope *scope;
 	enum tarot_visibility visibility;
 };
 
@@ -898,7 +946,7 @@ struct ClassConstructor {
 	struct tarot_node *return_value;
 	struct tarot_node *block;
 	struct tarot_node *link;
-	struct tarot_list *scope;
+	struct scope *scope;
 	uint16_t index;
 };
 
@@ -920,11 +968,11 @@ struct FunctionDefinition {
 	struct tarot_node *parameters;
 	struct tarot_node *return_value;
 	struct tarot_node *block;
-	struct tarot_list *scope;
+	struct scope *scope;
 	enum tarot_visibility visibility;
 	uint16_t index;
-	uint16_t address;
-	uint16_t finally;
+	tarot_address address;
+	tarot_address finally;
 };
 
 /**
@@ -967,7 +1015,7 @@ extern struct ForeignFunction* ForeignFunction(struct tarot_node *node);
 struct Namespace {
 	struct tarot_string *name;
 	struct tarot_node *block;
-	struct tarot_list *scope;
+	struct scope *scope;
 	enum tarot_visibility visibility;
 };
 
@@ -1023,7 +1071,9 @@ struct Variable {
 	struct tarot_string *name;
 	struct tarot_node *type;
 	struct tarot_node *value;
+	struct tarot_node *last_use; /* Identifier, used by the last-use analysis */
 	uint16_t index;
+	uint8_t loop_depth;
 	bool is_constant;
 	bool is_set;
 };
@@ -1071,7 +1121,7 @@ extern struct Parameter* Parameter(struct tarot_node *node);
  */
 struct Builtin {
 	struct tarot_string *name;
-	struct tarot_node *builtin_type;
+	enum tarot_datatype builtin_type;
 	struct tarot_node *return_type;
 };
 
@@ -1151,10 +1201,35 @@ extern struct tarot_node* definition_of(struct tarot_node *node);
  */
 extern struct tarot_node* type_of(struct tarot_node *node);
 
-extern struct tarot_list* scope_of(struct tarot_node *node);
+extern struct scope* scope_of(struct tarot_node *node);
+
+/**
+ * Creates an arena for the nodes of a module. Nodes are bump allocated
+ * from chunks of the arena and released all at once with the arena.
+ */
+extern struct tarot_node_arena* tarot_create_node_arena(void);
+
+/**
+ * Frees the arena and with it all nodes allocated from it.
+ */
+extern void tarot_free_node_arena(struct tarot_node_arena *arena);
+
+/**
+ * Makes new nodes get allocated from the given arena, which may be NULL.
+ * Returns the arena that was in use before.
+ */
+extern struct tarot_node_arena* tarot_use_node_arena(
+	struct tarot_node_arena *arena
+);
+
+/**
+ * Returns the arena new nodes are allocated from.
+ */
+extern struct tarot_node_arena* tarot_current_node_arena(void);
 
 /**
- * Creates a new node of the specified node kind.
+ * Creates a new node of the specified node kind in the current node arena.
+ * The node only occupies as much memory as its kind requires.
  */
 extern struct tarot_node* tarot_create_node(
 	enum tarot_node_kind kind,
@@ -1173,6 +1248,8 @@ extern struct tarot_node* tarot_copy_node(struct tarot_node *node);
 
 /**
  * Frees the node and all of its children recursively via postorder traversal.
+ * The memory of the nodes returns to the system with the arena of their
+ * module, which is freed along with the module (and the modules it imports).
  */
 extern void tarot_free_node(struct tarot_node *node);
 
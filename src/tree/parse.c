@@ -6,7 +6,7 @@
  *****************************************************************************/
 
 struct tarot_parser {
-	struct tarot_iostream *stream; /**< The token input stream          */
+	struct tarot_scanner *scanner; /**< The token source                */
 	struct tarot_token *current;   /**< Points to the current token     */
 	struct tarot_token *next;      /**< Points to the next token        */
 	struct tarot_token tokens[2];  /**< Token buffer for current & next */
@@ -15,26 +15,26 @@ struct tarot_parser {
 };
 
 static void read_token(
-	struct tarot_iostream *stream,
+	struct tarot_scanner *scanner,
 	struct tarot_token *token
 ) {
 	do {
-		tarot_read_token(stream, token);
+		tarot_scan_token(scanner, token);
 	} while (token->kind == TAROT_TOK_COMMENT);
 }
 
 static void initialize_parser(
 	struct tarot_parser *parser,
-	struct tarot_iostream *stream
+	struct tarot_scanner *scanner
 ) {
 	assert(parser != NULL);
-	assert(stream != NULL);
-	parser->stream  = stream;
+	assert(scanner != NULL);
+	parser->scanner = scanner;
 	parser->current = &parser->tokens[0];
 	parser->next    = &parser->tokens[1];
 	parser->is_calm = true;
-	read_token(parser->stream, parser->current);
-	read_token(parser->stream, parser->next);
+	read_token(parser->scanner, parser->current);
+	read_token(parser->scanner, parser->next);
 	memset(&parser->scopes, 0, sizeof(parser->scopes));
 }
 
@@ -59,7 +59,7 @@ static void advance(struct tarot_parser *parser) {
 	assert(parser != NULL);
 	if (parser->current->kind != TAROT_TOK_EOF) {
 		swap(struct tarot_token*, parser->current, parser->next);
-		read_token(parser->stream, parser->next);
+		read_token(parser->scanner, parser->next);
 	} else {
 		parser->is_calm = false;
 		tarot_error_at(
@@ -92,6 +92,24 @@ static bool peek(
 	);
 }
 
+/* Copies the current token, its text is only materialized at this point */
+static void take_token(
+	struct tarot_parser *parser,
+	struct tarot_token *token
+) {
+	memcpy(token, parser->current, sizeof(*token));
+	switch (token->kind) {
+		default:
+			break;
+		case TAROT_TOK_IDENTIFIER:
+		case TAROT_TOK_STRING:
+		case TAROT_TOK_FSTRING:
+		case TAROT_TOK_RSTRING:
+			token->value.String = tarot_token_text(parser->scanner, token);
+			break;
+	}
+}
+
 static bool match(
 	struct tarot_parser *parser,
 	enum tarot_token_kind type,
@@ -101,7 +119,7 @@ static bool match(
 	assert(parser != NULL);
 	if (current(parser, type)) {
 		if (token != NULL) {
-			memcpy(token, parser->current, sizeof(*token));
+			take_token(parser, token);
 		}
 		/* Only advance if we do not expect the end of the file yet: */
 		if (type != TAROT_TOK_EOF) {
@@ -121,10 +139,10 @@ static bool match_identifier(
 	assert(parser != NULL);
 	if (
 		current(parser, TAROT_TOK_IDENTIFIER) and
-		tarot_match_string(parser->current->value.String, name)
+		tarot_token_matches(parser->scanner, parser->current, name)
 	) {
 		if (token != NULL) {
-			memcpy(token, parser->current, sizeof(*token));
+			take_token(parser, token);
 		}
 		advance(parser);
 		success = true;
@@ -213,6 +231,7 @@ static struct tarot_node* parse_definition(struct tarot_parser *parser);
 static struct tarot_node* parse_expression(struct tarot_parser *parser);
 static struct tarot_node* parse_statement(struct tarot_parser *parser);
 static struct tarot_node* parse_global(struct tarot_parser *parser);
+static struct tarot_node* parse_datatype(struct tarot_parser *parser);
 
 /******************************************************************************
  * MARK: > Utils
@@ -299,7 +318,7 @@ static struct tarot_node* parse_identifier(struct tarot_parser *parser) {
 	struct tarot_token token;
 	if (match(parser, TAROT_TOK_SELF, &token)) {
 		node = tarot_create_node(NODE_Identifier, &token.position);
-		Identifier(node)->name = tarot_create_string("self");
+		Identifier(node)->name = tarot_intern_text("self", 4);
 	} else if (match(parser, TAROT_TOK_IDENTIFIER, &token)) {
 		node = tarot_create_node(NODE_Identifier, &token.position);
 		Identifier(node)->name = token.value.String;
@@ -389,7 +408,7 @@ static struct tarot_list* parse_fstring(struct tarot_token *token) {
 		struct tarot_node *object = NULL;
 		if (*strptr == '{') { /* F-String expression */
 			struct tarot_parser parser;
-			struct tarot_iostream *stream;
+			struct tarot_scanner scanner;
 			unsigned int brackets = 1;
 			struct tarot_string *string = tarot_create_string("");
 			strptr++; /* skip '{' */
@@ -404,9 +423,13 @@ static struct tarot_list* parse_fstring(struct tarot_token *token) {
 				}
 				tarot_string_append(&string, "%c", *strptr++);
 			}
-			stream = tarot_fstropen(&string, TAROT_INPUT);
-			tarot_override_stream_position(stream, &token->position);
-			initialize_parser(&parser, stream);
+			tarot_open_scanner(
+				&scanner,
+				tarot_string_text(string),
+				&token->position,
+				TAROT_SCAN_FAST
+			);
+			initialize_parser(&parser, &scanner);
 			object = tarot_create_node(NODE_FStringExpression, &token->position);
 			FStringExpression(object)->expression = parse_expression(&parser);
 			expect(&parser, TAROT_TOK_EOF);
@@ -414,7 +437,6 @@ static struct tarot_list* parse_fstring(struct tarot_token *token) {
 				tarot_error_at(&token->position, "Invalid fstring expression");
 			}
 			exit_parser(&parser);
-			tarot_fclose(stream);
 			tarot_free_string(string);
 			strptr++; /* skip '}' */
 		} else { /* F-String string slice */
@@ -423,7 +445,7 @@ static struct tarot_list* parse_fstring(struct tarot_token *token) {
 				tarot_string_append(&string, "%c", *strptr++);
 			}
 			object = tarot_create_node(NODE_FStringString, &token->position);
-			FStringString(object)->value = string;
+			FStringString(object)->value = tarot_intern_string(string);
 		}
 		tarot_list_append(&slices, &object);
 	}
@@ -444,7 +466,7 @@ static struct tarot_node* parse_string(struct tarot_parser *parser) {
 			);
 			tarot_free_string(Literal(node)->value.String);
 			tarot_clear_token(&token);
-			Literal(node)->value.String = new_string;
+			Literal(node)->value.String = tarot_intern_string(new_string);
 		}
 	} else if (match(parser, TAROT_TOK_FSTRING, &token)) {
 		struct tarot_list *slices = parse_fstring(&token);
@@ -623,6 +645,29 @@ static struct tarot_node* parse_input(struct tarot_parser *parser) {
 	return result(parser, node);
 }
 
+/**
+ * Channel[Type](Capacity?)
+ */
+static struct tarot_node* parse_channel(struct tarot_parser *parser) {
+	struct tarot_node *node = NULL;
+	struct tarot_token token;
+	if (match_identifier(parser, "Channel", &token)) {
+		node = tarot_create_node(NODE_Channel, &token.position);
+		ChannelExpression(node)->type = tarot_create_node(NODE_Type, &token.position);
+		Type(ChannelExpression(node)->type)->type = TYPE_CHANNEL;
+		expect(parser, TAROT_TOK_OPEN_ANGULAR_BRACKET);
+		Type(ChannelExpression(node)->type)->subtype = parse_datatype(parser);
+		expect(parser, TAROT_TOK_CLOSE_ANGULAR_BRACKET);
+		expect(parser, TAROT_TOK_OPEN_BRACKET);
+		if (not match(parser, TAROT_TOK_CLOSE_BRACKET, NULL)) {
+			ChannelExpression(node)->capacity = parse_expression(parser);
+			expect(parser, TAROT_TOK_CLOSE_BRACKET);
+		}
+		tarot_clear_token(&token);
+	}
+	return result(parser, node);
+}
+
 static bool match_builtin_type(
 	struct tarot_parser *parser,
 	struct tarot_token *token
@@ -646,7 +691,8 @@ static enum tarot_datatype string_to_datatype(struct tarot_string *string) {
 		TYPE_RATIONAL,
 		TYPE_STRING,
 		TYPE_LIST,
-		TYPE_DICT
+		TYPE_DICT,
+		TYPE_CHANNEL
 	};
 	for (type = 0; type < lengthof(types); type++) {
 		if (tarot_match_string(string, datatype_string(type))) {
@@ -738,6 +784,7 @@ static struct tarot_node* parse_unary_expression(struct tarot_parser *parser) {
 	(node = parse_range_expression(parser)) or
 	(node = parse_typecast(parser)) or
 	(node = parse_input(parser)) or
+	(node = parse_channel(parser)) or
 	(node = parse_value_expression(parser)) or
 	(node = parse_primary_expression(parser));
 	return result(parser, node);
@@ -1150,7 +1197,7 @@ static struct tarot_node* parse_namespace(struct tarot_parser *parser) {
 		node = tarot_create_node(NODE_Namespace, &token.position);
 		Namespace(node)->name = read_identifier(parser);
 		Namespace(node)->scope = create_scope();
-		enter_scope(&parser->scopes, &Namespace(node)->scope);
+		enter_scope(&parser->scopes, Namespace(node)->scope);
 		Namespace(node)->block = parse_scoped_block(parser, parse_global);
 		leave_scope(&parser->scopes, Namespace(node)->scope);
 	}
@@ -1267,6 +1314,17 @@ static struct tarot_node* parse_raise(struct tarot_parser *parser) {
 	return result(parser, node);
 }
 
+static struct tarot_node* parse_launch(struct tarot_parser *parser) {
+	struct tarot_node *node = NULL;
+	struct tarot_token token;
+	if (match(parser, TAROT_TOK_LAUNCH, &token)) {
+		node = tarot_create_node(NODE_Launch, &token.position);
+		LaunchStatement(node)->call = parse_expression(parser);
+		expect(parser, TAROT_TOK_SEMICOLON);
+	}
+	return result(parser, node);
+}
+
 static struct tarot_node* parse_return(struct tarot_parser *parser) {
 	struct tarot_node *node = NULL;
 	struct tarot_token token;
@@ -1310,29 +1368,64 @@ static struct tarot_node* parse_while(struct tarot_parser *parser) {
 	return result(parser, node);
 }
 
+static struct tarot_node* parse_for_loop(
+	struct tarot_parser *parser,
+	struct tarot_stream_position *position,
+	bool is_parallel
+) {
+	struct tarot_node *value = NULL;
+	struct tarot_node *node = tarot_create_node(NODE_For, position);
+	/* or make new node kind NODE_Iterator with reference to the expression
+	 * because we cannot determine type of iterator at parse stage
+	 */
+	ForLoop(node)->identifier = tarot_create_node(NODE_Variable, position_of(node));
+	Variable(ForLoop(node)->identifier)->name = read_identifier(parser);
+	Variable(ForLoop(node)->identifier)->type = tarot_create_node(NODE_Type, position_of(node));
+	Type(Variable(ForLoop(node)->identifier)->type)->type = TYPE_INTEGER;
+	add_to_current_scope(parser, ForLoop(node)->identifier);
+	value = create_literal(position_of(node), VALUE_INTEGER);
+	Literal(value)->type = TYPE_INTEGER;
+	Literal(value)->value.Integer = tarot_create_integer_from_short(0);
+	Variable(ForLoop(node)->identifier)->value = value;
+	expect(parser, TAROT_TOK_IN);
+	ForLoop(node)->expression = parse_expression(parser);
+	ForLoop(node)->is_parallel = is_parallel;
+	if (is_parallel and match_identifier(parser, "reduce", NULL)) {
+		ForLoop(node)->reduction = parse_identifier(parser);
+		if (not match_identifier(parser, "with", NULL)) {
+			tarot_error_at(&parser->current->position, "Expected with and an operator after the reduced variable.");
+		} else if (match(parser, TAROT_TOK_MULTIPLY, NULL)) {
+			ForLoop(node)->operator = EXPR_MULTIPLY;
+		} else {
+			expect(parser, TAROT_TOK_PLUS);
+			ForLoop(node)->operator = EXPR_ADD;
+		}
+	}
+	parser->scopes.loop = node;
+	ForLoop(node)->block = parse_scoped_block(parser, parse_statement);
+	parser->scopes.loop = NULL; /* FIXME: Fucks with nested loops and break */
+	return node;
+}
+
 static struct tarot_node* parse_for(struct tarot_parser *parser) {
 	struct tarot_node *node = NULL;
 	struct tarot_token token;
 	if (match(parser, TAROT_TOK_FOR, &token)) {
-		struct tarot_node *value = NULL;
-		node = tarot_create_node(NODE_For, &token.position);
-		/* or make new node kind NODE_Iterator with reference to the expression
-		 * because we cannot determine type of iterator at parse stage
-		 */
-		ForLoop(node)->identifier = tarot_create_node(NODE_Variable, position_of(node));
-		Variable(ForLoop(node)->identifier)->name = read_identifier(parser);
-		Variable(ForLoop(node)->identifier)->type = tarot_create_node(NODE_Type, position_of(node));
-		Type(Variable(ForLoop(node)->identifier)->type)->type = TYPE_INTEGER;
-		add_to_current_scope(parser, ForLoop(node)->identifier);
-		value = create_literal(position_of(node), VALUE_INTEGER);
-		Literal(value)->type = TYPE_INTEGER;
-		Literal(value)->value.Integer = tarot_create_integer_from_short(0);
-		Variable(ForLoop(node)->identifier)->value = value;
-		expect(parser, TAROT_TOK_IN);
-		ForLoop(node)->expression = parse_expression(parser);
-		parser->scopes.loop = node;
-		ForLoop(node)->block = parse_scoped_block(parser, parse_statement);
-		parser->scopes.loop = NULL; /* FIXME: Fucks with nested loops and break */
+		node = parse_for_loop(parser, &token.position, false);
+	}
+	return result(parser, node);
+}
+
+/* parallel [ordered] for i in range(n) [reduce x with +|*] { ... } */
+static struct tarot_node* parse_parallel_for(struct tarot_parser *parser) {
+	struct tarot_node *node = NULL;
+	struct tarot_token token;
+	if (match_identifier(parser, "parallel", &token)) {
+		bool is_ordered = match_identifier(parser, "ordered", NULL);
+		tarot_clear_token(&token);
+		expect(parser, TAROT_TOK_FOR);
+		node = parse_for_loop(parser, &token.position, true);
+		ForLoop(node)->is_ordered = is_ordered;
 	}
 	return result(parser, node);
 }
@@ -1459,11 +1552,11 @@ static struct tarot_node* parse_import(struct tarot_parser *parser) {
 		if (match(parser, TAROT_TOK_AS, NULL)) {
 			ImportStatement(node)->alias = read_identifier(parser);
 		} else if (kind_of(ImportStatement(node)->identifier) == NODE_Relation) {
-			ImportStatement(node)->alias = tarot_copy_string(
+			ImportStatement(node)->alias = tarot_retain(
 				Relation(ImportStatement(node)->identifier)->child
 			);
 		} else {
-			ImportStatement(node)->alias = tarot_copy_string(name_of(ImportStatement(node)->identifier));
+			ImportStatement(node)->alias = tarot_retain(name_of(ImportStatement(node)->identifier));
 		}
 		expect(parser, TAROT_TOK_SEMICOLON);
 		add_to_current_scope(parser, node);
@@ -1518,10 +1611,12 @@ static struct tarot_node* parse_statement(struct tarot_parser *parser) {
 	(node = parse_assert(parser))     or
 	(node = parse_import(parser))     or
 	(node = parse_raise(parser))      or
+	(node = parse_launch(parser))     or
 	(node = parse_return(parser))     or
 	(node = parse_if(parser))         or
 	(node = parse_while(parser))      or
 	(node = parse_for(parser))        or
+	(node = parse_parallel_for(parser)) or
 	(node = parse_break(parser))      or
 	(node = parse_breakpoint(parser)) or
 	(node = parse_match(parser))      or
@@ -1550,7 +1645,8 @@ static struct tarot_node* parse_module(struct tarot_parser *parser) {
 	node = tarot_create_node(NODE_Module, &parser->current->position);
 	Module(node)->path = parser->current->position.path;
 	Module(node)->scope = create_scope();
-	enter_scope(&parser->scopes, &Module(node)->scope);
+	Module(node)->arena = tarot_current_node_arena();
+	enter_scope(&parser->scopes, Module(node)->scope);
 	Module(node)->block = parse_block(parser, parse_global);
 	leave_scope(&parser->scopes, Module(node)->scope);
 	Module(node)->num_nodes = tarot_num_nodes();
@@ -1567,39 +1663,48 @@ static void panic(void *data) {
 	parser->is_calm = false;
 }
 
-struct tarot_node* tarot_parse(struct tarot_iostream *stream) {
+struct tarot_node* tarot_parse(
+	const char *source,
+	const char *path,
+	enum tarot_scan_mode mode
+) {
 	struct tarot_node *ast = NULL;
 	struct tarot_parser parser;
-	assert(stream != NULL);
-	tarot_log("Parsing source file \"%s\"", tarot_fgetpos(stream)->path);
+	struct tarot_scanner scanner;
+	struct tarot_stream_position position;
+	struct tarot_node_arena *previous_arena;
+	assert(source != NULL);
+	assert(path != NULL);
+	tarot_log("Parsing source file \"%s\"", path);
+	position.path = path;
+	position.line = 1;
+	position.column = 1;
+	tarot_open_scanner(&scanner, source, &position, mode);
 	tarot_register_error_handler(panic, &parser);
-	initialize_parser(&parser, stream);
+	initialize_parser(&parser, &scanner);
+	previous_arena = tarot_use_node_arena(tarot_create_node_arena());
 	ast = parse_module(&parser);
+	tarot_use_node_arena(previous_arena);
 	exit_parser(&parser);
 	tarot_register_error_handler(NULL, NULL);
 	return ast;
 }
 
 struct tarot_node* tarot_parse_text(const char *data) {
-	struct tarot_node *ast = NULL;
-	struct tarot_iostream *stream;
 	assert(data != NULL);
-	stream = tarot_fmemopen((char*)data, TAROT_INPUT);
-	if (stream != NULL) {
-		ast = tarot_parse(stream);
-		tarot_fclose(stream);
-	}
-	return ast;
+	return tarot_parse(data, "memory", TAROT_SCAN_LINT);
 }
 
-struct tarot_node* tarot_parse_file(const char *path) {
+struct tarot_node* tarot_parse_file(
+	const char *path,
+	enum tarot_scan_mode mode
+) {
 	struct tarot_node *ast = NULL;
-	struct tarot_iostream *stream;
 	char *pathptr = strdup(path);
-	stream = tarot_fopen(pathptr, TAROT_INPUT);
-	if (stream != NULL) {
-		ast = tarot_parse(stream);
-		tarot_fclose(stream);
+	char *source = tarot_read_file(pathptr, NULL);
+	if (source != NULL) {
+		ast = tarot_parse(source, pathptr, mode);
+		tarot_free(source);
 	} else {
 		tarot_free(pathptr);
 	}
@@ -1,38 +1,103 @@
 #define TAROT_SOURCE
 #include "tarot.h"
 
-struct tarot_list* create_scope(void) {
-	return tarot_create_list(sizeof(struct tarot_node*), 5, NULL);
+/* Hashes the name of a symbol. Names are interned, so their address is key */
+static size_t hash_name(struct tarot_string *name) {
+	size_t hash = (size_t)name;
+	return hash ^ (hash >> 4) ^ (hash >> 12);
 }
 
-void destroy_scope(struct tarot_list *scope) {
-	tarot_free_list(scope);
+/* Returns the slot holding the symbol of that name or the empty slot for it */
+static struct tarot_node** find_slot(
+	struct scope *scope,
+	struct tarot_string *name,
+	size_t hash
+) {
+	size_t mask = scope->capacity - 1;
+	size_t i = hash & mask;
+	while (scope->table[i] != NULL and name_of(scope->table[i]) != name) {
+		i = (i + 1) & mask;
+	}
+	return &scope->table[i];
 }
 
-static struct tarot_list** current_scope(struct scope_stack *stack) {
-	assert(stack->nesting > 0); /* "Accessing inactive scope stack? */
-	return stack->scopes[stack->nesting-1];
+/* Indexes the symbol, unless an earlier symbol of the same name shadows it */
+static void index_symbol(struct scope *scope, struct tarot_node *symbol) {
+	struct tarot_string *name = name_of(symbol);
+	struct tarot_node **slot = find_slot(scope, name, hash_name(name));
+	if (*slot == NULL) {
+		*slot = symbol;
+	}
 }
 
-static void set_current_scope(
-	struct scope_stack *stack,
-	struct tarot_list **scope
-) {
+/* Rebuilds the index with the given capacity from the ordered symbols */
+static void rebuild_index(struct scope *scope, size_t capacity) {
+	size_t i;
+	tarot_free(scope->table);
+	scope->capacity = capacity;
+	scope->table = tarot_malloc(sizeof(*scope->table) * capacity);
+	memset(scope->table, 0, sizeof(*scope->table) * capacity);
+	for (i = 0; i < scope_length(scope); i++) {
+		index_symbol(scope, scope_symbol(scope, i));
+	}
+}
+
+struct scope* create_scope(void) {
+	struct scope *scope = tarot_malloc(sizeof(*scope));
+	scope->symbols = tarot_create_list(sizeof(struct tarot_node*), 5, NULL);
+	scope->table = NULL;
+	rebuild_index(scope, 8);
+	return scope;
+}
+
+struct scope* copy_scope(struct scope *scope) {
+	struct scope *copy = tarot_malloc(sizeof(*copy));
+	copy->symbols = tarot_copy_list(scope->symbols);
+	copy->capacity = scope->capacity;
+	copy->table = tarot_malloc(sizeof(*copy->table) * copy->capacity);
+	memcpy(copy->table, scope->table, sizeof(*copy->table) * copy->capacity);
+	return copy;
+}
+
+void destroy_scope(struct scope *scope) {
+	tarot_free_list(scope->symbols);
+	tarot_free(scope->table);
+	tarot_free(scope);
+}
+
+size_t scope_length(struct scope *scope) {
+	return tarot_list_length(scope->symbols);
+}
+
+struct tarot_node* scope_symbol(struct scope *scope, size_t n) {
+	return *(struct tarot_node**)tarot_list_element(scope->symbols, n);
+}
+
+static struct scope* current_scope(struct scope_stack *stack) {
 	assert(stack->nesting > 0); /* "Accessing inactive scope stack? */
-	stack->scopes[stack->nesting-1] = scope;
+	return stack->scopes[stack->nesting-1];
 }
 
-void enter_scope(struct scope_stack *stack, struct tarot_list **scope) {
-	assert(stack->nesting < lengthof(stack->scopes)); /* Scope stack overflow */
-	stack->nesting++;
-	set_current_scope(stack, scope);
+void enter_scope(struct scope_stack *stack, struct scope *scope) {
+	if (stack->nesting == stack->capacity) {
+		stack->capacity = stack->capacity > 0 ? stack->capacity * 2 : 8;
+		stack->scopes = tarot_realloc(
+			stack->scopes,
+			sizeof(*stack->scopes) * stack->capacity
+		);
+	}
+	stack->scopes[stack->nesting++] = scope;
 }
 
-void leave_scope(struct scope_stack *stack, struct tarot_list *scope) {
+void leave_scope(struct scope_stack *stack, struct scope *scope) {
 	assert(stack->nesting > 0);
-	assert(*current_scope(stack) == scope);
-	set_current_scope(stack, NULL);
-	stack->nesting--;
+	assert(current_scope(stack) == scope);
+	unused(scope);
+	if (--stack->nesting == 0) {
+		tarot_free(stack->scopes);
+		stack->scopes = NULL;
+		stack->capacity = 0;
+	}
 }
 
 void enter_node(struct scope_stack *stack, struct tarot_node *node) {
@@ -40,23 +105,26 @@ void enter_node(struct scope_stack *stack, struct tarot_node *node) {
 		default:
 			break;
 		case NODE_Module:
-			enter_scope(stack, &Module(node)->scope);
+			enter_scope(stack, Module(node)->scope);
 			break;
 		case NODE_Namespace:
-			enter_scope(stack, &Namespace(node)->scope);
+			enter_scope(stack, Namespace(node)->scope);
 			break;
 		case NODE_Class:
-			enter_scope(stack, &ClassDefinition(node)->scope);
+			enter_scope(stack, ClassDefinition(node)->scope);
 			stack->class = node;
 			break;
 		case NODE_Function:
-			enter_scope(stack, &FunctionDefinition(node)->scope);
+			enter_scope(stack, FunctionDefinition(node)->scope);
 			stack->function = node;
 			break;
 		case NODE_Method:
-			enter_scope(stack, &MethodDefinition(node)->scope);
+			enter_scope(stack, MethodDefinition(node)->scope);
 			stack->function = node;
 			break;
+		case NODE_Constructor:
+			enter_scope(stack, ClassConstructor(node)->scope);
+			break;
 		case NODE_Import:
 		case NODE_Type:
 			stack->type_checking++;
@@ -86,6 +154,9 @@ void leave_node(struct scope_stack *stack, struct tarot_node *node) {
 			leave_scope(stack, MethodDefinition(node)->scope);
 			stack->function = NULL;
 			break;
+		case NODE_Constructor:
+			leave_scope(stack, ClassConstructor(node)->scope);
+			break;
 		case NODE_Import:
 		case NODE_Type:
 			stack->type_checking--;
@@ -93,28 +164,32 @@ void leave_node(struct scope_stack *stack, struct tarot_node *node) {
 	}
 }
 
+/* Looks for the symbol with the given name and hash of the name */
+static struct tarot_node* find_symbol(
+	struct scope *scope,
+	struct tarot_string *name,
+	size_t hash
+) {
+	struct tarot_node *symbol = *find_slot(scope, name, hash);
+	/* If we were to do definition_of(symbol) here, identifiers to
+	 * enumerators would get linked to the enumeration and not the
+	 * enumerator. This loses information such as index.
+	 */
+	if (
+		symbol != NULL and
+		kind_of(symbol) == NODE_Import and
+		link_of(symbol) != NULL
+	) {
+		symbol = link_of(symbol);
+	}
+	return symbol;
+}
+
 struct tarot_node* lookup_symbol_in_scope(
-	struct tarot_list *scope,
+	struct scope *scope,
 	struct tarot_string *name
 ) {
-	struct tarot_node *result = NULL;
-	size_t i;
-	for (i = 0; i < tarot_list_length(scope); i++) {
-		struct tarot_node *symbol = *(struct tarot_node**)tarot_list_element(scope, i);
-		if (tarot_compare_strings(name_of(symbol), name)) {
-			/* If we were to do definition_of(symbol) here, identifiers to
-			 * enumerators would get linked to the enumeration and not the
-			 * enumerator. This loses information such as index.
-			 */
-			if (kind_of(symbol) == NODE_Import and link_of(symbol) != NULL) {
-				result = link_of(symbol);
-			} else {
-				result = symbol;
-			}
-			break;
-		}
-	}
-	return result;
+	return find_symbol(scope, name, hash_name(name));
 }
 
 struct tarot_node* lookup_symbol(
@@ -122,9 +197,10 @@ struct tarot_node* lookup_symbol(
 	struct tarot_string *name
 ) {
 	struct tarot_node *result = NULL;
-	unsigned int i;
+	size_t hash = hash_name(name);
+	size_t i;
 	for (i = 0; i < stack->nesting; i++) {
-		result = lookup_symbol_in_scope(*(stack->scopes[i]), name);
+		result = find_symbol(stack->scopes[i], name, hash);
 		if (result != NULL) {
 			break;
 		}
@@ -148,15 +224,25 @@ static void raise_redefinition_error(
 	);
 }
 
+/* Appends the symbol to the scope, growing the index at half occupancy */
+static void append_symbol(struct scope *scope, struct tarot_node *node) {
+	tarot_list_append(&scope->symbols, &node);
+	if (scope_length(scope) * 2 > scope->capacity) {
+		rebuild_index(scope, scope->capacity * 2);
+	} else {
+		index_symbol(scope, node);
+	}
+}
+
 void add_symbol_to_scope(
-	struct tarot_list **scope,
+	struct scope *scope,
 	struct tarot_node *node
 ) {
-	struct tarot_node *symbol = lookup_symbol_in_scope(*scope, name_of(node));
+	struct tarot_node *symbol = lookup_symbol_in_scope(scope, name_of(node));
 	if (symbol != NULL) {
 		raise_redefinition_error(symbol, node);
 	} else {
-		tarot_list_append(scope, &node);
+		append_symbol(scope, node);
 	}
 }
 
@@ -164,7 +250,7 @@ void add_symbol_unsafe(
 	struct scope_stack *stack,
 	struct tarot_node *node
 ) {
-	tarot_list_append(current_scope(stack), &node);
+	append_symbol(current_scope(stack), node);
 }
 
 void add_symbol(
@@ -183,8 +269,7 @@ void remove_symbol(
 	struct scope_stack *stack,
 	struct tarot_node *node
 ) {
-	tarot_list_remove(
-		current_scope(stack),
-		tarot_list_lookup(*current_scope(stack), &node)
-	);
+	struct scope *scope = current_scope(stack);
+	tarot_list_remove(&scope->symbols, tarot_list_lookup(scope->symbols, &node));
+	rebuild_index(scope, scope->capacity);
 }
@@ -6,41 +6,70 @@
 
 /* Forward declaration */
 struct tarot_node;
+struct tarot_string;
 
 /**
- * The scope stack tracks the nesting of scopes. Scopes aggregate symbols
- * within a logical block in a list for further processing.
+ * Scopes aggregate the symbols within a logical block. The symbols are kept
+ * in order of definition, which determines the index of local variables,
+ * and are indexed by name in an open addressing hash table. Names are
+ * interned strings and are therefore compared by address.
+ */
+struct scope {
+	struct tarot_list *symbols; /**< Symbols in order of definition    */
+	struct tarot_node **table;  /**< Hash index of symbols by name     */
+	size_t capacity;            /**< Number of slots, a power of two   */
+};
+
+/**
+ * The scope stack tracks the nesting of scopes. It grows with the nesting,
+ * its memory is released once the outermost scope is left.
  */
 struct scope_stack {
 	struct tarot_node *root;
 	struct tarot_node *class;
 	struct tarot_node *function;
 	struct tarot_node *loop;
-	struct tarot_list **scopes[10];
+	struct scope **scopes;
+	size_t capacity;
+	size_t nesting;
 	bool type_checking;
-	uint8_t nesting;
 };
 
 /**
  * Creates a new scope.
  */
-extern struct tarot_list* create_scope(void);
+extern struct scope* create_scope(void);
+
+/**
+ * Creates a new scope holding the same symbols as the given one.
+ */
+extern struct scope* copy_scope(struct scope *scope);
 
 /**
  * Destroys a scope.
  */
-extern void destroy_scope(struct tarot_list *scope);
+extern void destroy_scope(struct scope *scope);
+
+/**
+ * Returns the number of symbols within the scope.
+ */
+extern size_t scope_length(struct scope *scope);
+
+/**
+ * Returns the n-th symbol defined within the scope.
+ */
+extern struct tarot_node* scope_symbol(struct scope *scope, size_t n);
 
 /**
  * Enters the scope inside of the node by pushing it to the top of
  * the scope stack.
  */
-extern void enter_scope(struct scope_stack *stack, struct tarot_list **scope);
+extern void enter_scope(struct scope_stack *stack, struct scope *scope);
 
 /**
  * Leaves the scope on top of the scope stack.
  */
-extern void leave_scope(struct scope_stack *stack, struct tarot_list *scope);
+extern void leave_scope(struct scope_stack *stack, struct scope *scope);
 
 /**
  *
@@ -56,7 +85,7 @@ extern void leave_node(struct scope_stack *stack, struct tarot_node *node);
  * Looks for the identifier @p name inside scope @p scope
  */
 extern struct tarot_node* lookup_symbol_in_scope(
-	struct tarot_list *scope,
+	struct scope *scope,
 	struct tarot_string *name
 );
 
@@ -73,7 +102,7 @@ extern struct tarot_node* lookup_symbol(
  * Adds the symbol to the given scope.
  */
 extern void add_symbol_to_scope(
-	struct tarot_list **scope,
+	struct scope *scope,
 	struct tarot_node *node
 );
 
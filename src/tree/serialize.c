@@ -330,6 +330,14 @@ void tarot_serialize_node(
 			tarot_serialize_node(stream, CastExpression(node)->operand);
 			tarot_fputc(stream, ')');
 			break;
+		case NODE_Channel:
+			tarot_serialize_node(stream, ChannelExpression(node)->type);
+			tarot_fputc(stream, '(');
+			if (ChannelExpression(node)->capacity != NULL) {
+				tarot_serialize_node(stream, ChannelExpression(node)->capacity);
+			}
+			tarot_fputc(stream, ')');
+			break;
 		case NODE_Literal:
 			serialize_literal(stream, Literal(node));
 			break;
@@ -493,6 +501,12 @@ void tarot_serialize_node(
 			tarot_serialize_node(stream, RaiseStatement(node)->identififer);
 			tarot_fputs(stream, ";\n");
 			break;
+		case NODE_Launch:
+			tarot_fputs(stream, tarot_token_string(TAROT_TOK_LAUNCH));
+			tarot_fputc(stream, ' ');
+			tarot_serialize_node(stream, LaunchStatement(node)->call);
+			tarot_fputs(stream, ";\n");
+			break;
 		case NODE_Assert:
 			tarot_fputs(stream, tarot_token_string(TAROT_TOK_ASSERT));
 			tarot_fputc(stream, ' ');
@@ -402,10 +402,10 @@ static struct tarot_node* cast_to_string(struct tarot_node *operand) {
 			value = tarot_rational_to_string(Literal(operand)->value.Rational);
 			break;
 		case TYPE_STRING:
-			value = tarot_copy_string(Literal(operand)->value.String);
+			value = tarot_retain(Literal(operand)->value.String);
 			break;
 	}
-	Literal(result)->value.String = value;
+	Literal(result)->value.String = tarot_intern_string(value);
 	return result;
 }
 
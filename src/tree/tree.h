@@ -4,16 +4,28 @@
 #include "defines.h"
 #include "tree/node.h"
 #include "tree/scope.h"
+#include "lexer/scanner.h"
 
 /**
  * Imports the source file at path into a ready-to-use abstract syntax tree.
  * The resulting abstract syntax tree requires no further processing
  * and is valid. Invalid ASTs are destroyed and subsequently NULL is returned.
+ * The scan mode applies to the imported modules as well.
  */
-extern struct tarot_node* tarot_import(const char *path);
-extern struct tarot_node* tarot_parse(struct tarot_iostream *stream);
+extern struct tarot_node* tarot_import(
+	const char *path,
+	enum tarot_scan_mode mode
+);
+extern struct tarot_node* tarot_parse(
+	const char *source,
+	const char *path,
+	enum tarot_scan_mode mode
+);
 extern struct tarot_node* tarot_parse_text(const char *data);
-extern struct tarot_node* tarot_parse_file(const char *path);
+extern struct tarot_node* tarot_parse_file(
+	const char *path,
+	enum tarot_scan_mode mode
+);
 extern bool tarot_validate(struct tarot_node *ast);
 
 #endif /* TAROT_TREE_H */
@@ -99,6 +99,37 @@ static void raise_invalid_argument_count_error(
 	tarot_end_error();
 }
 
+static bool validate_channel_call(struct tarot_node *node) {
+	struct tarot_node *relation = FunctionCall(node)->identifier;
+	struct tarot_node *arguments = FunctionCall(node)->arguments;
+	struct tarot_node *type = type_of(Relation(relation)->parent);
+	size_t num_parameters = tarot_match_string(Relation(relation)->child, "send") ? 1 : 0;
+	if (Block(arguments)->num_elements != num_parameters) {
+		raise_invalid_argument_count_error(
+			position_of(node), Relation(relation)->child,
+			num_parameters,
+			Block(arguments)->num_elements
+		);
+		return false;
+	}
+	if (num_parameters > 0) {
+		struct tarot_node *argument = Block(arguments)->elements[0];
+		if (not compare_types(Type(type)->subtype, type_of(argument))) {
+			tarot_begin_error(position_of(node));
+			tarot_fputs(tarot_stderr, "Cannot send ");
+			print_node(argument);
+			tarot_fputs(tarot_stderr, " of type ");
+			print_node(type_of(argument));
+			tarot_fputs(tarot_stderr, " over a channel of type ");
+			print_node(type);
+			tarot_fputs(tarot_stderr, "!");
+			tarot_end_error();
+			return false;
+		}
+	}
+	return true;
+}
+
 static bool validate_functioncall(struct tarot_node *node) {
 	struct tarot_node *function = definition_of(node);
 	struct tarot_node *parameters = NULL;
@@ -119,7 +150,9 @@ static bool validate_functioncall(struct tarot_node *node) {
 			return false;
 		}
 	} else if (kind_of(function) == NODE_Builtin) {
-		/* ok */
+		if (Builtin(function)->builtin_type == TYPE_CHANNEL) {
+			return validate_channel_call(node);
+		}
 		return true;
 	} else {
 		tarot_error_at(position_of(node), "Identifier is not callable!");
@@ -302,6 +335,31 @@ static bool validate_import(struct tarot_node *node) {
  * MARK: Function
  *****************************************************************************/
 
+/* Checks that the frame of a function fits into the bytecode format */
+static bool validate_frame(
+	struct tarot_node *node,
+	struct tarot_node *parameters,
+	struct scope *scope
+) {
+	size_t num_parameters = Block(parameters)->num_elements;
+	size_t num_variables = scope_length(scope) - num_parameters;
+	if (num_parameters > TAROT_MAX_PARAMETERS) {
+		tarot_error_at(
+			position_of(node), "Too many parameters, at most %zu are supported",
+			(size_t)TAROT_MAX_PARAMETERS
+		);
+		return false;
+	}
+	if (num_variables > TAROT_MAX_VARIABLES) {
+		tarot_error_at(
+			position_of(node), "Too many variables, at most %zu are supported",
+			(size_t)TAROT_MAX_VARIABLES
+		);
+		return false;
+	}
+	return true;
+}
+
 static bool validate_function(struct tarot_node *node) {
 	if (Block(FunctionDefinition(node)->block)->num_elements == 0) {
 		tarot_error_at(position_of(node), "Function %s is empty!", tarot_string_text(name_of(node)));
@@ -323,10 +381,11 @@ static bool validate_function(struct tarot_node *node) {
 			return false;
 		}
 	}
-	if (Block(FunctionDefinition(node)->parameters)->num_elements >= 16) {
-		tarot_error_at(position_of(node), "Too many parameters");
-	}
-	return true;
+	return validate_frame(
+		node,
+		FunctionDefinition(node)->parameters,
+		FunctionDefinition(node)->scope
+	);
 }
 
 /******************************************************************************
@@ -377,6 +436,124 @@ static bool validate_while_statement(struct tarot_node *node) {
 	return true;
 }
 
+/******************************************************************************
+ * MARK: ForLoop
+ *
+ * The chunks of a parallel for loop share the variables of the enclosing
+ * function, so they may only write to the variables declared in the body
+ * of the loop, and to the variable of the reduction.
+ *****************************************************************************/
+
+struct parallel_body_state {
+	struct tarot_node *loop;
+	struct tarot_list *variables; /* declared in the body */
+	bool is_valid;
+};
+
+/* Returns the variable an assignment finally writes to */
+static struct tarot_node* assigned_variable(struct tarot_node *target) {
+	for (;;) {
+		switch (kind_of(target)) {
+			default:
+				return NULL;
+			case NODE_Identifier:
+				return link_of(target);
+			case NODE_Relation:
+				target = Relation(target)->parent;
+				break;
+			case NODE_Subscript:
+				target = Subscript(target)->identifier;
+				break;
+		}
+	}
+}
+
+static void validate_parallel_body(struct tarot_node **nodeptr, struct scope_stack *stack, void *data) {
+	struct tarot_node *node = *nodeptr;
+	struct parallel_body_state *state = data;
+	struct tarot_node *variable;
+	unused(stack);
+	switch (kind_of(node)) {
+		default:
+			break;
+		case NODE_Variable:
+			tarot_list_append(&state->variables, &node);
+			break;
+		case NODE_Break:
+			if (Break(node)->loop == state->loop) {
+				tarot_error_at(position_of(node), "Cannot break out of a parallel for loop!");
+				state->is_valid = false;
+			}
+			break;
+		case NODE_Return:
+			tarot_error_at(position_of(node), "Cannot return from within a parallel for loop!");
+			state->is_valid = false;
+			break;
+		case NODE_Assignment:
+			variable = assigned_variable(Assignment(node)->identifier);
+			if (
+				variable == NULL or
+				tarot_list_contains(state->variables, &variable) or
+				(ForLoop(state->loop)->reduction != NULL and variable == link_of(ForLoop(state->loop)->reduction))
+			) {
+				break;
+			}
+			tarot_begin_error(position_of(node));
+			print_text("Cannot assign to ");
+			print_node(Assignment(node)->identifier);
+			print_text(" in a parallel for loop, as it is shared by all chunks!");
+			tarot_end_error();
+			state->is_valid = false;
+			break;
+	}
+}
+
+static bool validate_reduction(struct tarot_node *node) {
+	struct tarot_node *reduction = ForLoop(node)->reduction;
+	enum tarot_datatype type = Type(type_of(reduction))->type;
+	if (kind_of(link_of(reduction)) != NODE_Variable) {
+		tarot_begin_error(position_of(reduction));
+		print_text("Cannot reduce ");
+		print_node(reduction);
+		print_text(", only variables can be reduced!");
+		tarot_end_error();
+		return false;
+	}
+	if (
+		not (type == TYPE_INTEGER or type == TYPE_FLOAT or type == TYPE_RATIONAL or type == TYPE_STRING) or
+		(type == TYPE_STRING and ForLoop(node)->operator != EXPR_ADD)
+	) {
+		tarot_begin_error(position_of(reduction));
+		print_text("Cannot reduce ");
+		print_node(reduction);
+		print_text(" of type ");
+		print_node(type_of(reduction));
+		print_text(" with operator ");
+		print_value(tarot_stderr, "%s", ArithmeticExpressionOperatorString(ForLoop(node)->operator));
+		print_text("!");
+		tarot_end_error();
+		return false;
+	}
+	return true;
+}
+
+static bool validate_for_statement(struct tarot_node *node) {
+	struct parallel_body_state state;
+	if (not ForLoop(node)->is_parallel) {
+		return true;
+	}
+	if (kind_of(ForLoop(node)->expression) != NODE_Range) {
+		tarot_error_at(position_of(node), "A parallel for loop can only iterate over a range!");
+		return false;
+	}
+	state.loop = node;
+	state.variables = tarot_create_list(sizeof(struct tarot_node*), 10, NULL);
+	state.is_valid = ForLoop(node)->reduction == NULL or validate_reduction(node);
+	tarot_traverse(&ForLoop(node)->block, validate_parallel_body, NULL, &state);
+	tarot_free_list(state.variables);
+	return state.is_valid;
+}
+
 /******************************************************************************
  * MARK: TypeCasts
  *****************************************************************************/
@@ -481,6 +658,19 @@ static bool validate_typecast(struct tarot_node *node) {
 	}
 }
 
+/******************************************************************************
+ * MARK: Channel
+ *****************************************************************************/
+
+static bool validate_channel(struct tarot_node *node) {
+	struct tarot_node *capacity = ChannelExpression(node)->capacity;
+	if (capacity != NULL and Type(type_of(capacity))->type != TYPE_INTEGER) {
+		tarot_error_at(position_of(node), "Channel capacity is not integral");
+		return false;
+	}
+	return true;
+}
+
 /******************************************************************************
  * MARK: LogicalExpression
  *****************************************************************************/
@@ -696,6 +886,23 @@ static bool validate_assert(struct tarot_node *node) {
 	return true;
 }
 
+/******************************************************************************
+ * MARK: Launch
+ *****************************************************************************/
+
+static bool validate_launch(struct tarot_node *node) {
+	struct tarot_node *call = LaunchStatement(node)->call;
+	if (kind_of(call) != NODE_FunctionCall) {
+		tarot_error_at(position_of(node), "Expected a function call after launch!");
+		return false;
+	}
+	if (kind_of(definition_of(call)) != NODE_Function) {
+		tarot_error_at(position_of(node), "Only functions can be launched!");
+		return false;
+	}
+	return true;
+}
+
 /******************************************************************************
  * MARK: Return
  *****************************************************************************/
@@ -919,6 +1126,7 @@ static bool validate_type(struct tarot_node *node) {
 			return true;
 		case TYPE_LIST:
 		case TYPE_DICT:
+		case TYPE_CHANNEL:
 			if (Type(node)->subtype == NULL) {
 				tarot_error_at(position_of(node), "Complex type %s requires subtype!", datatype_string(Type(node)->type));
 				return false;
@@ -985,6 +1193,9 @@ bool validate_nodeptr(
 		case NODE_Return:
 			is_valid = validate_return(node);
 			break;
+		case NODE_Launch:
+			is_valid = validate_launch(node);
+			break;
 		case NODE_Relation:
 			is_valid = validate_relation(node);
 			break;
@@ -1000,15 +1211,35 @@ bool validate_nodeptr(
 				remove_symbol(stack, node);
 			}
 			break;
+		case NODE_Method:
+			is_valid = validate_frame(
+				node,
+				MethodDefinition(node)->parameters,
+				MethodDefinition(node)->scope
+			);
+			break;
+		case NODE_Constructor:
+			is_valid = validate_frame(
+				node,
+				ClassConstructor(node)->parameters,
+				ClassConstructor(node)->scope
+			);
+			break;
 		case NODE_If:
 			is_valid = validate_if_statement(node);
 			break;
 		case NODE_While:
 			is_valid = validate_while_statement(node);
 			break;
+		case NODE_For:
+			is_valid = validate_for_statement(node);
+			break;
 		case NODE_Typecast:
 			is_valid = validate_typecast(node);
 			break;
+		case NODE_Channel:
+			is_valid = validate_channel(node);
+			break;
 		case NODE_Variable:
 			is_valid = validate_variable(node);
 			break;